@@ -0,0 +1,115 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//같은 배열 순회 함수를 --bounds-check를 켜고 끈 두 모듈로 컴파일해서 원소 하나당 시간을 비교함
+//반복문의 변수로 순회하는 경우는 인덱스 검사가 컴파일 타임에 사라지고, 다른 배열에서 읽은 인덱스는 검사가 남음
+//사용법: bounds_bench [반복 횟수] [최적화 레벨]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include "Compiler.h"
+#include "RuntimeSymbols.h"
+
+using std::string;
+using std::cout;
+using std::cerr;
+
+using llvm::ExitOnError;
+using llvm::orc::LLJIT;
+using llvm::orc::LLJITBuilder;
+
+using Clock = std::chrono::steady_clock;
+
+#define ARRAY_SIZE 65536
+
+const string kernel = "데이터: 수[65536]\n"
+                      "순서: 수[65536]\n"
+                      "\n"
+                      "ㅎㅇ 채우기(씨앗: 수):\n"
+                      "    ㄱㄱ i = 0; i < 65536; i += 1:\n"
+                      "        데이터[i] = i * 씨앗 % 1000\n"
+                      "        순서[i] = i * 40503 % 65536\n"
+                      "\n"
+                      "ㅎㅇ 순회(반복: 수) 수:\n"
+                      "    s = 0\n"
+                      "    ㄱㄱ r = 0; r < 반복; r += 1:\n"
+                      "        ㄱㄱ i = 0; i < 65536; i += 1:\n"
+                      "            s += 데이터[i]\n"
+                      "    ㅈㅈ s\n"
+                      "\n"
+                      "ㅎㅇ 간접(반복: 수) 수:\n"
+                      "    s = 0\n"
+                      "    ㄱㄱ r = 0; r < 반복; r += 1:\n"
+                      "        ㄱㄱ i = 0; i < 65536; i += 1:\n"
+                      "            s += 데이터[순서[i]]\n"
+                      "    ㅈㅈ s\n";
+
+ExitOnError ExitOnErr;
+
+std::unique_ptr<LLJIT> compile_kernel(bool bounds_check, unsigned opt_level) {
+    std::ostringstream log;
+    Session session{"bounds_bench.zul"};
+    session.logger.set_output(log);
+    session.opt_level = opt_level;
+    session.bounds_check = bounds_check;
+    session.need_entry = false;
+    Compiler compiler{session};
+    auto modules = compiler.compile(kernel);
+    session.logger.flush();
+    if (session.logger.has_error()) {
+        cerr << log.str();
+        exit(1);
+    }
+    auto jit = ExitOnErr(LLJITBuilder().create());
+    ExitOnErr(add_runtime_symbols(*jit));
+    for (auto &tsm: modules) {
+        ExitOnErr(jit->addIRModule(std::move(tsm)));
+    }
+    return jit;
+}
+
+//함수를 한 번 호출하고 원소 하나당 걸린 시간(ns)을 반환함
+double measure(LLJIT &jit, const char *name, long long repeat, long long &sum) {
+    auto func = ExitOnErr(jit.lookup(name)).toPtr<long long(long long)>();
+    auto begin = Clock::now();
+    sum = func(repeat);
+    auto ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+    return ns / (static_cast<double>(repeat) * ARRAY_SIZE);
+}
+
+int main(int argc, char *argv[]) {
+    long long repeat = argc > 1 ? std::atoll(argv[1]) : 2000;
+    unsigned opt_level = argc > 2 ? std::atoi(argv[2]) : 2;
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    ExitOnErr.setBanner("bounds_bench: ");
+
+    auto unchecked = compile_kernel(false, opt_level);
+    auto checked = compile_kernel(true, opt_level);
+    for (auto jit: {unchecked.get(), checked.get()}) {
+        ExitOnErr(jit->lookup("채우기")).toPtr<void(long long)>()(7);
+    }
+
+    for (auto [name, label]: {std::pair{"순회", "반복문 변수 인덱스"}, std::pair{"간접", "배열에서 읽은 인덱스"}}) {
+        long long unchecked_sum, checked_sum;
+        auto unchecked_ns = measure(*unchecked, name, repeat, unchecked_sum);
+        auto checked_ns = measure(*checked, name, repeat, checked_sum);
+        if (unchecked_sum != checked_sum) {
+            cerr << "에러: " << name << " 함수의 결과가 검사 여부에 따라 다릅니다\n";
+            return 1;
+        }
+        cout << label << ": 검사 없음 " << unchecked_ns << " ns/원소, 검사 " << checked_ns << " ns/원소 ("
+             << checked_ns / unchecked_ns << "배)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//한 프로세스의 여러 스레드에서 세션을 따로 만들어 동시에 컴파일하고, 초당 컴파일 횟수를 스레드 1개일 때와 비교함
+//스레드마다 만든 모듈의 명령어 수가 한 스레드에서 컴파일한 결과와 다르면 컴파일 상태가 섞인 것이므로 실패로 처리함
+//사용법: compile_bench [스레드 수] [스레드당 컴파일 횟수] [최적화 레벨]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "llvm/Support/TargetSelect.h"
+
+#include "Compiler.h"
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+
+using Clock = std::chrono::steady_clock;
+
+const string source = "전역합 = 0\n"
+                      "\n"
+                      "ㅎㅇ 피보(n: 수) 수:\n"
+                      "    ㅇㅈ? n < 2:\n"
+                      "        ㅈㅈ n\n"
+                      "    ㅈㅈ 피보(n - 1) + 피보(n - 2)\n"
+                      "\n"
+                      "ㅎㅇ 합(a: 수[], n: 수) 수:\n"
+                      "    s = 0\n"
+                      "    ㄱㄱ i = 0; i < n; i += 1:\n"
+                      "        s += a[i]\n"
+                      "    ㅈㅈ s\n"
+                      "\n"
+                      "ㅎㅇ 평균(a: 실수[], n: 수) 실수:\n"
+                      "    s = 0.0\n"
+                      "    ㄱㄱ i = 0; i < n; i += 1:\n"
+                      "        s += a[i]\n"
+                      "    ㅈㅈ s / n\n"
+                      "\n"
+                      "ㅎㅇ 시작() 수:\n"
+                      "    a: 수[100]\n"
+                      "    b: 실수[100]\n"
+                      "    ㄱㄱ i = 0; i < 100; i += 1:\n"
+                      "        a[i] = i * i\n"
+                      "        b[i] = i / 2.0\n"
+                      "    전역합 = 합(a, 100) + 피보(10)\n"
+                      "    출(전역합, 평균(b, 100))\n"
+                      "    ㅈㅈ 0\n";
+
+//소스를 한 번 컴파일하고 만들어진 모듈들의 명령어 수를 반환함. 에러가 나면 -1
+long long compile_once(unsigned opt_level) {
+    std::ostringstream log;
+    Session session{"bench.zul"};
+    session.logger.set_output(log);
+    session.opt_level = opt_level;
+    Compiler compiler{session};
+    auto modules = compiler.compile(source);
+    session.logger.flush();
+    if (session.logger.has_error() || modules.empty()) {
+        cerr << log.str();
+        return -1;
+    }
+    long long insts = 0;
+    for (auto &module: modules) {
+        module.withModuleDo([&](llvm::Module &m) { insts += m.getInstructionCount(); });
+    }
+    return insts;
+}
+
+//threads개의 스레드에서 각자 compiles번 컴파일하고 초당 컴파일 횟수를 반환함. 결과가 expected와 다르면 -1
+double measure(unsigned threads, int compiles, unsigned opt_level, long long expected) {
+    std::atomic<bool> mismatch{false};
+    vector<std::thread> workers;
+    auto begin = Clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < compiles && !mismatch; ++i) {
+                if (compile_once(opt_level) != expected)
+                    mismatch = true;
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    auto seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    return mismatch ? -1 : threads * compiles / seconds;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned threads = argc > 1 ? std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    int compiles = argc > 2 ? std::atoi(argv[2]) : 200;
+    unsigned opt_level = argc > 3 ? std::atoi(argv[3]) : 2;
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto expected = compile_once(opt_level);
+    if (expected < 0)
+        return 1;
+
+    auto single = measure(1, compiles, opt_level, expected);
+    auto multi = measure(threads, compiles, opt_level, expected);
+    if (single < 0 || multi < 0) {
+        cerr << "에러: 동시에 컴파일한 결과가 한 스레드에서 컴파일한 결과와 다릅니다\n";
+        return 1;
+    }
+
+    cout << "스레드 1개: " << single << " 컴파일/초\n";
+    cout << "스레드 " << threads << "개: " << multi << " 컴파일/초 (" << multi / single << "배)\n";
+    return 0;
+}
@@ -0,0 +1,91 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//libzul로 프로세스 안에서 줄랭 함수를 호출하는 비용과, zul 실행 파일을 매번 실행하는 비용을 비교함
+//사용법: embed_bench [zul 실행 파일 경로] [호출 횟수] [실행 횟수]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ZulEngine.h"
+
+using std::string;
+using std::cout;
+using std::cerr;
+
+using Clock = std::chrono::steady_clock;
+
+const string kernel = "ㅎㅇ 더하기(ㄱ: 수, ㄴ: 수) 수:\n"
+                      "    ㅈㅈ ㄱ * 3 + ㄴ\n";
+
+long long native_add(long long a, long long b) {
+    return a * 3 + b;
+}
+
+double elapsed_ns(Clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+}
+
+template<typename Func>
+double measure_calls(Func *func, long long calls) {
+    Func *volatile target = func; //호출이 인라인되거나 루프 밖으로 빠지지 않도록 함
+    long long sum = 0;
+    auto begin = Clock::now();
+    for (long long i = 0; i < calls; ++i) {
+        sum = target(sum, i);
+    }
+    auto ns = elapsed_ns(begin);
+    if (sum == 42)
+        cout << '\n';
+    return ns / calls;
+}
+
+int main(int argc, char *argv[]) {
+    string zul_path = argc > 1 ? argv[1] : "zul";
+    long long calls = argc > 2 ? std::atoll(argv[2]) : 10'000'000;
+    int spawns = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    auto begin = Clock::now();
+    ZulEngine engine;
+    if (!engine.compile(kernel, "kernel.zul")) {
+        cerr << engine.get_error();
+        return 1;
+    }
+    auto add = engine.get_function<long long(long long, long long)>("더하기");
+    if (!add) {
+        cerr << engine.get_error();
+        return 1;
+    }
+    auto compile_ms = elapsed_ns(begin) / 1e6;
+
+    auto zul_ns = measure_calls(add, calls);
+    auto native_ns = measure_calls(native_add, calls);
+
+    //같은 함수를 한 번 호출하고 결과를 출력하는 프로그램을 zul 실행 파일로 매번 실행함
+    string script_name = "embed_bench_kernel.zul";
+    {
+        std::ofstream script(script_name, std::ios::binary);
+        script << kernel << "\nㅎㅇ 시작() 수:\n    출(더하기(1, 2))\n";
+    }
+    string command = zul_path + " " + script_name + " > /dev/null";
+    begin = Clock::now();
+    for (int i = 0; i < spawns; ++i) {
+        if (std::system(command.c_str()) != 0) {
+            cerr << "\"" << command << "\" 실행에 실패했습니다\n";
+            std::remove(script_name.c_str());
+            return 1;
+        }
+    }
+    auto spawn_ms = elapsed_ns(begin) / 1e6 / spawns;
+    std::remove(script_name.c_str());
+
+    cout << "libzul 엔진 생성 + 컴파일: " << compile_ms << " ms (1회)\n";
+    cout << "libzul 함수 호출: " << zul_ns << " ns/호출\n";
+    cout << "C++ 함수 포인터 호출: " << native_ns << " ns/호출\n";
+    cout << "zul 실행 파일 실행: " << spawn_ms << " ms/실행\n";
+    return 0;
+}
@@ -0,0 +1,152 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//같은 입력 파일을 줄랭의 입 함수와 C의 scanf로 읽어서 값 하나당 시간을 비교함
+//입 함수는 표준 입력을 큰 블록으로 읽어 직접 파싱하고, scanf는 값마다 형식 문자열을 해석하고 stdio 버퍼를 거침
+//사용법: input_bench [정수와 실수 각각의 개수]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include "Compiler.h"
+#include "RuntimeSymbols.h"
+
+using std::string;
+using std::cout;
+using std::cerr;
+
+using llvm::ExitOnError;
+using llvm::orc::LLJIT;
+using llvm::orc::LLJITBuilder;
+
+using Clock = std::chrono::steady_clock;
+
+const string kernel = "ㅎㅇ 정수읽기(개수: 수) 수:\n"
+                      "    s = 0\n"
+                      "    x = 0\n"
+                      "    ㄱㄱ i = 0; i < 개수; i += 1:\n"
+                      "        입(x)\n"
+                      "        s += x\n"
+                      "    ㅈㅈ s\n"
+                      "\n"
+                      "ㅎㅇ 실수읽기(개수: 수) 실수:\n"
+                      "    s = 0.0\n"
+                      "    x = 0.0\n"
+                      "    ㄱㄱ i = 0; i < 개수; i += 1:\n"
+                      "        입(x)\n"
+                      "        s += x\n"
+                      "    ㅈㅈ s\n";
+
+const char *data_name = "input_bench_data.txt";
+
+ExitOnError ExitOnErr;
+
+double elapsed_ns(Clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+}
+
+//정수 count개 뒤에 실수 count개가 오는 입력 파일을 만듦
+void write_data(long long count) {
+    std::ofstream data(data_name, std::ios::binary);
+    char buffer[32];
+    for (long long i = 0; i < count; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%lld\n", i * 2654435761LL % 2000000000LL - 1000000000LL);
+        data << buffer;
+    }
+    for (long long i = 0; i < count; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%.4f\n", static_cast<double>(i % 100003) * 0.0123 - 300);
+        data << buffer;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    long long count = argc > 1 ? std::atoll(argv[1]) : 2'000'000;
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    ExitOnErr.setBanner("input_bench: ");
+
+    std::ostringstream log;
+    Session session{"input_bench.zul"};
+    session.logger.set_output(log);
+    session.opt_level = 2;
+    session.need_entry = false;
+    Compiler compiler{session};
+    auto modules = compiler.compile(kernel);
+    session.logger.flush();
+    if (session.logger.has_error()) {
+        cerr << log.str();
+        return 1;
+    }
+    auto jit = ExitOnErr(LLJITBuilder().create());
+    ExitOnErr(add_runtime_symbols(*jit));
+    for (auto &tsm: modules) {
+        ExitOnErr(jit->addIRModule(std::move(tsm)));
+    }
+    auto read_ints = ExitOnErr(jit->lookup("정수읽기")).toPtr<long long(long long)>();
+    auto read_floats = ExitOnErr(jit->lookup("실수읽기")).toPtr<double(long long)>();
+
+    write_data(count);
+    {
+        std::ifstream warm(data_name, std::ios::binary); //두 방식 모두 페이지 캐시에 올라온 파일을 읽도록 함
+        std::ostringstream sink;
+        sink << warm.rdbuf();
+    }
+
+    //scanf는 stdin에 붙은 FILE을 읽는 fscanf이므로 파일을 따로 열어서 같은 비용으로 잼
+    auto file = std::fopen(data_name, "rb");
+    if (!file) {
+        cerr << "에러: \"" << data_name << "\" 파일을 열 수 없습니다\n";
+        return 1;
+    }
+    long long scanf_int_sum = 0;
+    auto begin = Clock::now();
+    for (long long i = 0; i < count; ++i) {
+        long long value = 0;
+        std::fscanf(file, "%lld", &value);
+        scanf_int_sum += value;
+    }
+    auto scanf_int_ns = elapsed_ns(begin) / count;
+    double scanf_float_sum = 0;
+    begin = Clock::now();
+    for (long long i = 0; i < count; ++i) {
+        double value = 0;
+        std::fscanf(file, "%lf", &value);
+        scanf_float_sum += value;
+    }
+    auto scanf_float_ns = elapsed_ns(begin) / count;
+    std::fclose(file);
+
+    //입 함수는 표준 입력을 읽으므로 파일을 표준 입력으로 바꿈
+    if (!std::freopen(data_name, "rb", stdin)) {
+        cerr << "에러: \"" << data_name << "\" 파일을 표준 입력으로 열 수 없습니다\n";
+        return 1;
+    }
+    begin = Clock::now();
+    auto zul_int_sum = read_ints(count);
+    auto zul_int_ns = elapsed_ns(begin) / count;
+    begin = Clock::now();
+    auto zul_float_sum = read_floats(count);
+    auto zul_float_ns = elapsed_ns(begin) / count;
+    std::remove(data_name);
+
+    if (zul_int_sum != scanf_int_sum || zul_float_sum != scanf_float_sum) {
+        cerr << "에러: 입 함수로 읽은 값이 scanf로 읽은 값과 다릅니다\n";
+        return 1;
+    }
+    cout << "정수 " << count << "개: 입 " << zul_int_ns << " ns/개, scanf " << scanf_int_ns << " ns/개 ("
+         << scanf_int_ns / zul_int_ns << "배 빠름)\n";
+    cout << "실수 " << count << "개: 입 " << zul_float_ns << " ns/개, scanf " << scanf_float_ns << " ns/개 ("
+         << scanf_float_ns / zul_float_ns << "배 빠름)\n";
+    return 0;
+}
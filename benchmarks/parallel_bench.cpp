@@ -0,0 +1,124 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//배열을 순회하는 ㄱㄱ문을 병렬 힌트 없이 실행한 시간과, 스레드 수를 바꿔가며 병렬 ㄱㄱ문으로 실행한 시간을 비교함
+//계산이 많은 순회(제곱근)와 메모리 대역폭이 중요한 순회(배열 더하기)를 따로 잼
+//사용법: parallel_bench [최대 스레드 수] [반복 횟수]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include "Compiler.h"
+#include "Runtime.h"
+#include "RuntimeSymbols.h"
+
+using std::string;
+using std::cout;
+using std::cerr;
+
+using llvm::ExitOnError;
+using llvm::orc::LLJIT;
+using llvm::orc::LLJITBuilder;
+
+using Clock = std::chrono::steady_clock;
+
+const string kernel = "ㄱ: 실수[4194304]\n"
+                      "ㄴ: 실수[4194304]\n"
+                      "ㄷ: 실수[4194304]\n"
+                      "\n"
+                      "ㅎㅇ 채우기():\n"
+                      "    ㄱㄱ i = 0; i < 4194304; i += 1:\n"
+                      "        ㄱ[i] = i\n"
+                      "        ㄴ[i] = i % 100\n"
+                      "\n"
+                      "ㅎㅇ 제곱근직렬(반복: 수):\n"
+                      "    ㄱㄱ r = 0; r < 반복; r += 1:\n"
+                      "        ㄱㄱ i = 0; i < 4194304; i += 1:\n"
+                      "            ㄷ[i] = 제곱근(ㄱ[i] * 1.5 + r) + 제곱근(ㄴ[i] + r)\n"
+                      "\n"
+                      "ㅎㅇ 제곱근병렬(반복: 수):\n"
+                      "    ㄱㄱ r = 0; r < 반복; r += 1:\n"
+                      "        ㄱㄱ i = 0; i < 4194304; i += 1: 병렬\n"
+                      "            ㄷ[i] = 제곱근(ㄱ[i] * 1.5 + r) + 제곱근(ㄴ[i] + r)\n"
+                      "\n"
+                      "ㅎㅇ 더하기직렬(반복: 수):\n"
+                      "    ㄱㄱ r = 0; r < 반복; r += 1:\n"
+                      "        ㄱㄱ i = 0; i < 4194304; i += 1:\n"
+                      "            ㄷ[i] = ㄱ[i] + ㄴ[i] + r\n"
+                      "\n"
+                      "ㅎㅇ 더하기병렬(반복: 수):\n"
+                      "    ㄱㄱ r = 0; r < 반복; r += 1:\n"
+                      "        ㄱㄱ i = 0; i < 4194304; i += 1: 병렬\n"
+                      "            ㄷ[i] = ㄱ[i] + ㄴ[i] + r\n";
+
+ExitOnError ExitOnErr;
+
+using SweepFunc = void(long long);
+
+//함수를 호출하고 순회 한 번에 걸린 시간(ms)을 반환함
+double measure(SweepFunc *func, long long repeat) {
+    auto begin = Clock::now();
+    func(repeat);
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count() / repeat;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned max_threads = argc > 1 ? std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    long long repeat = argc > 2 ? std::atoll(argv[2]) : 20;
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    ExitOnErr.setBanner("parallel_bench: ");
+
+    std::ostringstream log;
+    Session session{"parallel_bench.zul"};
+    session.logger.set_output(log);
+    session.opt_level = 2;
+    session.need_entry = false;
+    Compiler compiler{session};
+    auto modules = compiler.compile(kernel);
+    session.logger.flush();
+    if (session.logger.has_error()) {
+        cerr << log.str();
+        return 1;
+    }
+    auto jit = ExitOnErr(LLJITBuilder().create());
+    ExitOnErr(add_runtime_symbols(*jit));
+    for (auto &tsm: modules) {
+        ExitOnErr(jit->addIRModule(std::move(tsm)));
+    }
+    ExitOnErr(jit->lookup("채우기")).toPtr<void()>()();
+
+    std::vector<unsigned> thread_counts; //1, 2, 4, ... 최대 스레드 수
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (auto [name, label]: {std::pair{"제곱근", "제곱근 순회"}, std::pair{"더하기", "배열 더하기"}}) {
+        auto serial = ExitOnErr(jit->lookup(string(name) + "직렬")).toPtr<SweepFunc>();
+        auto parallel = ExitOnErr(jit->lookup(string(name) + "병렬")).toPtr<SweepFunc>();
+        serial(1); //배열을 캐시와 페이지 테이블에 올려 둠
+        auto serial_ms = measure(serial, repeat);
+        cout << label << " (원소 4194304개)\n";
+        cout << "  병렬 힌트 없음: " << serial_ms << " ms\n";
+        for (auto threads: thread_counts) {
+            zul_set_threads(threads);
+            parallel(1); //스레드 풀을 새 크기로 만들어 둠
+            auto parallel_ms = measure(parallel, repeat);
+            cout << "  스레드 " << threads << "개: " << parallel_ms << " ms (" << serial_ms / parallel_ms << "배)\n";
+        }
+    }
+    return 0;
+}
@@ -2,7 +2,12 @@
 //SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
 //SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/MDBuilder.h"
+
 #include "AST.h"
+#include "ConstEval.h"
+#include "Runtime.h"
 
 using std::string;
 using std::string_view;
@@ -23,6 +28,29 @@ using llvm::Type;
 using llvm::PointerType;
 using llvm::Value;
 using llvm::Constant;
+using llvm::CallInst;
+
+#define FOLD_STEP_LIMIT 100'000 //함수 몸체 안의 호출을 미리 계산할 때의 계산 횟수 제한
+#define LOCAL_ARRAY_STACK_LIMIT (64 * 1024) //이 크기 이하의 상수 크기 지역 배열은 스택에 만듦
+#define POOLED_ARRAY_MIN_ELEMENTS 4 //원소가 이 개수 이상인 상수 배열 리터럴은 상수 풀에서 복사함
+
+const unordered_map<Token, Token> assn_op_map = {
+        {tok_mul_assn,    tok_mul},
+        {tok_div_assn,    tok_div},
+        {tok_mod_assn,    tok_mod},
+        {tok_add_assn,    tok_add},
+        {tok_sub_assn,    tok_sub},
+        {tok_lshift_assn, tok_lshift},
+        {tok_rshift_assn, tok_rshift},
+        {tok_and_assn,    tok_bitand},
+        {tok_or_assn,     tok_bitor},
+        {tok_xor_assn,    tok_bitxor}
+};
+
+ZulValue ExprAST::const_eval(ConstEvaluator &evaluator) {
+    evaluator.fail("상수식에서 사용할 수 없는 구문입니다");
+    return nullzul;
+}
 
 bool ExprAST::is_const() {
     return false;
@@ -32,14 +60,21 @@ bool ExprAST::is_lvalue() {
     return false;
 }
 
-int ExprAST::get_typeid(ZulContext &zulctx) {
-    return -1;
+int ExprAST::get_typeid() const {
+    return type_id;
 }
 
 bool LvalueAST::is_lvalue() {
     return true;
 }
 
+void LvalueAST::take_address() {}
+
+ZulValue *LvalueAST::const_ref(ConstEvaluator &evaluator) {
+    evaluator.fail("컴파일 타임 계산 중에는 배열에 대입할 수 없습니다");
+    return nullptr;
+}
+
 FuncProtoAST::FuncProtoAST(string name, int return_type, vector<pair<string, int>> params, bool has_body,
                            bool is_var_arg) :
         name(std::move(name)), return_type(return_type), params(std::move(params)), has_body(has_body),
@@ -52,127 +87,235 @@ llvm::Function *FuncProtoAST::code_gen(ZulContext &zulctx) {
         param_types.emplace_back(get_llvm_type(*zulctx.context, param.second));
     }
     auto func_type = llvm::FunctionType::get(get_llvm_type(*zulctx.context, return_type), param_types, is_var_arg);
-    return llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, name, *zulctx.module);
+    auto func = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, name, *zulctx.module);
+    //C/C++에서 직접 호출할 수 있도록 논리와 글자는 C ABI처럼 확장해서 주고받음
+    auto ext_attr = [](int type_id) {
+        return type_id == id_bool ? llvm::Attribute::ZExt :
+               type_id == id_char ? llvm::Attribute::SExt : llvm::Attribute::None;
+    };
+    if (auto attr = ext_attr(return_type); attr != llvm::Attribute::None)
+        func->addRetAttr(attr);
+    for (unsigned i = 0; i < params.size(); ++i) {
+        if (auto attr = ext_attr(params[i].second); attr != llvm::Attribute::None)
+            func->addParamAttr(i, attr);
+    }
+    return func;
 }
 
 FuncRetAST::FuncRetAST(ASTPtr body, Capture<int> return_type) :
-        body(std::move(body)), return_type(std::move(return_type)) {}
+        body(std::move(body)), return_type(std::move(return_type)) {
+    type_id = this->return_type.value;
+}
 
 ZulValue FuncRetAST::code_gen(ZulContext &zulctx) {
     ZulValue body_value = nullzul;
-    if (body) {
+    if (auto call = dynamic_cast<FuncCallAST *>(body.get())) {
+        body_value = call->tail_code_gen(zulctx, return_type);
+        if (body_value.second == id_interrupt) //꼬리 재귀를 반복문으로 바꿈
+            return body_value;
+        if (!body_value.first)
+            return nullzul;
+    } else if (body) {
         body_value = body->code_gen(zulctx);
         if (!body_value.first)
             return nullzul;
     }
+    //musttail 호출 바로 뒤에는 ret가 와야 함
+    auto call_inst = llvm::dyn_cast_or_null<CallInst>(body_value.first);
+    bool direct_ret = zulctx.ret_count == 1 || (call_inst && call_inst->isMustTailCall());
     if (return_type.value == -1) {
         if (body && body_value.second != -1) {
-            System::logger.log_error(return_type.loc, return_type.word_size,
-                                     {"리턴 타입이 일치하지 않습니다. 함수의 반환 타입이 \"없음\" 이지만 \"",
-                                      get_type_name(body_value.second), "\" 타입을 반환하고 있습니다"});
+            zulctx.logger.log_error(return_type.loc, return_type.word_size,
+                                    {"리턴 타입이 일치하지 않습니다. 함수의 반환 타입이 \"없음\" 이지만 \"",
+                                     get_type_name(body_value.second), "\" 타입을 반환하고 있습니다"});
         }
-        if (zulctx.ret_count == 1) {
+        if (direct_ret) {
             zulctx.builder.CreateRetVoid();
         } else {
             zulctx.builder.CreateBr(zulctx.return_block);
         }
     } else {
         if (return_type.value != body_value.second && !create_cast(zulctx, body_value, return_type.value)) {
-            System::logger.log_error(return_type.loc, return_type.word_size,
-                                     {"리턴 타입이 일치하지 않습니다. 반환 구문의 타입 \"", get_type_name(body_value.second),
-                                      "\" 에서 리턴 타입 \"", get_type_name(return_type.value), "\" 로 캐스팅 할 수 없습니다"});
-        } else if (zulctx.ret_count == 1) {
-            zulctx.builder.CreateRet(body_value.first);
+            zulctx.logger.log_error(return_type.loc, return_type.word_size,
+                                    {"리턴 타입이 일치하지 않습니다. 반환 구문의 타입 \"", get_type_name(body_value.second),
+                                     "\" 에서 리턴 타입 \"", get_type_name(return_type.value), "\" 로 캐스팅 할 수 없습니다"});
+        } else if (return_type.value < TYPE_COUNTS * 2 && return_type.value >= TYPE_COUNTS &&
+                   llvm::isa<llvm::AllocaInst>(llvm::getUnderlyingObject(body_value.first))) {
+            //스택에 있는 지역 배열은 함수가 끝나면 사라지므로 영역에서 할당한 배열만 반환할 수 있음
+            zulctx.logger.log_error(return_type.loc, return_type.word_size,
+                                    {"지역 배열은 반환할 수 없습니다. 영역 함수로 할당한 배열을 반환해야 합니다"});
         } else {
-            zulctx.builder.CreateStore(body_value.first, zulctx.return_var);
-            zulctx.builder.CreateBr(zulctx.return_block);
+            if (return_type.value < TYPE_COUNTS * 2 && return_type.value >= TYPE_COUNTS) //아레나 배열인지는 함수를 다 만든 뒤에 검사함
+                zulctx.array_returns.push_back({body_value.first, return_type.loc, return_type.word_size});
+            if (direct_ret) {
+                zulctx.builder.CreateRet(body_value.first);
+            } else {
+                zulctx.builder.CreateStore(body_value.first, zulctx.return_var);
+                zulctx.builder.CreateBr(zulctx.return_block);
+            }
         }
     }
     return {nullptr, id_interrupt};
 }
 
-int FuncRetAST::get_typeid(ZulContext &zulctx) {
-    return return_type.value;
+ZulValue FuncRetAST::const_eval(ConstEvaluator &evaluator) {
+    ZulValue body_value = nullzul;
+    if (body) {
+        body_value = evaluator.eval(*body);
+        if (evaluator.failed())
+            return nullzul;
+    }
+    if (return_type.value != -1 && !evaluator.cast(body_value, return_type.value))
+        return nullzul;
+    evaluator.ret_value = body_value;
+    evaluator.flow = ConstEvaluator::flow_return;
+    return nullzul;
 }
 
 IfAST::IfAST(CondBodyPair if_pair, std::vector<CondBodyPair> elif_pair_list, std::vector<ASTPtr> else_body) :
         if_pair(std::move(if_pair)), elif_pair_list(std::move(elif_pair_list)), else_body(std::move(else_body)) {}
 
-ZulValue IfAST::code_gen(ZulContext &zulctx) {
-    auto prev_cond = if_pair.first->code_gen(zulctx);
-    if (!prev_cond.first || !to_boolean_expr(zulctx, prev_cond))
-        return nullzul;
+//몸체의 구문들을 생성하고, 분기로 끝나지 않았으면 next_block으로 이어지게 함
+void gen_body(ZulContext &zulctx, vector<ASTPtr> &body, llvm::BasicBlock *next_block) {
+    auto scope_begin = zulctx.scope_arrays.size();
+    Guard guard{[&zulctx, scope_begin]() { //몸체에서 만든 스택 배열은 몸체 밖에서 보이지 않음
+        zulctx.scope_arrays.resize(scope_begin);
+    }};
+    for (auto &ast: body) {
+        if (ast->code_gen(zulctx).second == id_interrupt)
+            return;
+    }
+    for (auto i = scope_begin; i < zulctx.scope_arrays.size(); ++i) {
+        auto [alloca_val, byte_size] = zulctx.scope_arrays[i];
+        zulctx.builder.CreateLifetimeEnd(alloca_val, zulctx.builder.getInt64(byte_size));
+    }
+    zulctx.builder.CreateBr(next_block);
+}
 
-    auto func = zulctx.builder.GetInsertBlock()->getParent();
-    auto body_block = llvm::BasicBlock::Create(*zulctx.context, "if", func);
-    auto merge_block = llvm::BasicBlock::Create(*zulctx.context, "merge");
-    auto prev_block = zulctx.builder.GetInsertBlock();
-
-    zulctx.builder.SetInsertPoint(body_block);
-    bool interrupted = false;
-    for (auto &ast: if_pair.second) {
-        auto code = ast->code_gen(zulctx).second;
-        if (code == id_interrupt) {
-            interrupted = true;
-            break;
-        }
+//값 중에 현재 함수의 스택에 만든 배열을 가리킬 수 있는 것이 있는지
+bool points_to_stack(const vector<Value *> &values) {
+    for (auto value: values) {
+        if (!value->getType()->isPointerTy())
+            continue;
+        llvm::SmallVector<const Value *, 4> objects;
+        llvm::getUnderlyingObjects(value, objects);
+        if (llvm::any_of(objects, [](auto object) { return llvm::isa<llvm::AllocaInst>(object); }))
+            return true;
     }
-    if (!interrupted)
-        zulctx.builder.CreateBr(merge_block);
+    return false;
+}
 
-    for (auto &elif_pair: elif_pair_list) {
-        auto elif_cond_block = llvm::BasicBlock::Create(*zulctx.context, "elif_cond", func);
-        zulctx.builder.SetInsertPoint(prev_block);
-        zulctx.builder.CreateCondBr(prev_cond.first, body_block, elif_cond_block);
+//인덱스가 [0, size) 밖이면 런타임 에러를 냄. 음수 인덱스도 부호 없이 비교하면 size보다 커짐
+void create_bounds_check(ZulContext &zulctx, Value *index, Value *size, int line) {
+    auto in_range = zulctx.builder.CreateICmpULT(index, size);
+    if (auto const_cond = llvm::dyn_cast<ConstantInt>(in_range); const_cond && const_cond->isOne())
+        return;
+    auto func = zulctx.builder.GetInsertBlock()->getParent();
+    auto ok_block = llvm::BasicBlock::Create(*zulctx.context, "in_bounds", func);
+    auto fail_block = llvm::BasicBlock::Create(*zulctx.context, "out_of_bounds", func);
+    auto weights = llvm::MDBuilder(*zulctx.context).createBranchWeights(1 << 20, 1);
+    auto branch = zulctx.builder.CreateCondBr(in_range, ok_block, fail_block, weights);
+    zulctx.bounds_checks.push_back({branch, index, size});
+    zulctx.ssa.seal_block(fail_block);
+    zulctx.ssa.seal_block(ok_block);
+    zulctx.builder.SetInsertPoint(fail_block);
+    create_bounds_fail(zulctx.builder, index, size, line);
+    zulctx.builder.SetInsertPoint(ok_block);
+}
 
-        zulctx.builder.SetInsertPoint(elif_cond_block);
-        prev_cond = elif_pair.first->code_gen(zulctx);
-        if (!prev_cond.first || !to_boolean_expr(zulctx, prev_cond))
+ZulValue IfAST::code_gen(ZulContext &zulctx) {
+    auto func = zulctx.builder.GetInsertBlock()->getParent();
+    auto merge_block = llvm::BasicBlock::Create(*zulctx.context, "merge");
+    auto else_block = else_body.empty() ? merge_block : llvm::BasicBlock::Create(*zulctx.context, "else");
+    auto enter_block = [&](llvm::BasicBlock *block) {
+        func->insert(func->end(), block);
+        zulctx.ssa.seal_block(block);
+        zulctx.builder.SetInsertPoint(block);
+    };
+
+    //조건 분기를 몸체보다 먼저 만들어서, 몸체 블록은 만들 때부터 선행 블록이 정해져 있도록 함
+    for (size_t i = 0; i <= elif_pair_list.size(); ++i) {
+        auto &pair = i == 0 ? if_pair : elif_pair_list[i - 1];
+        auto cond = pair.first->code_gen(zulctx);
+        if (!cond.first || !to_boolean_expr(zulctx, cond))
             return nullzul;
 
-        body_block = llvm::BasicBlock::Create(*zulctx.context, "elif", func);
+        auto body_block = llvm::BasicBlock::Create(*zulctx.context, i == 0 ? "if" : "elif", func);
+        auto next_block = i < elif_pair_list.size() ? llvm::BasicBlock::Create(*zulctx.context, "elif_cond") : else_block;
+        zulctx.builder.CreateCondBr(cond.first, body_block, next_block);
+        zulctx.ssa.seal_block(body_block);
         zulctx.builder.SetInsertPoint(body_block);
-        interrupted = false;
-        for (auto &ast: elif_pair.second) {
-            auto code = ast->code_gen(zulctx).second;
-            if (code == id_interrupt) {
-                interrupted = true;
-                break;
-            }
-        }
-        if (!interrupted)
-            zulctx.builder.CreateBr(merge_block);
-        prev_block = elif_cond_block;
+        gen_body(zulctx, pair.second, merge_block);
+        if (next_block != merge_block)
+            enter_block(next_block);
     }
-    if (else_body.empty()) {
-        zulctx.builder.SetInsertPoint(prev_block);
-        zulctx.builder.CreateCondBr(prev_cond.first, body_block, merge_block);
-    } else {
-        auto else_block = llvm::BasicBlock::Create(*zulctx.context, "else", func);
-        zulctx.builder.SetInsertPoint(prev_block);
-        zulctx.builder.CreateCondBr(prev_cond.first, body_block, else_block);
-
-        zulctx.builder.SetInsertPoint(else_block);
-        interrupted = false;
-        for (auto &ast: else_body) {
-            auto code = ast->code_gen(zulctx).second;
-            if (code == id_interrupt) {
-                interrupted = true;
-                break;
-            }
+    if (!else_body.empty())
+        gen_body(zulctx, else_body, merge_block);
+
+    enter_block(merge_block);
+    return nullzul;
+}
+
+ZulValue IfAST::const_eval(ConstEvaluator &evaluator) {
+    bool cond;
+    if (!evaluator.eval_cond(*if_pair.first, cond))
+        return nullzul;
+    if (cond) {
+        evaluator.eval_block(if_pair.second);
+        return nullzul;
+    }
+    for (auto &elif_pair: elif_pair_list) {
+        if (!evaluator.eval_cond(*elif_pair.first, cond))
+            return nullzul;
+        if (cond) {
+            evaluator.eval_block(elif_pair.second);
+            return nullzul;
         }
-        if (!interrupted)
-            zulctx.builder.CreateBr(merge_block);
     }
-
-    func->insert(func->end(), merge_block);
-    zulctx.builder.SetInsertPoint(merge_block);
+    evaluator.eval_block(else_body);
     return nullzul;
 }
 
-LoopAST::LoopAST(ASTPtr init_body, ASTPtr test_body, ASTPtr update_body, std::vector<ASTPtr> loop_body) :
+LoopAST::LoopAST(ASTPtr init_body, ASTPtr test_body, ASTPtr update_body, std::vector<ASTPtr> loop_body,
+                 LoopHints hints) :
         init_body(std::move(init_body)), test_body(std::move(test_body)), update_body(std::move(update_body)),
-        loop_body(std::move(loop_body)) {}
+        loop_body(std::move(loop_body)), hints(hints) {}
+
+//반복문의 latch 분기에 붙일 llvm.loop 메타데이터. 힌트의 위치도 함께 넣어서 최적화 뒤에 적용되지 않은 힌트를 찾을 수 있게 함
+llvm::MDNode *create_loop_id(LLVMContext &context, const LoopHints &hints) {
+    auto int_md = [&context](int value) {
+        return llvm::ConstantAsMetadata::get(llvm::ConstantInt::get(Type::getInt32Ty(context), value));
+    };
+    auto bool_md = [&context](bool value) {
+        return llvm::ConstantAsMetadata::get(llvm::ConstantInt::get(Type::getInt1Ty(context), value));
+    };
+    auto property = [&context](string_view name, llvm::ArrayRef<llvm::Metadata *> values = {}) {
+        llvm::SmallVector<llvm::Metadata *, 4> ops{llvm::MDString::get(context, name)};
+        ops.append(values.begin(), values.end());
+        return llvm::MDNode::get(context, ops);
+    };
+
+    llvm::SmallVector<llvm::Metadata *, 8> ops{nullptr}; //첫 번째 피연산자는 자기 자신
+    if (hints.unroll == 0)
+        ops.push_back(property("llvm.loop.unroll.enable"));
+    else if (hints.unroll == 1)
+        ops.push_back(property("llvm.loop.unroll.disable"));
+    else if (hints.unroll > 1)
+        ops.push_back(property("llvm.loop.unroll.count", {int_md(hints.unroll)}));
+    if (hints.vector_width != -1)
+        ops.push_back(property("llvm.loop.vectorize.enable", {bool_md(hints.vector_width != 1)}));
+    if (hints.vector_width > 1)
+        ops.push_back(property("llvm.loop.vectorize.width", {int_md(hints.vector_width)}));
+    if (hints.interleave != -1)
+        ops.push_back(property("llvm.loop.interleave.count", {int_md(hints.interleave)}));
+    if (hints.distribute)
+        ops.push_back(property("llvm.loop.distribute.enable", {bool_md(true)}));
+    ops.push_back(property(LOOP_HINT_LOC, {int_md(hints.loc.first), int_md(hints.loc.second),
+                                          int_md(static_cast<int>(hints.word_size))}));
+    auto loop_id = llvm::MDNode::getDistinct(context, ops);
+    loop_id->replaceOperandWith(0, loop_id);
+    return loop_id;
+}
 
 ZulValue LoopAST::code_gen(ZulContext &zulctx) {
     auto func = zulctx.builder.GetInsertBlock()->getParent();
@@ -190,35 +333,383 @@ ZulValue LoopAST::code_gen(ZulContext &zulctx) {
     if (init_body && !init_body->code_gen(zulctx).first)
         return nullzul;
 
-    zulctx.builder.CreateBr(test_block);
+    //조건 블록은 갱신 블록에서 돌아오는 분기가 만들어진 뒤에 봉인됨
+    auto enter_br = zulctx.builder.CreateBr(test_block);
+    auto arena_allocs = zulctx.arena_allocs;
     zulctx.builder.SetInsertPoint(test_block);
+    llvm::BranchInst *test_br;
     if (test_body) {
         ZulValue test_cond = test_body->code_gen(zulctx);
         if (!test_cond.first || !to_boolean_expr(zulctx, test_cond))
             return nullzul;
-        zulctx.builder.CreateCondBr(test_cond.first, start_block, end_block);
+        test_br = zulctx.builder.CreateCondBr(test_cond.first, start_block, end_block);
     } else {
-        zulctx.builder.CreateBr(start_block);
+        test_br = zulctx.builder.CreateBr(start_block);
     }
 
-    bool interrupted = false;
+    zulctx.ssa.seal_block(start_block);
     zulctx.builder.SetInsertPoint(start_block);
-    for (auto &ast: loop_body) {
-        auto code = ast->code_gen(zulctx);
-        if (code.second == id_interrupt) {
-            interrupted = true;
-            break;
-        }
+    auto body_checks = zulctx.bounds_checks.size();
+    gen_body(zulctx, loop_body, update_block);
+    auto body_checks_end = zulctx.bounds_checks.size();
+
+    //몸체에서 아레나에 할당한 배열은 한 바퀴가 끝날 때마다 해제해서 반복 횟수만큼 메모리가 늘어나지 않게 함
+    Value *arena_mark = nullptr;
+    if (zulctx.arena_allocs != arena_allocs) {
+        llvm::IRBuilder<> enter_builder(enter_br);
+        arena_mark = create_arena_mark(enter_builder);
     }
-    if (!interrupted)
-        zulctx.builder.CreateBr(update_block);
 
+    zulctx.ssa.seal_block(update_block); //ㅌㅌ문의 분기도 모두 만들어짐
     zulctx.builder.SetInsertPoint(update_block);
+    if (arena_mark)
+        create_arena_release(zulctx.builder, arena_mark);
     if (update_body && !update_body->code_gen(zulctx).first)
         return nullzul;
-    zulctx.builder.CreateBr(test_block);
-
+    auto latch_br = zulctx.builder.CreateBr(test_block);
+    if (!hints.empty())
+        latch_br->setMetadata(llvm::LLVMContext::MD_loop, create_loop_id(*zulctx.context, hints));
+
+    zulctx.ssa.seal_block(test_block);
+    zulctx.ssa.seal_block(end_block);
+    if (body_checks != body_checks_end)
+        zulctx.checked_loops.push_back({enter_br, test_br, latch_br, body_checks, body_checks_end});
     zulctx.builder.SetInsertPoint(end_block);
+    if (arena_mark) //ㅅㄱ문으로 나온 경우에도 해제해야 함
+        create_arena_release(zulctx.builder, arena_mark);
+    return nullzul;
+}
+
+ZulValue LoopAST::const_eval(ConstEvaluator &evaluator) {
+    if (init_body)
+        evaluator.eval(*init_body);
+    while (!evaluator.failed()) {
+        bool cond = true;
+        if (test_body && !evaluator.eval_cond(*test_body, cond))
+            break;
+        if (!cond)
+            break;
+        evaluator.eval_block(loop_body);
+        if (evaluator.flow == ConstEvaluator::flow_return)
+            break;
+        if (evaluator.flow == ConstEvaluator::flow_break) {
+            evaluator.flow = ConstEvaluator::flow_normal;
+            break;
+        }
+        evaluator.flow = ConstEvaluator::flow_normal;
+        if (update_body)
+            evaluator.eval(*update_body);
+    }
+    return nullzul;
+}
+
+ParallelLoopAST::ParallelLoopAST(LocalVar *index_var, Capture<ASTPtr> start, Capture<ASTPtr> bound, bool inclusive,
+                                 Capture<ASTPtr> step, std::vector<ASTPtr> loop_body, std::vector<LocalVar *> captures,
+                                 LoopHints hints) :
+        index_var(index_var), start(std::move(start)), bound(std::move(bound)), inclusive(inclusive),
+        step(std::move(step)), loop_body(std::move(loop_body)), captures(std::move(captures)), hints(hints) {}
+
+//void 몸체(ptr 컨텍스트, i64 시작 번호, i64 끝 번호, ptr 누적값). [시작 번호, 끝 번호) 번째 반복을 실행함
+//컨텍스트에는 i의 시작값, 바깥 지역 변수의 값(배열이면 크기도)이 순서대로 들어 있음
+//누적 변수는 이 스레드의 누적값에서 읽어서 시작하고, 끝나면 다시 씀
+llvm::Function *ParallelLoopAST::create_body_func(ZulContext &zulctx, llvm::StructType *ctx_type,
+                                                  llvm::StructType *partial_type, int64_t step_value) {
+    auto &context = *zulctx.context;
+    auto &builder = zulctx.builder;
+    auto outer_block = builder.GetInsertBlock();
+    auto int_type = Type::getInt64Ty(context);
+    auto ptr_type = PointerType::getUnqual(context);
+    auto func_type = llvm::FunctionType::get(Type::getVoidTy(context), {ptr_type, int_type, int_type, ptr_type},
+                                             false);
+    auto func = llvm::Function::Create(func_type, llvm::Function::InternalLinkage,
+                                       outer_block->getParent()->getName() + ".병렬", *zulctx.module);
+    func->setDoesNotThrow();
+    auto ctx_arg = func->getArg(0);
+    auto begin_arg = func->getArg(1);
+    auto end_arg = func->getArg(2);
+    auto partial_arg = func->getArg(3);
+    ctx_arg->setName("ctx");
+    begin_arg->setName("begin");
+    end_arg->setName("end");
+    partial_arg->setName("partial");
+    for (auto attr: {llvm::Attribute::NoAlias, llvm::Attribute::NoCapture, llvm::Attribute::ReadOnly})
+        ctx_arg->addAttr(attr);
+    partial_arg->addAttr(llvm::Attribute::NoAlias);
+    partial_arg->addAttr(llvm::Attribute::NoCapture);
+    zulctx.outlined_funcs.push_back(func);
+
+    //몸체를 만드는 동안 바깥 함수의 상태를 치워 두고, 바깥 변수는 컨텍스트에서 읽은 값을 가리키게 함
+    auto outer_arrays = std::move(zulctx.scope_arrays);
+    zulctx.scope_arrays.clear();
+    auto outer_arena_allocs = zulctx.arena_allocs;
+    zulctx.arena_allocs = 0;
+    vector<pair<llvm::AllocaInst *, Value *>> outer_origins;
+    vector<llvm::AllocaInst *> outer_reduction_allocas;
+    Guard guard{[&]() {
+        for (size_t i = 0; i < outer_origins.size(); ++i) {
+            captures[i]->alloca = outer_origins[i].first;
+            captures[i]->array_size = outer_origins[i].second;
+        }
+        for (size_t i = 0; i < outer_reduction_allocas.size(); ++i)
+            hints.reductions[i].var->alloca = outer_reduction_allocas[i];
+        zulctx.scope_arrays = std::move(outer_arrays);
+        zulctx.arena_allocs = outer_arena_allocs;
+        builder.SetInsertPoint(outer_block);
+    }};
+
+    auto entry_block = llvm::BasicBlock::Create(context, "entry", func);
+    auto test_block = llvm::BasicBlock::Create(context, "loop_test", func);
+    auto start_block = llvm::BasicBlock::Create(context, "loop_start", func);
+    auto update_block = llvm::BasicBlock::Create(context, "loop_update", func);
+    auto end_block = llvm::BasicBlock::Create(context, "loop_end", func);
+    zulctx.ssa.seal_block(entry_block);
+    builder.SetInsertPoint(entry_block);
+    unsigned field = 0;
+    auto load_field = [&](const llvm::Twine &name) {
+        auto field_ptr = builder.CreateStructGEP(ctx_type, ctx_arg, field);
+        return builder.CreateLoad(ctx_type->getElementType(field++), field_ptr, name);
+    };
+    auto start_val = load_field("start");
+    for (auto var: captures) {
+        auto value = load_field(var->name);
+        outer_origins.emplace_back(var->alloca, var->array_size);
+        if (var->array_size)
+            var->array_size = load_field(var->name + ".size");
+        if (var->address_taken) { //입 함수에 넘기는 변수는 몸체에서도 주소가 필요함
+            var->alloca = builder.CreateAlloca(value->getType(), nullptr, var->name);
+            builder.CreateStore(value, var->alloca);
+        } else {
+            zulctx.ssa.write_var(var, entry_block, value);
+        }
+    }
+    for (unsigned i = 0; i < hints.reductions.size(); ++i) {
+        auto var = hints.reductions[i].var;
+        auto value = builder.CreateLoad(partial_type->getElementType(i),
+                                        builder.CreateStructGEP(partial_type, partial_arg, i), var->name);
+        outer_reduction_allocas.push_back(var->alloca);
+        if (var->address_taken) {
+            var->alloca = builder.CreateAlloca(value->getType(), nullptr, var->name);
+            builder.CreateStore(value, var->alloca);
+        } else {
+            zulctx.ssa.write_var(var, entry_block, value);
+        }
+    }
+
+    //번호 대신 i로 바로 돌아서, 몸체의 인덱스 검사를 일반 ㄱㄱ문처럼 반복문 밖으로 올릴 수 있게 함
+    auto step_val = builder.getInt64(step_value);
+    auto first = builder.CreateNSWAdd(start_val, builder.CreateNSWMul(begin_arg, step_val), "first");
+    auto last = builder.CreateNSWAdd(start_val, builder.CreateNSWMul(builder.CreateSub(end_arg, builder.getInt64(1)),
+                                                                     step_val), "last");
+    auto enter_br = builder.CreateBr(test_block);
+    builder.SetInsertPoint(test_block);
+    auto index = builder.CreatePHI(int_type, 2, index_var->name);
+    index->addIncoming(first, entry_block);
+    auto test_br = builder.CreateCondBr(builder.CreateICmpSLE(index, last), start_block, end_block);
+
+    zulctx.ssa.seal_block(start_block);
+    builder.SetInsertPoint(start_block);
+    zulctx.ssa.write_var(index_var, start_block, index);
+    zulctx.loop_update_stack.push(update_block);
+    zulctx.loop_end_stack.push(end_block);
+    auto body_checks = zulctx.bounds_checks.size();
+    gen_body(zulctx, loop_body, update_block);
+    auto body_checks_end = zulctx.bounds_checks.size();
+    zulctx.loop_update_stack.pop();
+    zulctx.loop_end_stack.pop();
+
+    Value *arena_mark = nullptr;
+    if (zulctx.arena_allocs != 0) {
+        llvm::IRBuilder<> enter_builder(enter_br);
+        arena_mark = create_arena_mark(enter_builder);
+    }
+    zulctx.ssa.seal_block(update_block);
+    builder.SetInsertPoint(update_block);
+    if (arena_mark)
+        create_arena_release(builder, arena_mark);
+    index->addIncoming(builder.CreateNSWAdd(index, step_val), update_block);
+    auto latch_br = builder.CreateBr(test_block);
+    if (!hints.empty())
+        latch_br->setMetadata(llvm::LLVMContext::MD_loop, create_loop_id(context, hints));
+    zulctx.ssa.seal_block(test_block);
+    zulctx.ssa.seal_block(end_block);
+    if (body_checks != body_checks_end)
+        zulctx.checked_loops.push_back({enter_br, test_br, latch_br, body_checks, body_checks_end});
+
+    builder.SetInsertPoint(end_block);
+    if (arena_mark)
+        create_arena_release(builder, arena_mark);
+    for (unsigned i = 0; i < hints.reductions.size(); ++i) {
+        auto var = hints.reductions[i].var;
+        auto type = partial_type->getElementType(i);
+        auto value = var->address_taken ? builder.CreateLoad(type, var->alloca) : zulctx.ssa.read_var(var, end_block);
+        builder.CreateStore(value, builder.CreateStructGEP(partial_type, partial_arg, i));
+    }
+    builder.CreateRetVoid();
+    return func;
+}
+
+//void 합치기(ptr 결과, ptr 누적값). 스레드 하나의 누적값을 결과에 합침
+llvm::Function *ParallelLoopAST::create_combine_func(ZulContext &zulctx, llvm::StructType *partial_type) {
+    auto &context = *zulctx.context;
+    auto &builder = zulctx.builder;
+    auto outer_block = builder.GetInsertBlock();
+    Guard guard{[&]() { builder.SetInsertPoint(outer_block); }};
+    auto ptr_type = PointerType::getUnqual(context);
+    auto func_type = llvm::FunctionType::get(Type::getVoidTy(context), {ptr_type, ptr_type}, false);
+    auto func = llvm::Function::Create(func_type, llvm::Function::InternalLinkage,
+                                       outer_block->getParent()->getName() + ".누적", *zulctx.module);
+    func->setDoesNotThrow();
+    auto dst_arg = func->getArg(0);
+    auto src_arg = func->getArg(1);
+    dst_arg->setName("dst");
+    src_arg->setName("src");
+    for (auto arg: {dst_arg, src_arg}) {
+        arg->addAttr(llvm::Attribute::NoAlias);
+        arg->addAttr(llvm::Attribute::NoCapture);
+    }
+    src_arg->addAttr(llvm::Attribute::ReadOnly);
+
+    builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", func));
+    for (unsigned i = 0; i < hints.reductions.size(); ++i) {
+        auto &reduction = hints.reductions[i];
+        Capture<Token> op(reduction.op, reduction.loc, reduction.word_size);
+        auto type = partial_type->getElementType(i);
+        auto dst_ptr = builder.CreateStructGEP(partial_type, dst_arg, i);
+        auto lhs = builder.CreateLoad(type, dst_ptr);
+        auto rhs = builder.CreateLoad(type, builder.CreateStructGEP(partial_type, src_arg, i));
+        //최소, 최대는 비교 연산자로 나타냄. lhs < rhs ? lhs : rhs
+        auto result = type->isDoubleTy() ? create_float_operation(zulctx, lhs, rhs, op)
+                                         : create_int_operation(zulctx, lhs, rhs, op);
+        if (op.value == tok_lt || op.value == tok_gt)
+            result = builder.CreateSelect(result, lhs, rhs);
+        builder.CreateStore(result, dst_ptr);
+    }
+    builder.CreateRetVoid();
+    return func;
+}
+
+ZulValue ParallelLoopAST::code_gen(ZulContext &zulctx) {
+    auto &builder = zulctx.builder;
+    auto start_val = start.value->code_gen(zulctx);
+    auto bound_val = bound.value->code_gen(zulctx);
+    auto step_val = step.value->code_gen(zulctx);
+    if (!start_val.first || !bound_val.first || !step_val.first)
+        return nullzul;
+    if (start_val.second != id_int && !create_cast(zulctx, start_val, id_int)) {
+        zulctx.logger.log_error(start.loc, start.word_size, "병렬 ㄱㄱ문의 시작값은 정수여야 합니다");
+        return nullzul;
+    }
+    if (bound_val.second != id_int) {
+        zulctx.logger.log_error(bound.loc, bound.word_size, "병렬 ㄱㄱ문의 끝값은 정수여야 합니다");
+        return nullzul;
+    }
+    auto const_step = llvm::dyn_cast<ConstantInt>(step_val.first);
+    if (step_val.second != id_int || !const_step || const_step->getSExtValue() <= 0) {
+        zulctx.logger.log_error(step.loc, step.word_size, "병렬 ㄱㄱ문의 증가량은 양의 정수 상수여야 합니다");
+        return nullzul;
+    }
+    auto step_value = const_step->getSExtValue();
+
+    //반복 횟수 = max(0, ceil((끝 - 시작) / 증가량))
+    Value *end_val = inclusive ? builder.CreateAdd(bound_val.first, builder.getInt64(1)) : bound_val.first;
+    auto span = builder.CreateSub(end_val, start_val.first);
+    auto count = builder.CreateSelect(builder.CreateICmpSGT(span, builder.getInt64(0)),
+                                      builder.CreateSDiv(builder.CreateAdd(span, builder.getInt64(step_value - 1)),
+                                                         builder.getInt64(step_value)),
+                                      builder.getInt64(0), "count");
+
+    vector<Type *> fields{builder.getInt64Ty()};
+    vector<Value *> values{start_val.first};
+    for (auto var: captures) {
+        auto type = get_llvm_type(*zulctx.context, var->type);
+        fields.push_back(type);
+        if (var->address_taken)
+            values.push_back(builder.CreateLoad(type, var->alloca));
+        else
+            values.push_back(zulctx.ssa.read_var(var, builder.GetInsertBlock()));
+        if (var->array_size) {
+            fields.push_back(builder.getInt64Ty());
+            values.push_back(var->array_size);
+        }
+    }
+    auto ctx_type = llvm::StructType::get(*zulctx.context, fields);
+
+    //누적 변수는 {누적 변수들} 구조체로 넘김. 런타임이 스레드마다 초깃값으로 채운 복사본을 만들어 주고 끝나면 합침
+    llvm::StructType *partial_type = nullptr;
+    vector<Type *> partial_fields;
+    vector<Value *> partial_values;
+    vector<llvm::Constant *> identities;
+    for (auto &reduction: hints.reductions) {
+        auto var = reduction.var;
+        auto type = get_llvm_type(*zulctx.context, var->type);
+        auto op = reduction.op;
+        if (var->type == id_float && op != tok_add && op != tok_mul && op != tok_lt && op != tok_gt) {
+            zulctx.logger.log_error(reduction.loc, reduction.word_size,
+                                    "실수 변수는 +, *, 최소, 최대로만 누적할 수 있습니다");
+            return nullzul;
+        }
+        partial_fields.push_back(type);
+        partial_values.push_back(var->address_taken ? builder.CreateLoad(type, var->alloca)
+                                                    : zulctx.ssa.read_var(var, builder.GetInsertBlock()));
+        identities.push_back(get_reduction_identity(type, op));
+    }
+    if (!partial_fields.empty())
+        partial_type = llvm::StructType::get(*zulctx.context, partial_fields);
+    auto body_func = create_body_func(zulctx, ctx_type, partial_type, step_value);
+
+    auto func = builder.GetInsertBlock()->getParent();
+    llvm::IRBuilder<> entry_builder(&func->getEntryBlock(), func->getEntryBlock().begin());
+    auto ctx = entry_builder.CreateAlloca(ctx_type, nullptr, "parallel_ctx");
+    for (unsigned i = 0; i < values.size(); ++i)
+        builder.CreateStore(values[i], builder.CreateStructGEP(ctx_type, ctx, i));
+    if (!partial_type) {
+        create_parallel_for(builder, body_func, ctx, count);
+        return nullzul;
+    }
+
+    auto combine_func = create_combine_func(zulctx, partial_type);
+    auto result = entry_builder.CreateAlloca(partial_type, nullptr, "reduction");
+    auto identity = entry_builder.CreateAlloca(partial_type, nullptr, "reduction_identity");
+    for (unsigned i = 0; i < partial_values.size(); ++i) {
+        builder.CreateStore(partial_values[i], builder.CreateStructGEP(partial_type, result, i));
+        builder.CreateStore(identities[i], builder.CreateStructGEP(partial_type, identity, i));
+    }
+    create_parallel_reduce(builder, body_func, ctx, count, combine_func, result, identity,
+                           llvm::ConstantExpr::getSizeOf(partial_type));
+    for (unsigned i = 0; i < partial_fields.size(); ++i) {
+        auto var = hints.reductions[i].var;
+        auto value = builder.CreateLoad(partial_fields[i], builder.CreateStructGEP(partial_type, result, i), var->name);
+        if (var->address_taken)
+            builder.CreateStore(value, var->alloca);
+        else
+            zulctx.ssa.write_var(var, builder.GetInsertBlock(), value);
+    }
+    return nullzul;
+}
+
+ZulValue ParallelLoopAST::const_eval(ConstEvaluator &evaluator) {
+    //반복끼리 서로의 결과를 읽지 않으므로 컴파일 타임에는 순서대로 실행해도 결과가 같음
+    auto start_val = evaluator.eval(*start.value);
+    auto bound_val = evaluator.eval(*bound.value);
+    auto step_val = evaluator.eval(*step.value);
+    if (evaluator.failed() || !evaluator.cast(start_val, id_int) || !evaluator.cast(bound_val, id_int) ||
+        !evaluator.cast(step_val, id_int))
+        return nullzul;
+    auto step_value = static_cast<ConstantInt *>(step_val.first)->getSExtValue();
+    if (step_value <= 0) {
+        evaluator.fail("병렬 ㄱㄱ문의 증가량은 양의 정수 상수여야 합니다");
+        return nullzul;
+    }
+    auto last = static_cast<ConstantInt *>(bound_val.first)->getSExtValue();
+    auto int_type = Type::getInt64Ty(*evaluator.zulctx.context);
+    for (auto i = static_cast<ConstantInt *>(start_val.first)->getSExtValue(); inclusive ? i <= last : i < last;
+         i += step_value) {
+        evaluator.declare_local(index_var->name, {ConstantInt::get(int_type, i, true), id_int});
+        evaluator.eval_block(loop_body);
+        if (evaluator.failed())
+            break;
+        evaluator.flow = ConstEvaluator::flow_normal; //ㅌㅌ문
+    }
     return nullzul;
 }
 
@@ -227,53 +718,127 @@ ZulValue ContinueAST::code_gen(ZulContext &zulctx) {
     return {nullptr, id_interrupt};
 }
 
+ZulValue ContinueAST::const_eval(ConstEvaluator &evaluator) {
+    evaluator.flow = ConstEvaluator::flow_continue;
+    return nullzul;
+}
+
 ZulValue BreakAST::code_gen(ZulContext &zulctx) {
     zulctx.builder.CreateBr(zulctx.loop_end_stack.top());
     return {nullptr, id_interrupt};
 }
 
-VariableAST::VariableAST(string name) : name(std::move(name)) {}
+ZulValue BreakAST::const_eval(ConstEvaluator &evaluator) {
+    evaluator.flow = ConstEvaluator::flow_break;
+    return nullzul;
+}
+
+VariableAST::VariableAST(string name, const SymbolTable &symbols) : name(std::move(name)) {
+    //이름은 여기서 한 번만 찾고, 코드 생성 때는 심볼을 그대로 사용함
+    if (auto iter = symbols.local_var_map.find(this->name); iter != symbols.local_var_map.end()) {
+        local = iter->second;
+        type_id = local->type >= TYPE_COUNTS * 2 ? local->type - TYPE_COUNTS : local->type;
+    } else if (auto global_iter = symbols.global_var_map.find(this->name); global_iter != symbols.global_var_map.end()) {
+        type_id = global_iter->second.second;
+    }
+}
 
 ZulValue VariableAST::get_origin_value(ZulContext &zulctx) {
-    if (zulctx.local_var_map.contains(name))
-        return zulctx.local_var_map[name];
-    if (zulctx.global_var_map.contains(name))
-        return zulctx.global_var_map[name];
-    return nullzul;
+    if (local)
+        return {local->alloca, local->type};
+    auto iter = zulctx.global_var_map.find(name);
+    if (iter == zulctx.global_var_map.end())
+        return nullzul;
+    return iter->second;
 }
 
 ZulValue VariableAST::code_gen(ZulContext &zulctx) {
+    if (local && !local->address_taken)
+        return {zulctx.ssa.read_var(local, zulctx.builder.GetInsertBlock()), type_id};
     auto value = get_origin_value(zulctx);
     if (!value.first)
         return nullzul;
+    if (!local && value.second < TYPE_COUNTS) { //상수는 메모리에서 읽지 않고 초깃값을 바로 사용함
+        auto global_var = static_cast<llvm::GlobalVariable *>(value.first);
+        if (global_var->isConstant() && global_var->hasInitializer())
+            return {global_var->getInitializer(), type_id};
+    }
     if (value.second < TYPE_COUNTS || value.second >= TYPE_COUNTS * 2) {
-        value.first = zulctx.builder.CreateLoad(get_llvm_type(*zulctx.context, value.second), value.first);
-        if (value.second >= TYPE_COUNTS * 2)
-            value.second -= TYPE_COUNTS;
+        auto load = zulctx.builder.CreateLoad(get_llvm_type(*zulctx.context, value.second), value.first);
+        set_tbaa(load, value.second);
+        value.first = load;
+        value.second = type_id;
     }
     return value;
 }
 
-int VariableAST::get_typeid(ZulContext &zulctx) {
-    return get_origin_value(zulctx).second;
+ZulValue VariableAST::const_eval(ConstEvaluator &evaluator) {
+    if (auto local = evaluator.find_local(name)) {
+        if (!local->first)
+            evaluator.fail("\"" + name + "\" 변수가 초기화되지 않았습니다");
+        return *local;
+    }
+    if (evaluator.zulctx.global_var_map.contains(name))
+        return evaluator.read_global(name);
+    evaluator.fail("\"" + name + "\" 는 존재하지 않는 변수입니다");
+    return nullzul;
+}
+
+ZulValue *VariableAST::const_ref(ConstEvaluator &evaluator) {
+    auto local = evaluator.find_local(name);
+    if (!local)
+        evaluator.fail("컴파일 타임 계산 중에는 지역 변수에만 대입할 수 있습니다");
+    return local;
 }
 
-VariableDeclAST::VariableDeclAST(Capture<std::string> name, ZulContext &zulctx, int type, ASTPtr body) :
+bool VariableAST::is_readonly(ZulContext &zulctx) {
+    if (local)
+        return false;
+    auto iter = zulctx.global_var_map.find(name);
+    return iter != zulctx.global_var_map.end() && iter->second.first->isConstant();
+}
+
+Value *VariableAST::store(ZulContext &zulctx, Value *value) {
+    if (local && !local->address_taken) {
+        zulctx.ssa.write_var(local, zulctx.builder.GetInsertBlock(), value);
+        return value;
+    }
+    auto origin = get_origin_value(zulctx);
+    auto store = zulctx.builder.CreateStore(value, origin.first);
+    set_tbaa(store, origin.second);
+    return store;
+}
+
+void VariableAST::take_address() {
+    if (local && local->type < TYPE_COUNTS) //배열은 포인터 값을 그대로 넘기므로 주소가 필요 없음
+        local->address_taken = true;
+}
+
+Value *VariableAST::get_array_size(ZulContext &zulctx, Value *array) const {
+    if (local)
+        return local->array_size;
+    if (auto global_var = llvm::dyn_cast<llvm::GlobalVariable>(array)) {
+        if (auto arr_type = llvm::dyn_cast<llvm::ArrayType>(global_var->getValueType()))
+            return zulctx.builder.getInt64(arr_type->getNumElements());
+    }
+    return nullptr;
+}
+
+VariableDeclAST::VariableDeclAST(Capture<std::string> name, SymbolTable &symbols, int type, ASTPtr body) :
         name(std::move(name)), type(type), body(std::move(body)) {
-    register_var(zulctx);
+    register_var(symbols);
 }
 
-VariableDeclAST::VariableDeclAST(Capture<std::string> name, ZulContext &zulctx, ASTPtr body) :
+VariableDeclAST::VariableDeclAST(Capture<std::string> name, SymbolTable &symbols, ASTPtr body) :
         name(std::move(name)), type(-1), body(std::move(body)) {
-    register_var(zulctx);
+    register_var(symbols);
 }
 
-void VariableDeclAST::register_var(ZulContext &zulctx) {
-    int t = (type == -1 ? body->get_typeid(zulctx) : type);
-    zulctx.local_var_map.emplace(name.value, make_pair(nullptr, t)); //이름만 등록 해놓기
-    if (!zulctx.scope_stack.empty()) { //만약 스코프 안에 있다면
-        zulctx.scope_stack.top().push_back(name.value); //가장 가까운 스코프에 변수 등록
-    }
+void VariableDeclAST::register_var(SymbolTable &symbols) {
+    int t = (type == -1 ? body->get_typeid() : type);
+    if (TYPE_COUNTS <= t && t < TYPE_COUNTS * 2) //배열 타입일 경우 포인터로 변환함
+        t += TYPE_COUNTS;
+    var = symbols.declare_local(name.value, t);
 }
 
 ZulValue VariableDeclAST::code_gen(ZulContext &zulctx) {
@@ -283,76 +848,197 @@ ZulValue VariableDeclAST::code_gen(ZulContext &zulctx) {
         if (!result.first)
             return nullzul;
         if (type != -1 && type != result.second && !create_cast(zulctx, result, type)) {
-            System::logger.log_error(name.loc, name.word_size,
-                                     {"대입 연산식의 타입 \"",
-                                      get_type_name(result.second), "\" 에서 변수의 타입 \"",
-                                      get_type_name(type),
-                                      "\" 로 캐스팅 할 수 없습니다"});
+            zulctx.logger.log_error(name.loc, name.word_size,
+                                    {"대입 연산식의 타입 \"",
+                                     get_type_name(result.second), "\" 에서 변수의 타입 \"",
+                                     get_type_name(type),
+                                     "\" 로 캐스팅 할 수 없습니다"});
             return nullzul;
         }
-        if (type == -1) //타입 명시가 안됐을 때만
-            type = result.second; //추론된 타입 적용
         init_val = result.first;
     }
-    if (type == -1) {
-        System::logger.log_error(name.loc, name.word_size, {"\"", get_type_name(type), "\" 타입의 변수를 생성할 수 없습니다"});
+    if (var->type == -1) {
+        zulctx.logger.log_error(name.loc, name.word_size, {"\"", get_type_name(var->type), "\" 타입의 변수를 생성할 수 없습니다"});
         return nullzul;
     }
-    if (TYPE_COUNTS < type && type < TYPE_COUNTS * 2) //배열 타입일 경우 포인터로 변환함
-        type += TYPE_COUNTS;
+    if (!body) //초기화하지 않은 지역 변수는 0으로 시작함
+        init_val = Constant::getNullValue(get_llvm_type(*zulctx.context, var->type));
+    if (!var->address_taken) {
+        zulctx.ssa.write_var(var, zulctx.builder.GetInsertBlock(), init_val);
+        return {init_val, var->type};
+    }
     auto func = zulctx.builder.GetInsertBlock()->getParent();
     llvm::IRBuilder<> entry_builder(&func->getEntryBlock(), func->getEntryBlock().begin());
-    auto alloca_val = entry_builder.CreateAlloca(get_llvm_type(*zulctx.context, type), nullptr, name.value);
-    zulctx.local_var_map[name.value] = make_pair(alloca_val, type);
+    auto alloca_val = entry_builder.CreateAlloca(get_llvm_type(*zulctx.context, var->type), nullptr, name.value);
+    var->alloca = alloca_val;
+    zulctx.builder.CreateStore(init_val, alloca_val);
+    return {alloca_val, var->type};
+}
+
+ZulValue VariableDeclAST::const_eval(ConstEvaluator &evaluator) {
+    int decl_type = var->type >= TYPE_COUNTS * 2 ? var->type - TYPE_COUNTS : var->type; //배열은 포인터로 바뀌어 있음
+    ZulValue value{nullptr, decl_type};
+    if (body) {
+        value = evaluator.eval(*body);
+        if (evaluator.failed() || (decl_type != -1 && !evaluator.cast(value, decl_type)))
+            return nullzul;
+    } else if (decl_type >= TYPE_COUNTS) {
+        evaluator.fail("컴파일 타임 계산에서는 배열 변수를 만들 수 없습니다");
+        return nullzul;
+    }
+    evaluator.declare_local(name.value, value);
+    return nullzul;
+}
 
-    if (body)
-        zulctx.builder.CreateStore(init_val, alloca_val);
-    return {alloca_val, type};
+ArrayDeclAST::ArrayDeclAST(Capture<std::string> name, SymbolTable &symbols, int elm_type, Capture<ASTPtr> size,
+                           vector<Capture<ASTPtr>> elements) :
+        name(std::move(name)), elm_type(elm_type), size(std::move(size)), elements(std::move(elements)) {
+    if (this->elm_type == -1) { //원소 타입 추론. 전역 배열과 같이 가장 큰 타입으로 맞춤
+        this->elm_type = id_bool;
+        for (auto &elm: this->elements) {
+            this->elm_type = max(this->elm_type, elm.value->get_typeid());
+        }
+    }
+    bool valid = 0 <= this->elm_type && this->elm_type < TYPE_COUNTS;
+    var = symbols.declare_local(this->name.value, valid ? this->elm_type + TYPE_COUNTS * 2 : -1);
+}
+
+ZulValue ArrayDeclAST::code_gen(ZulContext &zulctx) {
+    if (var->type == -1) {
+        zulctx.logger.log_error(name.loc, name.word_size, {"\"", get_type_name(elm_type), "\" 타입의 배열을 생성할 수 없습니다"});
+        return nullzul;
+    }
+    //크기 식이 상수로 접히면 고정 크기 배열이 됨
+    auto size_val = size.value->code_gen(zulctx);
+    if (!size_val.first)
+        return nullzul;
+    if (size_val.second != id_int) {
+        zulctx.logger.log_error(size.loc, size.word_size, "배열 크기는 정수여야 합니다");
+        return nullzul;
+    }
+    auto elm_llvm_type = get_llvm_type(*zulctx.context, elm_type);
+    auto &layout = zulctx.module->getDataLayout();
+    auto elm_size = layout.getTypeAllocSize(elm_llvm_type).getFixedValue();
+    auto const_size = llvm::dyn_cast<ConstantInt>(size_val.first);
+    if (const_size) {
+        auto count = const_size->getSExtValue();
+        if (count <= 0) {
+            zulctx.logger.log_error(size.loc, size.word_size, "배열 크기는 0보다 커야 합니다");
+            return nullzul;
+        }
+        if (static_cast<long long>(elements.size()) > count) {
+            zulctx.logger.log_error(name.loc, name.word_size, {"배열 원소의 개수가 배열 크기 ", to_string(count), "보다 많습니다"});
+            return nullzul;
+        }
+    } else if (!elements.empty()) {
+        zulctx.logger.log_error(size.loc, size.word_size, "크기가 상수가 아닌 배열은 리터럴 배열로 초기화할 수 없습니다");
+        return nullzul;
+    }
+
+    Value *arr_ptr;
+    llvm::Align arr_align{ARENA_ALIGN};
+    Value *bytes = zulctx.builder.CreateMul(size_val.first, zulctx.builder.getInt64(elm_size));
+    if (const_size && const_size->getZExtValue() * elm_size <= LOCAL_ARRAY_STACK_LIMIT) {
+        //alloca는 진입 블록에 두고, 스코프가 끝나면 lifetime.end로 다른 배열이 스택을 재사용할 수 있게 함
+        auto func = zulctx.builder.GetInsertBlock()->getParent();
+        llvm::IRBuilder<> entry_builder(&func->getEntryBlock(), func->getEntryBlock().begin());
+        auto arr_type = llvm::ArrayType::get(elm_llvm_type, const_size->getZExtValue());
+        auto alloca_val = entry_builder.CreateAlloca(arr_type, nullptr, name.value);
+        alloca_val->setAlignment(get_array_align(layout, arr_type));
+        auto byte_size = const_size->getZExtValue() * elm_size;
+        zulctx.builder.CreateLifetimeStart(alloca_val, zulctx.builder.getInt64(byte_size));
+        zulctx.scope_arrays.emplace_back(alloca_val, byte_size);
+        arr_ptr = alloca_val;
+        arr_align = alloca_val->getAlign();
+    } else {
+        //스택에 두기 큰 배열과 런타임 크기 배열은 아레나에서 할당하고, 함수나 반복문의 한 바퀴가 끝날 때 한 번에 해제함
+        arr_ptr = create_arena_alloc(zulctx.builder, bytes);
+        ++zulctx.arena_allocs;
+    }
+    vector<Value *> elm_values;
+    elm_values.reserve(elements.size());
+    for (auto &element: elements) {
+        auto elm_val = element.value->code_gen(zulctx);
+        if (!elm_val.first)
+            return nullzul;
+        if (elm_val.second != elm_type && !create_cast(zulctx, elm_val, elm_type)) {
+            zulctx.logger.log_error(element.loc, element.word_size,
+                                    {"원소의 타입 \"", get_type_name(elm_val.second), "\" 에서 배열의 타입 \"",
+                                     get_type_name(elm_type), "\" 로 캐스팅 할 수 없습니다"});
+            return nullzul;
+        }
+        elm_values.push_back(elm_val.first);
+    }
+
+    //원소가 모두 상수면 같은 값의 리터럴끼리 나눠 쓰는 상수 배열에서 한 번에 복사하고, 나머지만 0으로 채움
+    if (elm_values.size() >= POOLED_ARRAY_MIN_ELEMENTS &&
+        llvm::all_of(elm_values, [](Value *value) { return llvm::isa<Constant>(value); })) {
+        vector<Constant *> consts;
+        consts.reserve(elm_values.size());
+        for (auto value: elm_values) {
+            consts.push_back(llvm::cast<Constant>(value));
+        }
+        auto init = llvm::ConstantArray::get(llvm::ArrayType::get(elm_llvm_type, consts.size()), consts);
+        auto pooled = zulctx.const_pool.get_array(*zulctx.module, init);
+        auto init_bytes = consts.size() * elm_size;
+        zulctx.builder.CreateMemCpy(arr_ptr, arr_align, pooled, pooled->getAlign(), init_bytes);
+        if (const_size->getZExtValue() > consts.size()) {
+            auto rest = zulctx.builder.CreateConstInBoundsGEP1_64(elm_llvm_type, arr_ptr, consts.size());
+            zulctx.builder.CreateMemSet(rest, zulctx.builder.getInt8(0), const_size->getZExtValue() * elm_size - init_bytes,
+                                        llvm::commonAlignment(arr_align, init_bytes));
+        }
+    } else {
+        zulctx.builder.CreateMemSet(arr_ptr, zulctx.builder.getInt8(0), bytes, arr_align);
+        for (size_t i = 0; i < elm_values.size(); ++i) {
+            auto elm_ptr = zulctx.builder.CreateConstInBoundsGEP1_64(elm_llvm_type, arr_ptr, i);
+            set_tbaa(zulctx.builder.CreateStore(elm_values[i], elm_ptr), elm_type);
+        }
+    }
+    var->array_size = size_val.first;
+    zulctx.ssa.write_var(var, zulctx.builder.GetInsertBlock(), arr_ptr);
+    return {arr_ptr, elm_type + TYPE_COUNTS};
+}
+
+ZulValue ArrayDeclAST::const_eval(ConstEvaluator &evaluator) {
+    evaluator.fail("컴파일 타임 계산에서는 배열 변수를 만들 수 없습니다");
+    return nullzul;
 }
 
 VariableAssnAST::VariableAssnAST(unique_ptr<LvalueAST> target, Capture<Token> op, ASTPtr body) :
         target(std::move(target)), op(std::move(op)), body(std::move(body)) {}
 
 ZulValue VariableAssnAST::code_gen(ZulContext &zulctx) {
-    static unordered_map<Token, Token> assn_op_map = {
-            {tok_mul_assn,    tok_mul},
-            {tok_div_assn,    tok_div},
-            {tok_mod_assn,    tok_mod},
-            {tok_add_assn,    tok_add},
-            {tok_sub_assn,    tok_sub},
-            {tok_lshift_assn, tok_lshift},
-            {tok_rshift_assn, tok_rshift},
-            {tok_and_assn,    tok_bitand},
-            {tok_or_assn,     tok_bitor},
-            {tok_xor_assn,    tok_bitxor}
-    };
+    if (target->is_readonly(zulctx)) {
+        zulctx.logger.log_error(op.loc, op.word_size, "상수의 값은 바꿀 수 없습니다");
+        return nullzul;
+    }
     auto target_value = target->code_gen(zulctx);
     auto body_value = body->code_gen(zulctx);
 
     if (!target_value.first || !body_value.first ||
-        target_value.second > id_float || body_value.second > id_float) {
-        System::logger.log_error(op.loc, op.word_size,
-                                 {"대입 연산식의 타입 \"",
-                                  get_type_name(target_value.second), "\" 와 변수의 타입 \"",
-                                  get_type_name(body_value.second),
-                                  "\" 는 연산이 불가능합니다"});
+        target_value.second >= TYPE_COUNTS || body_value.second >= TYPE_COUNTS) {
+        zulctx.logger.log_error(op.loc, op.word_size,
+                                {"대입 연산식의 타입 \"",
+                                 get_type_name(target_value.second), "\" 와 변수의 타입 \"",
+                                 get_type_name(body_value.second),
+                                 "\" 는 연산이 불가능합니다"});
         return nullzul;
     }
 
     if (target_value.second != body_value.second && !create_cast(zulctx, body_value, target_value.second)) {
-        System::logger.log_error(op.loc, op.word_size,
-                                 {"대입 연산식의 타입 \"",
-                                  get_type_name(target_value.second), "\" 에서 변수의 타입 \"",
-                                  get_type_name(body_value.second),
-                                  "\" 로 캐스팅 할 수 없습니다"});
+        zulctx.logger.log_error(op.loc, op.word_size,
+                                {"대입 연산식의 타입 \"",
+                                 get_type_name(target_value.second), "\" 에서 변수의 타입 \"",
+                                 get_type_name(body_value.second),
+                                 "\" 로 캐스팅 할 수 없습니다"});
         return nullzul;
     }
     llvm::Value *result;
     if (op.value == tok_assn) {
         result = body_value.first;
     } else {
-        auto prac_op = Capture(assn_op_map[op.value], op.loc, op.word_size);
-        if (target_value.second < id_float) {
+        auto prac_op = Capture(assn_op_map.at(op.value), op.loc, op.word_size);
+        if (get_lane_type(target_value.second) < id_float) {
             result = create_int_operation(zulctx, target_value.first, body_value.first, prac_op);
         } else {
             result = create_float_operation(zulctx, target_value.first, body_value.first, prac_op);
@@ -360,19 +1046,60 @@ ZulValue VariableAssnAST::code_gen(ZulContext &zulctx) {
         if (!result)
             return nullzul;
     }
-    return {zulctx.builder.CreateStore(result, target->get_origin_value(zulctx).first), target_value.second};
+    return {target->store(zulctx, result), target_value.second};
+}
+
+ZulValue VariableAssnAST::const_eval(ConstEvaluator &evaluator) {
+    auto target_ref = target->const_ref(evaluator);
+    if (!target_ref)
+        return nullzul;
+    auto body_value = evaluator.eval(*body);
+    if (evaluator.failed())
+        return nullzul;
+    if (target_ref->second > id_float || body_value.second > id_float || body_value.second < 0) {
+        evaluator.fail("대입 연산식의 타입이 연산이 불가능한 타입입니다");
+        return nullzul;
+    }
+    if (!evaluator.cast(body_value, target_ref->second))
+        return nullzul;
+    if (op.value != tok_assn) {
+        if (!target_ref->first) {
+            evaluator.fail("초기화되지 않은 변수에 복합 대입 연산을 할 수 없습니다");
+            return nullzul;
+        }
+        auto prac_op = Capture(assn_op_map.at(op.value), op.loc, op.word_size);
+        Value *result;
+        if (target_ref->second < id_float) {
+            result = create_int_operation(evaluator.zulctx, target_ref->first, body_value.first, prac_op);
+        } else {
+            result = create_float_operation(evaluator.zulctx, target_ref->first, body_value.first, prac_op);
+        }
+        body_value = evaluator.fold(result, target_ref->second);
+        if (evaluator.failed())
+            return nullzul;
+    }
+    *target_ref = body_value;
+    return nullzul;
 }
 
 BinOpAST::BinOpAST(ASTPtr left, ASTPtr right, Capture<Token> op) : left(std::move(left)),
                                                                    right(std::move(right)),
-                                                                   op(std::move(op)) {}
+                                                                   op(std::move(op)) {
+    //자식들의 타입은 이미 정해져 있으므로 다시 순회하지 않음
+    int ltype = this->left->get_typeid();
+    int rtype = this->right->get_typeid();
+    if (this->op.value == tok_and || this->op.value == tok_or)
+        type_id = id_bool;
+    else if (is_arithmetic_type(ltype) && is_arithmetic_type(rtype))
+        type_id = is_cmp(this->op.value) ? id_bool : max(ltype, rtype);
+}
 
 ZulValue BinOpAST::short_circuit_code_gen(ZulContext &zulctx) const {
     auto lhs = left->code_gen(zulctx);
     if (!lhs.first)
         return nullzul;
     if (!to_boolean_expr(zulctx, lhs)) {
-        System::logger.log_error(op.loc, op.word_size, "좌측항을 \"논리\" 자료형으로 캐스팅 할 수 없습니다");
+        zulctx.logger.log_error(op.loc, op.word_size, "좌측항을 \"논리\" 자료형으로 캐스팅 할 수 없습니다");
         return nullzul;
     }
 
@@ -386,17 +1113,19 @@ ZulValue BinOpAST::short_circuit_code_gen(ZulContext &zulctx) const {
     else
         zulctx.builder.CreateCondBr(lhs.first, sc_end, sc_test);
 
+    zulctx.ssa.seal_block(sc_test);
     zulctx.builder.SetInsertPoint(sc_test);
     auto rhs = right->code_gen(zulctx);
     if (!rhs.first)
         return nullzul;
     if (!to_boolean_expr(zulctx, rhs)) {
-        System::logger.log_error(op.loc, op.word_size, "우측항을 \"논리\" 자료형으로 캐스팅 할 수 없습니다");
+        zulctx.logger.log_error(op.loc, op.word_size, "우측항을 \"논리\" 자료형으로 캐스팅 할 수 없습니다");
         return nullzul;
     }
     zulctx.builder.CreateBr(sc_end);
     auto last_block = zulctx.builder.GetInsertBlock();
 
+    zulctx.ssa.seal_block(sc_end);
     zulctx.builder.SetInsertPoint(sc_end);
     auto phi = zulctx.builder.CreatePHI(get_llvm_type(*zulctx.context, 0), 2);
     phi->addIncoming(llvm::ConstantInt::getBool(*zulctx.context, op.value == tok_or), origin_block);
@@ -412,37 +1141,41 @@ ZulValue BinOpAST::code_gen(ZulContext &zulctx) {
     auto rhs = right->code_gen(zulctx);
     if (!lhs.first || !rhs.first)
         return nullzul;
-    if (lhs.second > id_float || rhs.second > id_float) { //연산자 오버로딩 지원 하게되면 변경
-        System::logger.log_error(op.loc, op.word_size, {"좌측항의 타입 \"",
-                                                        get_type_name(lhs.second), "\" 와 우측항의 타입 \"",
-                                                        get_type_name(rhs.second),
-                                                        "\" 는 연산이 불가능합니다"});
+    if (!is_arithmetic_type(lhs.second) || !is_arithmetic_type(rhs.second)) { //연산자 오버로딩 지원 하게되면 변경
+        zulctx.logger.log_error(op.loc, op.word_size, {"좌측항의 타입 \"",
+                                                       get_type_name(lhs.second), "\" 와 우측항의 타입 \"",
+                                                       get_type_name(rhs.second),
+                                                       "\" 는 연산이 불가능합니다"});
         return nullzul;
     }
     int calc_type = lhs.second;
     if (lhs.second > rhs.second) {
         calc_type = lhs.second;
         if (!create_cast(zulctx, rhs, lhs.second)) {
-            System::logger.log_error(op.loc, op.word_size,
-                                     {"우측항의 타입 \"",
-                                      get_type_name(rhs.second), "\" 에서 좌측항의 타입 \"",
-                                      get_type_name(lhs.second),
-                                      "\" 로 캐스팅 할 수 없습니다"});
+            zulctx.logger.log_error(op.loc, op.word_size,
+                                    {"우측항의 타입 \"",
+                                     get_type_name(rhs.second), "\" 에서 좌측항의 타입 \"",
+                                     get_type_name(lhs.second),
+                                     "\" 로 캐스팅 할 수 없습니다"});
             return nullzul;
         }
     } else if (lhs.second < rhs.second) {
         calc_type = rhs.second;
         if (!create_cast(zulctx, lhs, rhs.second)) {
-            System::logger.log_error(op.loc, op.word_size,
-                                     {"좌측항의 타입 \"",
-                                      get_type_name(lhs.second), "\" 에서 우측항의 타입 \"",
-                                      get_type_name(rhs.second),
-                                      "\" 로 캐스팅 할 수 없습니다"});
+            zulctx.logger.log_error(op.loc, op.word_size,
+                                    {"좌측항의 타입 \"",
+                                     get_type_name(lhs.second), "\" 에서 우측항의 타입 \"",
+                                     get_type_name(rhs.second),
+                                     "\" 로 캐스팅 할 수 없습니다"});
             return nullzul;
         }
     }
+    if (is_vector_type(calc_type) && is_cmp(op.value)) { //원소마다 비교한 결과를 담을 논리 벡터 타입이 없음
+        zulctx.logger.log_error(op.loc, op.word_size, {"\"", get_type_name(calc_type), "\" 타입은 비교할 수 없습니다. 원소를 하나씩 비교하세요"});
+        return nullzul;
+    }
     llvm::Value *ret;
-    if (calc_type < id_float) {
+    if (get_lane_type(calc_type) < id_float) {
         ret = create_int_operation(zulctx, lhs.first, rhs.first, op);
     } else {
         ret = create_float_operation(zulctx, lhs.first, rhs.first, op);
@@ -451,36 +1184,59 @@ ZulValue BinOpAST::code_gen(ZulContext &zulctx) {
     return {ret, calc_type};
 }
 
+ZulValue BinOpAST::const_eval(ConstEvaluator &evaluator) {
+    if (op.value == tok_and || op.value == tok_or) {
+        bool lhs, rhs;
+        if (!evaluator.eval_cond(*left, lhs))
+            return nullzul;
+        if (lhs == (op.value == tok_or)) //단락 평가
+            return {ConstantInt::getBool(*evaluator.zulctx.context, lhs), id_bool};
+        if (!evaluator.eval_cond(*right, rhs))
+            return nullzul;
+        return {ConstantInt::getBool(*evaluator.zulctx.context, rhs), id_bool};
+    }
+    auto lhs = evaluator.eval(*left);
+    auto rhs = evaluator.eval(*right);
+    if (evaluator.failed())
+        return nullzul;
+    if (lhs.second > id_float || rhs.second > id_float || lhs.second < id_bool || rhs.second < id_bool) {
+        evaluator.fail("좌측항과 우측항의 타입은 연산이 불가능합니다");
+        return nullzul;
+    }
+    int calc_type = max(lhs.second, rhs.second);
+    if (!evaluator.cast(lhs, calc_type) || !evaluator.cast(rhs, calc_type))
+        return nullzul;
+    Value *ret;
+    if (calc_type < id_float) {
+        ret = create_int_operation(evaluator.zulctx, lhs.first, rhs.first, op);
+    } else {
+        ret = create_float_operation(evaluator.zulctx, lhs.first, rhs.first, op);
+    }
+    return evaluator.fold(ret, is_cmp(op.value) ? id_bool : calc_type);
+}
+
 bool BinOpAST::is_const() {
     return left->is_const() && right->is_const() && op.value != tok_and && op.value != tok_or;
 }
 
-int BinOpAST::get_typeid(ZulContext &zulctx) {
-    if (op.value == tok_and || op.value == tok_or)
-        return 0;
-    int ltype = left->get_typeid(zulctx);
-    int rtype = right->get_typeid(zulctx);
-    if (ltype > id_float || rtype > id_float || ltype < id_bool || rtype < id_bool)
-        return -1;
-    return max(ltype, rtype);
+UnaryOpAST::UnaryOpAST(ASTPtr body, Capture<Token> op) : body(std::move(body)), op(std::move(op)) {
+    type_id = this->op.value == tok_not ? id_bool : this->body->get_typeid();
 }
 
-UnaryOpAST::UnaryOpAST(ASTPtr body, Capture<Token> op) : body(std::move(body)), op(std::move(op)) {}
-
 ZulValue UnaryOpAST::code_gen(ZulContext &zulctx) {
     auto body_value = body->code_gen(zulctx);
     auto zero = get_const_zero(body_value.first->getType(), body_value.second);
     if (!body_value.first)
         return nullzul;
-    if (body_value.second > id_float) {
-        System::logger.log_error(op.loc, op.word_size, "단항 연산자를 적용할 수 없습니다");
+    if (!is_arithmetic_type(body_value.second) || (is_vector_type(body_value.second) && op.value == tok_not)) {
+        zulctx.logger.log_error(op.loc, op.word_size, "단항 연산자를 적용할 수 없습니다");
         return nullzul;
     }
     switch (op.value) {
         case tok_add:
             break;
         case tok_sub:
-            if (body_value.second < id_float)
+            if (get_lane_type(body_value.second) < id_float)
                 return {zulctx.builder.CreateSub(zero, body_value.first), body_value.second};
             else
                 return {zulctx.builder.CreateFSub(zero, body_value.first), body_value.second};
@@ -490,34 +1246,69 @@ ZulValue UnaryOpAST::code_gen(ZulContext &zulctx) {
             else
                 return {zulctx.builder.CreateFCmpOEQ(zero, body_value.first), 0};
         case tok_bitnot:
-            if (body_value.second == id_float) {
-                System::logger.log_error(op.loc, op.word_size, "단항 '~' 연산자를 적용할 수 없습니다");
+            if (get_lane_type(body_value.second) == id_float) {
+                zulctx.logger.log_error(op.loc, op.word_size, "단항 '~' 연산자를 적용할 수 없습니다");
                 return nullzul;
             }
             return {zulctx.builder.CreateNot(body_value.first), body_value.second};
         default:
-            System::logger.log_error(op.loc, op.word_size, "올바른 단항 연산자가 아닙니다");
+            zulctx.logger.log_error(op.loc, op.word_size, "올바른 단항 연산자가 아닙니다");
             return nullzul;
     }
     return body_value;
 }
 
-bool UnaryOpAST::is_const() {
-    return body->is_const();
+ZulValue UnaryOpAST::const_eval(ConstEvaluator &evaluator) {
+    auto body_value = evaluator.eval(*body);
+    if (evaluator.failed())
+        return nullzul;
+    if (body_value.second > id_float || body_value.second < id_bool) {
+        evaluator.fail("단항 연산자를 적용할 수 없습니다");
+        return nullzul;
+    }
+    auto &builder = evaluator.zulctx.builder;
+    auto zero = get_const_zero(body_value.first->getType(), body_value.second);
+    switch (op.value) {
+        case tok_add:
+            return body_value;
+        case tok_sub:
+            if (body_value.second < id_float)
+                return evaluator.fold(builder.CreateSub(zero, body_value.first), body_value.second);
+            return evaluator.fold(builder.CreateFSub(zero, body_value.first), body_value.second);
+        case tok_not:
+            if (body_value.second < id_float)
+                return evaluator.fold(builder.CreateICmpEQ(zero, body_value.first), id_bool);
+            return evaluator.fold(builder.CreateFCmpOEQ(zero, body_value.first), id_bool);
+        case tok_bitnot:
+            if (body_value.second == id_float)
+                break;
+            return evaluator.fold(builder.CreateNot(body_value.first), body_value.second);
+        default:
+            break;
+    }
+    evaluator.fail("단항 연산자를 적용할 수 없습니다");
+    return nullzul;
 }
 
-int UnaryOpAST::get_typeid(ZulContext &zulctx) {
-    if (op.value == tok_not)
-        return 0;
-    return body->get_typeid(zulctx);
+bool UnaryOpAST::is_const() {
+    return body->is_const();
 }
 
 SubscriptAST::SubscriptAST(std::unique_ptr<VariableAST> target, Capture<ASTPtr> index) : target(std::move(target)),
-                                                                                         index(std::move(index)) {}
+                                                                                         index(std::move(index)) {
+    if (this->target->get_typeid() >= TYPE_COUNTS)
+        type_id = this->target->get_typeid() - TYPE_COUNTS;
+    else if (is_vector_type(this->target->get_typeid())) //벡터의 원소
+        type_id = get_lane_type(this->target->get_typeid());
+}
 
 ZulValue SubscriptAST::get_origin_value(ZulContext &zulctx) {
+    if (is_vector_type(target->get_typeid())) {
+        zulctx.logger.log_error(index.loc, index.word_size, "벡터의 원소는 주소가 없으므로 입력받을 수 없습니다");
+        return nullzul;
+    }
     ZulValue target_val;
-    if (target->get_typeid(zulctx) >= TYPE_COUNTS * 2) {
+    if (target->local) { //지역 변수에는 배열의 포인터가 저장되어 있음
         target_val = target->code_gen(zulctx);
     } else {
         target_val = target->get_origin_value(zulctx);
@@ -526,87 +1317,243 @@ ZulValue SubscriptAST::get_origin_value(ZulContext &zulctx) {
     if (!target_val.first || !index_val.first)
         return nullzul;
     if (target_val.second < TYPE_COUNTS) {
-        System::logger.log_error(index.loc, index.word_size, "'[]' 연산자를 사용할 수 없습니다. 배열이 아닙니다.");
+        zulctx.logger.log_error(index.loc, index.word_size, "'[]' 연산자를 사용할 수 없습니다. 배열이 아닙니다.");
         return nullzul;
     }
     if (index_val.second != 2) {
-        System::logger.log_error(index.loc, index.word_size, "배열의 인덱스는 정수여야 합니다");
+        zulctx.logger.log_error(index.loc, index.word_size, "배열의 인덱스는 정수여야 합니다");
         return nullzul;
     }
+    if (zulctx.session.bounds_check) {
+        //배열의 포인터만 받는 매개변수처럼 크기를 모르는 배열은 검사하지 않음
+        if (auto size = target->get_array_size(zulctx, target_val.first))
+            create_bounds_check(zulctx, index_val.first, size, index.loc.first);
+    }
     target_val.second -= TYPE_COUNTS;
     auto elm_type = get_llvm_type(*zulctx.context, target_val.second);
-    auto elm_ptr = zulctx.builder.CreateGEP(elm_type, target_val.first, {index_val.first});
+    //범위를 벗어난 접근은 정의되지 않은 동작이므로 inbounds로 만들어서 최적화가 주소 계산의 오버플로를 고려하지 않게 함
+    auto elm_ptr = zulctx.builder.CreateInBoundsGEP(elm_type, target_val.first, {index_val.first});
     return {elm_ptr, target_val.second};
 }
 
+Value *SubscriptAST::get_lane_index(ZulContext &zulctx) {
+    auto index_val = index.value->code_gen(zulctx);
+    if (!index_val.first)
+        return nullptr;
+    if (index_val.second != id_int) {
+        zulctx.logger.log_error(index.loc, index.word_size, "벡터의 원소 번호는 정수여야 합니다");
+        return nullptr;
+    }
+    auto lanes = get_lane_count(target->get_typeid());
+    if (auto const_index = llvm::dyn_cast<ConstantInt>(index_val.first)) {
+        if (const_index->getSExtValue() < 0 || const_index->getSExtValue() >= static_cast<long long>(lanes)) {
+            zulctx.logger.log_error(index.loc, index.word_size, {"벡터의 원소 번호는 0부터 ", to_string(lanes - 1), "까지입니다"});
+            return nullptr;
+        }
+    } else if (zulctx.session.bounds_check) {
+        create_bounds_check(zulctx, index_val.first, zulctx.builder.getInt64(lanes), index.loc.first);
+    }
+    return index_val.first;
+}
+
 ZulValue SubscriptAST::code_gen(ZulContext &zulctx) {
+    if (is_vector_type(target->get_typeid())) {
+        auto vector_val = target->code_gen(zulctx);
+        auto lane = get_lane_index(zulctx);
+        if (!vector_val.first || !lane)
+            return nullzul;
+        return {zulctx.builder.CreateExtractElement(vector_val.first, lane), type_id};
+    }
     auto elm_ptr = get_origin_value(zulctx);
+    if (!elm_ptr.first)
+        return nullzul;
     auto loaded = zulctx.builder.CreateLoad(get_llvm_type(*zulctx.context, elm_ptr.second), elm_ptr.first);
+    set_tbaa(loaded, elm_ptr.second);
     return {loaded, elm_ptr.second};
 }
 
-int SubscriptAST::get_typeid(ZulContext &zulctx) {
-    return target->get_typeid(zulctx) - TYPE_COUNTS;
+ZulValue SubscriptAST::const_eval(ConstEvaluator &evaluator) {
+    auto target_val = evaluator.eval(*target);
+    auto index_val = evaluator.eval(*index.value);
+    if (evaluator.failed())
+        return nullzul;
+    if (target_val.second < TYPE_COUNTS || target_val.second >= TYPE_COUNTS * 2) {
+        evaluator.fail("'[]' 연산자를 사용할 수 없습니다. 배열이 아닙니다.");
+        return nullzul;
+    }
+    if (index_val.second != id_int) {
+        evaluator.fail("배열의 인덱스는 정수여야 합니다");
+        return nullzul;
+    }
+    auto global_var = llvm::dyn_cast<llvm::GlobalVariable>(target_val.first);
+    if (!global_var || !global_var->hasInitializer()) {
+        evaluator.fail("컴파일 타임에 배열의 값을 알 수 없습니다");
+        return nullzul;
+    }
+    auto init = global_var->getInitializer();
+    auto arr_type = llvm::dyn_cast<llvm::ArrayType>(init->getType());
+    auto idx = static_cast<ConstantInt *>(index_val.first)->getSExtValue();
+    if (!arr_type || idx < 0 || idx >= static_cast<int64_t>(arr_type->getNumElements())) {
+        evaluator.fail("배열의 범위를 벗어났습니다");
+        return nullzul;
+    }
+    return {init->getAggregateElement(static_cast<unsigned>(idx)), target_val.second - TYPE_COUNTS};
 }
 
-FuncCallAST::FuncCallAST(FuncProtoAST &proto, vector<Capture<ASTPtr>> args)
-        : proto(proto), args(std::move(args)) {}
+bool SubscriptAST::is_readonly(ZulContext &zulctx) {
+    return target->is_readonly(zulctx);
+}
 
+Value *SubscriptAST::store(ZulContext &zulctx, Value *value) {
+    if (is_vector_type(target->get_typeid())) { //원소 하나를 바꾼 벡터를 변수에 다시 대입함
+        auto vector_val = target->code_gen(zulctx);
+        auto lane = get_lane_index(zulctx);
+        if (!vector_val.first || !lane)
+            return nullptr;
+        return target->store(zulctx, zulctx.builder.CreateInsertElement(vector_val.first, value, lane));
+    }
+    auto elm_ptr = get_origin_value(zulctx);
+    if (!elm_ptr.first)
+        return nullptr;
+    auto store = zulctx.builder.CreateStore(value, elm_ptr.first);
+    set_tbaa(store, elm_ptr.second);
+    return store;
+}
 
-std::string_view FuncCallAST::get_format_str(int type_id) {
-    if (format_str_map.contains(type_id))
-        return format_str_map[type_id];
-    return "%p";
+FuncCallAST::FuncCallAST(FuncProtoAST &proto, vector<Capture<ASTPtr>> args)
+        : proto(proto), args(std::move(args)) {
+    type_id = proto.return_type;
+    if (proto.name == STDIN_NAME) { //입력 함수에 변수의 주소를 넘겨야 함
+        for (auto &arg: this->args) {
+            if (arg.value->is_lvalue())
+                static_cast<LvalueAST *>(arg.value.get())->take_address();
+        }
+    }
 }
 
+
 ZulValue FuncCallAST::handle_std_in(ZulContext &zulctx) {
-    vector<llvm::Value *> arg_values;
-    string format_str;
-    auto s = args.size();
+    //인자마다 타입에 맞는 런타임 입력 함수를 호출함. 두 번째 인자부터의 글자는 scanf의 " %c"처럼 공백을 건너뜀
+    llvm::Value *ret = zulctx.builder.getInt32(0);
     bool has_error = false;
-    arg_values.reserve(args.size());
-    format_str.reserve(s * 3);
-    for (int i = 0; i < s; i++) {
+    for (size_t i = 0; i < args.size(); i++) {
         if (!args[i].value->is_lvalue()) {
-            System::logger.log_error(args[i].loc, args[i].word_size, {"\"", STDIN_NAME, "\" 함수에는 좌측값만 올 수 있습니다"});
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, {"\"", STDIN_NAME, "\" 함수에는 좌측값만 올 수 있습니다"});
             has_error = true;
+            continue;
         }
-        auto arg = static_cast<LvalueAST *>(args[i].value.get())->get_origin_value(zulctx);
+        auto lvalue = static_cast<LvalueAST *>(args[i].value.get());
+        if (lvalue->is_readonly(zulctx)) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, "상수의 값은 바꿀 수 없습니다");
+            has_error = true;
+        }
+        if (is_vector_type(lvalue->get_typeid())) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, "벡터는 입력받을 수 없습니다. 원소를 하나씩 입력받으세요");
+            has_error = true;
+            continue;
+        }
+        //배열은 원소들이 있는 주소를 넘김
+        auto arg = lvalue->get_typeid() >= TYPE_COUNTS ? lvalue->code_gen(zulctx) : lvalue->get_origin_value(zulctx);
         if (!arg.first)
             return nullzul;
-
-        format_str.append(get_format_str(arg.second));
-        if (i < s - 1)
-            format_str.push_back(' ');
-        arg_values.push_back(arg.first);
+        if (has_error)
+            continue;
+        auto call = create_read(zulctx.builder, arg.second, arg.first, i > 0);
+        if (!call) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, "수, 실수, 글자, 논리 변수나 글자 배열만 입력받을 수 있습니다");
+            has_error = true;
+            continue;
+        }
+        ret = call;
     }
-    arg_values.insert(arg_values.begin(), zulctx.builder.CreateGlobalStringPtr(format_str));
     if (has_error)
         return nullzul;
-    return {zulctx.builder.CreateCall(zulctx.module->getFunction("scanf"), arg_values), -1};
+    return {ret, -1};
 }
 
 ZulValue FuncCallAST::handle_std_out(ZulContext &zulctx) {
-    vector<llvm::Value *> arg_values;
-    string format_str;
-    auto s = args.size();
+    //printf처럼 인자를 모두 계산한 뒤에 출력해야 인자 안에서 호출한 함수의 출력이 줄 중간에 끼지 않음
+    vector<ZulValue> arg_values;
     arg_values.reserve(args.size());
-    format_str.reserve(s * 3);
-    for (int i = 0; i < s; i++) {
+    for (size_t i = 0; i < args.size(); i++) {
         auto arg = args[i].value->code_gen(zulctx);
         if (!arg.first)
             return nullzul;
         if (arg.second == -1) {
-            System::logger.log_error(args[i].loc, args[i].word_size, "\"없음\" 타입을 출력할 수 없습니다");
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, "\"없음\" 타입을 출력할 수 없습니다");
+        }
+        arg_values.push_back(arg);
+    }
+    //값마다 타입에 맞는 런타임 출력 함수를 호출하고, 사이에 공백을, 끝에 줄바꿈을 넣음
+    for (size_t i = 0; i < arg_values.size(); i++) {
+        if (i > 0)
+            create_write(zulctx.builder, id_char, zulctx.builder.getInt8(' '));
+        auto [value, type] = arg_values[i];
+        if (is_vector_type(type)) { //벡터는 원소를 하나씩 출력함
+            for (unsigned lane = 0; lane < get_lane_count(type); ++lane) {
+                if (lane > 0)
+                    create_write(zulctx.builder, id_char, zulctx.builder.getInt8(' '));
+                create_write(zulctx.builder, get_lane_type(type), zulctx.builder.CreateExtractElement(value, lane));
+            }
+        } else if (type != -1) {
+            create_write(zulctx.builder, type, value);
+        }
+    }
+    auto module = zulctx.module.get();
+    return {zulctx.builder.CreateCall(module->getOrInsertFunction("zul_write_line", zulctx.builder.getVoidTy())), -1};
+}
+
+//누적합(배열, 개수). 배열의 앞에서부터 개수만큼을 그 위치까지의 합으로 바꿈. 크면 런타임이 스레드 풀에서 나눠 계산함
+ZulValue FuncCallAST::handle_prefix_sum(ZulContext &zulctx) {
+    auto array = args[0].value->code_gen(zulctx);
+    auto count = args[1].value->code_gen(zulctx);
+    if (!array.first || !count.first)
+        return nullzul;
+    if (array.second != id_int + TYPE_COUNTS && array.second != id_float + TYPE_COUNTS) {
+        zulctx.logger.log_error(args[0].loc, args[0].word_size, {"\"", PREFIX_SUM_NAME, "\" 함수는 수, 실수 배열에만 쓸 수 있습니다"});
+        return nullzul;
+    }
+    if (count.second != id_int && !create_cast(zulctx, count, id_int)) {
+        zulctx.logger.log_error(args[1].loc, args[1].word_size, "개수는 정수여야 합니다");
+        return nullzul;
+    }
+    return {create_prefix_sum(zulctx.builder, array.first, count.first, array.second == id_float + TYPE_COUNTS), -1};
+}
+
+bool FuncCallAST::is_region_func() const {
+    return is_region_func_name(proto.name);
+}
+
+//영역(), 영역비우기(영역), 영역해제(영역), 수배열(영역, 개수) 같은 영역 함수. 영역은 런타임의 영역 주소를 영역 타입으로 들고 다니고,
+//영역에 할당한 배열은 배열 매개변수처럼 크기를 모르는 배열이 되므로 함수에 넘기거나 리턴할 수 있음
+ZulValue FuncCallAST::handle_region(ZulContext &zulctx) {
+    auto &builder = zulctx.builder;
+    if (proto.name == REGION_NEW_NAME)
+        return {create_region_new(builder), id_region};
+    vector<Value *> arg_values;
+    for (size_t i = 0; i < args.size(); i++) {
+        auto arg = args[i].value->code_gen(zulctx);
+        if (!arg.first)
+            return nullzul;
+        if (i == 0 && arg.second != id_region) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size,
+                                    {"영역은 \"" REGION_NEW_NAME "\" 함수가 돌려준 값이어야 합니다. \"",
+                                     get_type_name(arg.second), "\" 타입은 영역으로 쓸 수 없습니다"});
+            return nullzul;
+        }
+        if (i > 0 && arg.second != id_int && !create_cast(zulctx, arg, id_int)) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, "개수는 정수여야 합니다");
+            return nullzul;
         }
-        format_str.append(get_format_str(arg.second));
-        if (i < s - 1)
-            format_str.push_back(' ');
         arg_values.push_back(arg.first);
     }
-    format_str.push_back('\n');
-    arg_values.insert(arg_values.begin(), zulctx.builder.CreateGlobalStringPtr(format_str));
-    return {zulctx.builder.CreateCall(zulctx.module->getFunction("printf"), arg_values), -1};
+    auto region = arg_values[0];
+    if (proto.name == REGION_RESET_NAME || proto.name == REGION_FREE_NAME)
+        return {create_region_release(builder, region, proto.name == REGION_FREE_NAME), -1};
+    auto elm_type = proto.return_type - TYPE_COUNTS;
+    auto elm_size = zulctx.module->getDataLayout().getTypeAllocSize(get_llvm_type(*zulctx.context, elm_type));
+    auto bytes = builder.CreateMul(arg_values[1], builder.getInt64(elm_size.getFixedValue()));
+    return {create_region_alloc(builder, region, bytes), proto.return_type};
 }
 
 ZulValue FuncCallAST::code_gen(ZulContext &zulctx) {
@@ -614,108 +1561,540 @@ ZulValue FuncCallAST::code_gen(ZulContext &zulctx) {
         return handle_std_in(zulctx);
     if (proto.name == STDOUT_NAME)
         return handle_std_out(zulctx);
-    auto target_func = zulctx.module->getFunction(proto.name);
+    if (proto.name == PREFIX_SUM_NAME)
+        return handle_prefix_sum(zulctx);
+    if (is_region_func())
+        return handle_region(zulctx);
+    if (!zulctx.session.watch && is_const() && !zulctx.logger.has_error()) {
+        //인자가 모두 상수인 순수 함수 호출은 컴파일 타임에 미리 계산함
+        ConstEvaluator evaluator{zulctx, false, FOLD_STEP_LIMIT};
+        auto folded = evaluator.eval(*this);
+        if (!evaluator.failed() && folded.first)
+            return folded;
+    }
     vector<llvm::Value *> arg_values;
+    if (!gen_args(zulctx, arg_values))
+        return nullzul;
+    return create_call(zulctx, arg_values);
+}
+
+bool FuncCallAST::gen_args(ZulContext &zulctx, vector<Value *> &arg_values) {
     bool has_error = false;
     arg_values.reserve(args.size());
-    for (int i = 0; i < args.size(); i++) {
+    for (size_t i = 0; i < args.size(); i++) {
         auto arg = args[i].value->code_gen(zulctx);
         if (!arg.first)
-            return nullzul;
+            return false;
         if (i < proto.params.size() && arg.second != proto.params[i].second &&
             !create_cast(zulctx, arg, proto.params[i].second)) {
             //arg와 param의 타입이 맞지 않으면 캐스팅 시도
-            System::logger.log_error(args[i].loc, args[i].word_size, {
-                    "인자의 타입 \"", get_type_name(arg.second), "\" 에서 매개변수의 타입 \"",
-                    get_type_name(proto.params[i].second), "\" 로 캐스팅 할 수 없습니다"});
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, {
+                   "인자의 타입 \"", get_type_name(arg.second), "\" 에서 매개변수의 타입 \"",
+                   get_type_name(proto.params[i].second), "\" 로 캐스팅 할 수 없습니다"});
             has_error = true;
         }
         arg_values.push_back(arg.first);
     }
-    if (has_error)
+    return !has_error;
+}
+
+ZulValue FuncCallAST::create_call(ZulContext &zulctx, const vector<Value *> &arg_values) {
+    auto target_func = zulctx.module->getFunction(proto.name);
+    if (!target_func) //병렬 코드 생성 시 다른 모듈에 정의된 함수
+        target_func = proto.code_gen(zulctx);
+    auto call = zulctx.builder.CreateCall(target_func, arg_values);
+    call->setAttributes(target_func->getAttributes());
+    return {call, proto.return_type};
+}
+
+ZulValue FuncCallAST::tail_code_gen(ZulContext &zulctx, const Capture<int> &ret) {
+    auto cur_func = zulctx.builder.GetInsertBlock()->getParent();
+    if (!zulctx.tail_entry || proto.is_var_arg || proto.name != cur_func->getName()) {
+        auto value = code_gen(zulctx);
+        auto call = llvm::dyn_cast_or_null<CallInst>(value.first);
+        //입, 출 함수처럼 다른 함수의 호출로 바뀌었거나 상수로 계산된 호출은 그대로 둠
+        if (!call || !call->getCalledFunction() || call->getCalledFunction()->getName() != proto.name ||
+            call->getFunctionType()->isVarArg() || points_to_stack(vector<Value *>(call->arg_begin(), call->arg_end())))
+            return value;
+        //타입과 호출 규약이 같으면 musttail로 스택이 늘지 않는 것을 보장하고, 아니면 최적화에서 점프로 바꿀 수 있게 표시만 함
+        bool must_tail = call->getFunctionType() == cur_func->getFunctionType() &&
+                         call->getCallingConv() == cur_func->getCallingConv();
+        call->setTailCallKind(must_tail ? CallInst::TCK_MustTail : CallInst::TCK_Tail);
+        zulctx.tail_calls.push_back({call, ret.loc, ret.word_size});
+        return value;
+    }
+    vector<Value *> arg_values;
+    if (!gen_args(zulctx, arg_values))
+        return nullzul;
+    if (points_to_stack(arg_values)) //다음 반복에서 같은 스택 배열을 다시 초기화하므로 반복문으로 바꿀 수 없음
+        return create_call(zulctx, arg_values);
+    //인자를 모두 계산한 뒤에 매개변수에 넣음
+    auto block = zulctx.builder.GetInsertBlock();
+    for (size_t i = 0; i < arg_values.size(); ++i) {
+        auto param_var = proto.param_vars[i];
+        if (!param_var)
+            continue;
+        if (param_var->address_taken)
+            zulctx.builder.CreateStore(arg_values[i], param_var->alloca);
+        else
+            zulctx.ssa.write_var(param_var, block, arg_values[i]);
+    }
+    for (auto [alloca_val, byte_size]: zulctx.scope_arrays) //스택 배열은 다음 반복에서 다시 만듦
+        zulctx.builder.CreateLifetimeEnd(alloca_val, zulctx.builder.getInt64(byte_size));
+    auto branch = zulctx.builder.CreateBr(zulctx.tail_entry);
+    zulctx.tail_jumps.push_back({branch, vector<llvm::WeakTrackingVH>(arg_values.begin(), arg_values.end())});
+    if (zulctx.session.report_tail_calls)
+        zulctx.logger.log_note(ret.loc, ret.word_size, {"\"", proto.name, "\" 함수의 꼬리 재귀를 반복문으로 바꿨습니다"});
+    return {nullptr, id_interrupt};
+}
+
+ZulValue FuncCallAST::const_eval(ConstEvaluator &evaluator) {
+    if (proto.name == STDIN_NAME || proto.name == STDOUT_NAME) {
+        evaluator.fail("입출력 함수는 컴파일 타임에 호출할 수 없습니다");
+        return nullzul;
+    }
+    if (proto.name == PREFIX_SUM_NAME) {
+        evaluator.fail("누적합 함수는 컴파일 타임에 호출할 수 없습니다");
+        return nullzul;
+    }
+    if (is_region_func()) {
+        evaluator.fail("영역 함수는 컴파일 타임에 호출할 수 없습니다");
+        return nullzul;
+    }
+    vector<ZulValue> arg_values;
+    arg_values.reserve(args.size());
+    for (size_t i = 0; i < args.size(); i++) {
+        auto arg = evaluator.eval(*args[i].value);
+        if (evaluator.failed())
+            return nullzul;
+        if (i < proto.params.size() && !evaluator.cast(arg, proto.params[i].second))
+            return nullzul;
+        arg_values.push_back(arg);
+    }
+    return evaluator.call(proto, std::move(arg_values));
+}
+
+bool FuncCallAST::is_const() {
+    if (!proto.body)
+        return false;
+    return llvm::all_of(args, [](auto &arg) { return arg.value->is_const(); });
+}
+
+VectorOpAST::VectorOpAST(Capture<string> name, int vector_type, vector<Capture<ASTPtr>> args) :
+        name(std::move(name)), args(std::move(args)) {
+    auto &op_name = this->name.value;
+    int first_type = this->args.empty() ? -1 : this->args[0].value->get_typeid();
+    if (is_vector_type(vector_type)) {
+        type_id = vector_type;
+    } else if (reduce_op_map.contains(op_name)) {
+        if (is_vector_type(first_type))
+            type_id = get_lane_type(first_type);
+    } else if (op_name == VECTOR_SHUFFLE_NAME && is_vector_type(first_type)) {
+        //두 번째 인자도 벡터면 두 벡터를 이어 붙인 것에서 원소를 고름
+        size_t sources = this->args.size() > 1 && is_vector_type(this->args[1].value->get_typeid()) ? 2 : 1;
+        type_id = get_vector_type(get_lane_type(first_type), static_cast<unsigned>(this->args.size() - sources));
+    }
+}
+
+bool VectorOpAST::is_vector_op(const string &name) {
+    return name == VECTOR_STORE_NAME || name == VECTOR_SHUFFLE_NAME || reduce_op_map.contains(name);
+}
+
+bool VectorOpAST::get_lane_access(ZulContext &zulctx, ZulValue array, ZulValue pos, ZulValue count, size_t count_idx,
+                                  unsigned lanes, Value *&elm_ptr, Value *&mask) {
+    if (array.second != id_int + TYPE_COUNTS && array.second != id_float + TYPE_COUNTS) {
+        zulctx.logger.log_error(args[0].loc, args[0].word_size, "벡터는 수, 실수 배열에서만 읽고 쓸 수 있습니다");
+        return false;
+    }
+    if (pos.second != id_int) {
+        zulctx.logger.log_error(args[1].loc, args[1].word_size, "배열의 인덱스는 정수여야 합니다");
+        return false;
+    }
+    auto &builder = zulctx.builder;
+    Value *access_cnt = builder.getInt64(lanes); //실제로 읽거나 쓰는 원소의 개수
+    mask = nullptr;
+    if (count.first) {
+        if (count.second != id_int) {
+            zulctx.logger.log_error(args[count_idx].loc, args[count_idx].word_size, "개수는 정수여야 합니다");
+            return false;
+        }
+        //배열 끝에 원소가 lanes개보다 적게 남았을 때 남은 원소만 읽고 쓰게 함
+        vector<Constant *> lane_ids;
+        for (unsigned lane = 0; lane < lanes; ++lane) {
+            lane_ids.push_back(builder.getInt64(lane));
+        }
+        mask = builder.CreateICmpSLT(llvm::ConstantVector::get(lane_ids), builder.CreateVectorSplat(lanes, count.first));
+        access_cnt = builder.CreateSelect(builder.CreateICmpSLT(count.first, access_cnt), count.first, access_cnt);
+    }
+    auto var = dynamic_cast<VariableAST *>(args[0].value.get());
+    if (zulctx.session.bounds_check && var) {
+        //접근하는 첫 원소와 마지막 원소를 확인함. 접근하는 원소가 없으면 항상 범위 안인 0번을 확인함
+        if (auto size = var->get_array_size(zulctx, array.first)) {
+            auto zero = builder.getInt64(0);
+            auto any = builder.CreateICmpSGT(access_cnt, zero);
+            auto last = builder.CreateAdd(pos.first, builder.CreateSub(access_cnt, builder.getInt64(1)));
+            create_bounds_check(zulctx, builder.CreateSelect(any, pos.first, zero), size, args[1].loc.first);
+            create_bounds_check(zulctx, builder.CreateSelect(any, last, zero), size, args[1].loc.first);
+        }
+    }
+    auto elm_type = get_llvm_type(*zulctx.context, array.second - TYPE_COUNTS);
+    elm_ptr = builder.CreateInBoundsGEP(elm_type, array.first, {pos.first});
+    return true;
+}
+
+//수4(값)은 값을 모든 원소에 넣고, 수4(배열, 위치[, 개수])는 배열의 위치부터 원소 개수만큼 읽음
+ZulValue VectorOpAST::handle_make(ZulContext &zulctx) {
+    if (args.empty() || args.size() > 3) {
+        zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 의 인자는 (값)이나 (배열, 위치[, 개수])여야 합니다"});
+        return nullzul;
+    }
+    if (args.size() == 1) {
+        auto value = args[0].value->code_gen(zulctx);
+        if (!value.first)
+            return nullzul;
+        if (value.second != type_id && !create_cast(zulctx, value, type_id)) {
+            zulctx.logger.log_error(args[0].loc, args[0].word_size,
+                                    {"\"", get_type_name(value.second), "\" 타입으로 \"", get_type_name(type_id),
+                                     "\" 벡터를 만들 수 없습니다"});
+            return nullzul;
+        }
+        return {value.first, type_id};
+    }
+    auto array = args[0].value->code_gen(zulctx);
+    auto pos = args[1].value->code_gen(zulctx);
+    auto count = args.size() > 2 ? args[2].value->code_gen(zulctx) : nullzul;
+    if (!array.first || !pos.first || (args.size() > 2 && !count.first))
+        return nullzul;
+    auto lanes = get_lane_count(type_id);
+    Value *elm_ptr, *mask;
+    if (!get_lane_access(zulctx, array, pos, count, 2, lanes, elm_ptr, mask))
         return nullzul;
-    return {zulctx.builder.CreateCall(target_func, arg_values), proto.return_type};
+    int elm_type = array.second - TYPE_COUNTS;
+    int load_type = get_vector_type(elm_type, lanes);
+    auto llvm_type = get_llvm_type(*zulctx.context, load_type);
+    //위치가 정해져 있지 않으므로 원소의 정렬만 보장됨
+    auto align = zulctx.module->getDataLayout().getABITypeAlign(get_llvm_type(*zulctx.context, elm_type));
+    llvm::Instruction *load;
+    if (mask) //마스크가 꺼진 원소는 0이 됨
+        load = zulctx.builder.CreateMaskedLoad(llvm_type, elm_ptr, align, mask, Constant::getNullValue(llvm_type));
+    else
+        load = zulctx.builder.CreateAlignedLoad(llvm_type, elm_ptr, align);
+    set_tbaa(load, elm_type); //같은 배열의 원소를 하나씩 읽고 쓰는 것과 겹칠 수 있음
+    ZulValue result{load, load_type};
+    if (load_type != type_id)
+        create_cast(zulctx, result, type_id);
+    return {result.first, type_id};
 }
 
-int FuncCallAST::get_typeid(ZulContext &zulctx) {
-    return proto.return_type;
+//벡터쓰기(배열, 위치, 벡터[, 개수]). 개수가 있으면 번호가 개수보다 작은 원소만 씀
+ZulValue VectorOpAST::handle_store(ZulContext &zulctx) {
+    if (args.size() != 3 && args.size() != 4) {
+        zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 의 인자는 (배열, 위치, 벡터[, 개수])여야 합니다"});
+        return nullzul;
+    }
+    if (auto var = dynamic_cast<VariableAST *>(args[0].value.get()); var && var->is_readonly(zulctx)) {
+        zulctx.logger.log_error(args[0].loc, args[0].word_size, "상수의 값은 바꿀 수 없습니다");
+        return nullzul;
+    }
+    auto array = args[0].value->code_gen(zulctx);
+    auto pos = args[1].value->code_gen(zulctx);
+    auto value = args[2].value->code_gen(zulctx);
+    auto count = args.size() > 3 ? args[3].value->code_gen(zulctx) : nullzul;
+    if (!array.first || !pos.first || !value.first || (args.size() > 3 && !count.first))
+        return nullzul;
+    if (!is_vector_type(value.second)) {
+        zulctx.logger.log_error(args[2].loc, args[2].word_size, {"\"", get_type_name(value.second), "\" 타입은 벡터가 아닙니다"});
+        return nullzul;
+    }
+    auto lanes = get_lane_count(value.second);
+    Value *elm_ptr, *mask;
+    if (!get_lane_access(zulctx, array, pos, count, 3, lanes, elm_ptr, mask))
+        return nullzul;
+    int elm_type = array.second - TYPE_COUNTS;
+    int store_type = get_vector_type(elm_type, lanes);
+    if (value.second != store_type)
+        create_cast(zulctx, value, store_type);
+    auto align = zulctx.module->getDataLayout().getABITypeAlign(get_llvm_type(*zulctx.context, elm_type));
+    llvm::Instruction *store;
+    if (mask)
+        store = zulctx.builder.CreateMaskedStore(value.first, elm_ptr, align, mask);
+    else
+        store = zulctx.builder.CreateAlignedStore(value.first, elm_ptr, align);
+    set_tbaa(store, elm_type);
+    return {store, -1};
+}
+
+//벡터섞기(벡터, 번호...)나 벡터섞기(벡터, 벡터, 번호...). 번호는 상수이고, 뒤 벡터의 원소는 앞 벡터의 원소 개수부터 셈
+ZulValue VectorOpAST::handle_shuffle(ZulContext &zulctx) {
+    if (args.size() < 2) {
+        zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 의 인자는 (벡터, [벡터,] 번호...)여야 합니다"});
+        return nullzul;
+    }
+    auto first = args[0].value->code_gen(zulctx);
+    if (!first.first)
+        return nullzul;
+    if (!is_vector_type(first.second)) {
+        zulctx.logger.log_error(args[0].loc, args[0].word_size, {"\"", get_type_name(first.second), "\" 타입은 벡터가 아닙니다"});
+        return nullzul;
+    }
+    size_t sources = 1;
+    Value *second = llvm::PoisonValue::get(first.first->getType());
+    if (is_vector_type(args[1].value->get_typeid())) {
+        auto second_val = args[1].value->code_gen(zulctx);
+        if (!second_val.first)
+            return nullzul;
+        if (second_val.second != first.second) {
+            zulctx.logger.log_error(args[1].loc, args[1].word_size, "섞을 두 벡터의 타입이 같아야 합니다");
+            return nullzul;
+        }
+        second = second_val.first;
+        sources = 2;
+    }
+    if (type_id == -1) {
+        zulctx.logger.log_error(name.loc, name.word_size, "섞어서 만드는 벡터의 원소는 4개나 8개여야 합니다");
+        return nullzul;
+    }
+    auto lane_limit = static_cast<long long>(get_lane_count(first.second) * sources);
+    vector<int> lane_ids;
+    for (size_t i = sources; i < args.size(); ++i) {
+        auto lane = args[i].value->code_gen(zulctx);
+        if (!lane.first)
+            return nullzul;
+        auto const_lane = llvm::dyn_cast<ConstantInt>(lane.first);
+        if (lane.second != id_int || !const_lane) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, "섞을 원소의 번호는 정수 상수여야 합니다");
+            return nullzul;
+        }
+        if (const_lane->getSExtValue() < 0 || const_lane->getSExtValue() >= lane_limit) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size, {"섞을 원소의 번호는 0부터 ", to_string(lane_limit - 1), "까지입니다"});
+            return nullzul;
+        }
+        lane_ids.push_back(static_cast<int>(const_lane->getSExtValue()));
+    }
+    return {zulctx.builder.CreateShuffleVector(first.first, second, lane_ids), type_id};
 }
 
-unordered_map<int, string_view> FuncCallAST::format_str_map = {
-        {id_bool,                   "%u"},
-        {id_char,                   "%c"},
-        {id_int,                    "%lld"},
-        {id_float,                  "%lf"},
-        {id_char + TYPE_COUNTS,     "%s"},
-        {id_char + TYPE_COUNTS * 2, "%s"},
+//벡터합, 벡터곱, 벡터최소, 벡터최대(벡터). 벡터의 원소를 모두 합친 값
+ZulValue VectorOpAST::handle_reduce(ZulContext &zulctx) {
+    if (args.size() != 1) {
+        zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 의 인자는 벡터 하나여야 합니다"});
+        return nullzul;
+    }
+    auto value = args[0].value->code_gen(zulctx);
+    if (!value.first)
+        return nullzul;
+    if (!is_vector_type(value.second)) {
+        zulctx.logger.log_error(args[0].loc, args[0].word_size, {"\"", get_type_name(value.second), "\" 타입은 벡터가 아닙니다"});
+        return nullzul;
+    }
+    return {create_vector_reduce(zulctx.builder, value.first, reduce_op_map.at(name.value), type_id == id_float), type_id};
+}
+
+ZulValue VectorOpAST::code_gen(ZulContext &zulctx) {
+    if (name.value == VECTOR_STORE_NAME)
+        return handle_store(zulctx);
+    if (name.value == VECTOR_SHUFFLE_NAME)
+        return handle_shuffle(zulctx);
+    if (reduce_op_map.contains(name.value))
+        return handle_reduce(zulctx);
+    return handle_make(zulctx);
+}
+
+const unordered_map<string, Token> VectorOpAST::reduce_op_map = {
+        {VECTOR_SUM_NAME,     tok_add},
+        {VECTOR_PRODUCT_NAME, tok_mul},
+        {VECTOR_MIN_NAME,     tok_lt},
+        {VECTOR_MAX_NAME,     tok_gt},
+};
+
+BuiltinCallAST::BuiltinCallAST(Capture<string> name, vector<Capture<ASTPtr>> args) :
+        name(std::move(name)), args(std::move(args)), builtin(builtin_map.at(this->name.value)) {
+    vector<int> arg_types;
+    for (auto &arg: this->args)
+        arg_types.push_back(arg.value->get_typeid());
+    type_id = get_calc_type(arg_types);
+}
+
+int BuiltinCallAST::get_calc_type(const vector<int> &arg_types) const {
+    int lane_type = id_bool;
+    unsigned lanes = 0; //벡터 인자의 원소 개수. 스칼라 인자는 벡터로 퍼뜨림
+    for (auto type: arg_types) {
+        if (!is_arithmetic_type(type))
+            return -1;
+        if (is_vector_type(type)) {
+            if (lanes && lanes != get_lane_count(type))
+                return -1;
+            lanes = get_lane_count(type);
+        }
+        lane_type = max(lane_type, get_lane_type(type));
+    }
+    if (builtin.float_id == llvm::Intrinsic::not_intrinsic) {
+        if (lane_type == id_float)
+            return -1;
+        lane_type = id_int;
+    } else if (builtin.int_id == llvm::Intrinsic::not_intrinsic) {
+        lane_type = id_float;
+    } else {
+        lane_type = max(lane_type, static_cast<int>(id_int));
+    }
+    return lanes ? get_vector_type(lane_type, lanes) : lane_type;
+}
+
+Value *BuiltinCallAST::create_intrinsic(ZulContext &zulctx, vector<Value *> values) const {
+    auto id = get_lane_type(type_id) == id_float ? builtin.float_id : builtin.int_id;
+    if (builtin.poison_flag && id == builtin.int_id) //0이나 최솟값에서도 정의된 결과를 돌려주게 함
+        values.push_back(zulctx.builder.getFalse());
+    //상수 평가 중에는 삽입 위치가 없으므로 CreateIntrinsic 대신 모듈에서 선언을 직접 가져옴
+    auto func = llvm::Intrinsic::getDeclaration(zulctx.module.get(), id, {get_llvm_type(*zulctx.context, type_id)});
+    return zulctx.builder.CreateCall(func, values);
+}
+
+ZulValue BuiltinCallAST::code_gen(ZulContext &zulctx) {
+    if (!zulctx.session.watch && is_const() && !zulctx.logger.has_error()) {
+        ConstEvaluator evaluator{zulctx, false, FOLD_STEP_LIMIT};
+        auto folded = evaluator.eval(*this);
+        if (!evaluator.failed() && folded.first)
+            return folded;
+    }
+    vector<ZulValue> arg_values;
+    for (auto &arg: args) {
+        auto value = arg.value->code_gen(zulctx);
+        if (!value.first)
+            return nullzul;
+        arg_values.push_back(value);
+    }
+    if (type_id == -1) {
+        if (builtin.float_id == llvm::Intrinsic::not_intrinsic)
+            zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 함수는 정수와 정수 벡터만 받습니다"});
+        else
+            zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 함수에 쓸 수 없는 타입의 인자입니다"});
+        return nullzul;
+    }
+    vector<Value *> values;
+    for (size_t i = 0; i < arg_values.size(); ++i) {
+        if (!create_cast(zulctx, arg_values[i], type_id)) {
+            zulctx.logger.log_error(args[i].loc, args[i].word_size,
+                                    {"\"", get_type_name(arg_values[i].second), "\" 에서 \"",
+                                     get_type_name(type_id), "\" 로 캐스팅 할 수 없습니다"});
+            return nullzul;
+        }
+        values.push_back(arg_values[i].first);
+    }
+    return {create_intrinsic(zulctx, std::move(values)), type_id};
+}
+
+ZulValue BuiltinCallAST::const_eval(ConstEvaluator &evaluator) {
+    vector<Value *> values;
+    for (auto &arg: args) {
+        auto value = evaluator.eval(*arg.value);
+        if (evaluator.failed())
+            return nullzul;
+        if (type_id == -1) {
+            evaluator.fail("\"" + name.value + "\" 함수에 쓸 수 없는 타입의 인자입니다");
+            return nullzul;
+        }
+        if (!evaluator.cast(value, type_id))
+            return nullzul;
+        values.push_back(value.first);
+    }
+    return evaluator.fold(create_intrinsic(evaluator.zulctx, std::move(values)), type_id);
+}
+
+bool BuiltinCallAST::is_const() {
+    return llvm::all_of(args, [](auto &arg) { return arg.value->is_const(); });
+}
+
+const unordered_map<string, BuiltinCallAST::Builtin> BuiltinCallAST::builtin_map = {
+        {"제곱근",   {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::sqrt,    1, false}},
+        {"거듭제곱", {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::pow,     2, false}},
+        {"지수",    {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::exp,     1, false}},
+        {"로그",    {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::log,     1, false}},
+        {"사인",    {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::sin,     1, false}},
+        {"코사인",   {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::cos,     1, false}},
+        {"내림",    {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::floor,   1, false}},
+        {"올림",    {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::ceil,    1, false}},
+        {"반올림",   {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::round,   1, false}},
+        {"곱더하기", {llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::fma,     3, false}},
+        {"절댓값",   {llvm::Intrinsic::abs,           llvm::Intrinsic::fabs,    1, true}},
+        {"최소",    {llvm::Intrinsic::smin,          llvm::Intrinsic::minnum,  2, false}},
+        {"최대",    {llvm::Intrinsic::smax,          llvm::Intrinsic::maxnum,  2, false}},
+        {"비트개수", {llvm::Intrinsic::ctpop,         llvm::Intrinsic::not_intrinsic, 1, false}},
+        {"앞0개수",  {llvm::Intrinsic::ctlz,          llvm::Intrinsic::not_intrinsic, 1, true}},
+        {"뒤0개수",  {llvm::Intrinsic::cttz,          llvm::Intrinsic::not_intrinsic, 1, true}},
 };
 
-ImmBoolAST::ImmBoolAST(bool val) : val(val) {}
+ImmBoolAST::ImmBoolAST(bool val) : val(val) {
+    type_id = id_bool;
+}
 
 ZulValue ImmBoolAST::code_gen(ZulContext &zulctx) {
     return {llvm::ConstantInt::get(*zulctx.context, llvm::APInt(1, val)), id_bool};
 }
 
+ZulValue ImmBoolAST::const_eval(ConstEvaluator &evaluator) {
+    return code_gen(evaluator.zulctx);
+}
+
 bool ImmBoolAST::is_const() {
     return true;
 }
 
-int ImmBoolAST::get_typeid(ZulContext &zulctx) {
-    return id_bool;
+ImmCharAST::ImmCharAST(char val) : val(val) {
+    type_id = id_char;
 }
 
-ImmCharAST::ImmCharAST(char val) : val(val) {}
-
 ZulValue ImmCharAST::code_gen(ZulContext &zulctx) {
     return {llvm::ConstantInt::get(*zulctx.context, llvm::APInt(8, val)), id_char};
 }
 
+ZulValue ImmCharAST::const_eval(ConstEvaluator &evaluator) {
+    return code_gen(evaluator.zulctx);
+}
+
 bool ImmCharAST::is_const() {
     return true;
 }
 
-int ImmCharAST::get_typeid(ZulContext &zulctx) {
-    return id_char;
+ImmIntAST::ImmIntAST(long long int val) : val(val) {
+    type_id = id_int;
 }
 
-ImmIntAST::ImmIntAST(long long int val) : val(val) {}
-
 ZulValue ImmIntAST::code_gen(ZulContext &zulctx) {
     return {llvm::ConstantInt::get(*zulctx.context, llvm::APInt(64, val, true)), id_int};
 }
 
+ZulValue ImmIntAST::const_eval(ConstEvaluator &evaluator) {
+    return code_gen(evaluator.zulctx);
+}
+
 bool ImmIntAST::is_const() {
     return true;
 }
 
-int ImmIntAST::get_typeid(ZulContext &zulctx) {
-    return id_int;
+ImmRealAST::ImmRealAST(double val) : val(val) {
+    type_id = id_float;
 }
 
-ImmRealAST::ImmRealAST(double val) : val(val) {}
-
 ZulValue ImmRealAST::code_gen(ZulContext &zulctx) {
     return {llvm::ConstantFP::get(*zulctx.context, llvm::APFloat(val)), id_float};
 }
 
+ZulValue ImmRealAST::const_eval(ConstEvaluator &evaluator) {
+    return code_gen(evaluator.zulctx);
+}
+
 bool ImmRealAST::is_const() {
     return true;
 }
 
-int ImmRealAST::get_typeid(ZulContext &zulctx) {
-    return id_float;
+ImmStrAST::ImmStrAST(string val) : val(std::move(val)) {
+    type_id = id_char + TYPE_COUNTS;
 }
 
-ImmStrAST::ImmStrAST(string val) : val(std::move(val)) {}
-
 ZulValue ImmStrAST::code_gen(ZulContext &zulctx) {
-    return {zulctx.builder.CreateGlobalString(val, "", 0, zulctx.module.get()), id_char + TYPE_COUNTS};
+    return {zulctx.const_pool.get_string(*zulctx.module, val), id_char + TYPE_COUNTS};
 }
 
 bool ImmStrAST::is_const() {
     return true;
 }
-
-int ImmStrAST::get_typeid(ZulContext &zulctx) {
-    return id_char + TYPE_COUNTS;
-}
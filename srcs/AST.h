@@ -20,31 +20,50 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
 
-#include "System.h"
 #include "Utility.h"
 #include "Lexer.h"
 #include "ZulContext.h"
 
+#define LOOP_HINT_LOC "zul.loop.hint.loc" //llvm.loop 메타데이터에 넣는 힌트의 소스 위치 (줄, 칸, 길이)
+
+struct ConstEvaluator;
+
 struct ExprAST {
+    int type_id = -1; //AST를 만들 때 한 번 정해지는 식의 타입
+
     virtual ~ExprAST() = default;
 
     virtual ZulValue code_gen(ZulContext &zulctx) = 0;
 
+    virtual ZulValue const_eval(ConstEvaluator &evaluator);
+
     virtual bool is_const();
 
     virtual bool is_lvalue();
 
-    virtual int get_typeid(ZulContext &zulctx);
+    [[nodiscard]] int get_typeid() const;
 };
 
 struct LvalueAST : ExprAST {
     virtual ZulValue get_origin_value(ZulContext &zulctx) = 0;
 
+    virtual ZulValue *const_ref(ConstEvaluator &evaluator);
+
+    //상수 전역 변수나 그 원소라서 값을 바꿀 수 없는지
+    virtual bool is_readonly(ZulContext &zulctx) = 0;
+
+    //값을 대입하고, 생성된 store 명령어나 대입된 값을 반환함
+    virtual llvm::Value *store(ZulContext &zulctx, llvm::Value *value) = 0;
+
+    //주소가 필요한 곳에 쓰였음을 표시함. 지역 변수면 SSA 값 대신 alloca로 만들어짐
+    virtual void take_address();
+
     bool is_lvalue() override;
 };
 
@@ -54,6 +73,8 @@ struct FuncProtoAST {
     bool has_body;
     bool is_var_arg;
     std::vector<std::pair<std::string, int>> params;
+    std::vector<LocalVar *> param_vars; //정의된 함수의 매개변수 심볼
+    const std::vector<ASTPtr> *body = nullptr; //정의된 함수의 몸체 (컴파일 타임 계산용)
 
     FuncProtoAST() = default;
 
@@ -71,7 +92,7 @@ struct FuncRetAST : public ExprAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 };
 
 struct IfAST : public ExprAST {
@@ -82,6 +103,32 @@ struct IfAST : public ExprAST {
     IfAST(CondBodyPair if_pair, std::vector<CondBodyPair> elif_pair_list, std::vector<ASTPtr> else_body);
 
     ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+};
+
+//병렬 ㄱㄱ문의 누적 변수. 스레드마다 따로 누적한 값을 반복문이 끝날 때 바깥 변수에 합침
+struct Reduction {
+    Token op; //+, *, &, |, ^. 최소는 <, 최대는 >로 나타냄
+    LocalVar *var;
+    std::pair<int, int> loc; //연산자의 위치
+    unsigned word_size;
+};
+
+//ㄱㄱ문의 콜론 뒤에 적는 최적화 힌트. -1은 지정하지 않은 것
+struct LoopHints {
+    int unroll = -1; //펼칠 횟수. 0이면 횟수는 최적화에 맡기고, 1이면 펼치지 않음
+    int vector_width = -1; //벡터 너비. 0이면 너비는 최적화에 맡기고, 1이면 벡터화하지 않음
+    int interleave = -1; //한 번에 실행할 반복 횟수
+    bool distribute = false; //몸체를 여러 반복문으로 나눠서 나눈 부분을 따로 벡터화할 수 있게 함
+    bool parallel = false; //몸체를 여러 스레드에서 나눠서 실행함. 메타데이터가 아니라 ParallelLoopAST로 만들어짐
+    std::vector<Reduction> reductions; //병렬 ㄱㄱ문의 누적 변수
+    std::pair<int, int> loc; //힌트가 적용되지 않았을 때 알릴 위치
+    unsigned word_size = 0;
+
+    [[nodiscard]] bool empty() const {
+        return unroll == -1 && vector_width == -1 && interleave == -1 && !distribute;
+    }
 };
 
 struct LoopAST : public ExprAST {
@@ -89,44 +136,110 @@ struct LoopAST : public ExprAST {
     ASTPtr test_body;
     ASTPtr update_body;
     std::vector<ASTPtr> loop_body;
+    LoopHints hints;
+
+    LoopAST(ASTPtr init_body, ASTPtr test_body, ASTPtr update_body, std::vector<ASTPtr> loop_body, LoopHints hints);
+
+    ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+};
+
+//ㄱㄱ i = 시작; i < 끝; i += 증가량: 병렬
+//몸체는 (컨텍스트, 시작 번호, 끝 번호)를 받는 함수로 만들어지고, 런타임의 스레드 풀이 반복 번호의 범위를 나눠서 호출함
+//시작, 끝, 증가량은 들어가기 전에 한 번만 계산하고, 몸체가 사용하는 바깥 지역 변수는 컨텍스트 구조체에 복사해서 넘김
+struct ParallelLoopAST : public ExprAST {
+    LocalVar *index_var;
+    Capture<ASTPtr> start;
+    Capture<ASTPtr> bound;
+    bool inclusive; //i <= 끝
+    Capture<ASTPtr> step;
+    std::vector<ASTPtr> loop_body;
+    std::vector<LocalVar *> captures;
+    LoopHints hints; //몸체 함수 안의 반복문에 붙임
 
-    LoopAST(ASTPtr init_body, ASTPtr test_body, ASTPtr update_body, std::vector<ASTPtr> loop_body);
+    ParallelLoopAST(LocalVar *index_var, Capture<ASTPtr> start, Capture<ASTPtr> bound, bool inclusive,
+                    Capture<ASTPtr> step, std::vector<ASTPtr> loop_body, std::vector<LocalVar *> captures,
+                    LoopHints hints);
 
     ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+
+private:
+    llvm::Function *create_body_func(ZulContext &zulctx, llvm::StructType *ctx_type, llvm::StructType *partial_type,
+                                     int64_t step_value);
+
+    llvm::Function *create_combine_func(ZulContext &zulctx, llvm::StructType *partial_type);
 };
 
 struct ContinueAST : public ExprAST {
     ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 };
 
 struct BreakAST : public ExprAST {
     ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 };
 
 struct VariableAST : public LvalueAST {
     std::string name;
+    LocalVar *local = nullptr; //전역 변수면 nullptr
 
-    explicit VariableAST(std::string name);
+    VariableAST(std::string name, const SymbolTable &symbols);
 
     ZulValue get_origin_value(ZulContext &zulctx) override;
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+
+    ZulValue *const_ref(ConstEvaluator &evaluator) override;
+
+    bool is_readonly(ZulContext &zulctx) override;
+
+    llvm::Value *store(ZulContext &zulctx, llvm::Value *value) override;
+
+    void take_address() override;
+
+    //--bounds-check에서 쓰는 배열의 원소 개수. 매개변수처럼 크기를 모르는 배열이면 nullptr
+    llvm::Value *get_array_size(ZulContext &zulctx, llvm::Value *array) const;
 };
 
 struct VariableDeclAST : public ExprAST {
     Capture<std::string> name;
     int type;
     ASTPtr body;
+    LocalVar *var = nullptr;
 
-    VariableDeclAST(Capture<std::string> name, ZulContext &zulctx, int type, ASTPtr body = nullptr);
+    VariableDeclAST(Capture<std::string> name, SymbolTable &symbols, int type, ASTPtr body = nullptr);
 
-    VariableDeclAST(Capture<std::string> name, ZulContext &zulctx, ASTPtr body);
+    VariableDeclAST(Capture<std::string> name, SymbolTable &symbols, ASTPtr body);
 
-    void register_var(ZulContext &zulctx);
+    void register_var(SymbolTable &symbols);
 
     ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+};
+
+//지역 배열 선언. 크기가 상수이고 작으면 스택에, 아니면 아레나에 만들어지고 변수에는 배열의 포인터가 저장됨
+struct ArrayDeclAST : public ExprAST {
+    Capture<std::string> name;
+    int elm_type; //-1이면 원소들의 타입으로 추론함
+    Capture<ASTPtr> size;
+    std::vector<Capture<ASTPtr>> elements;
+    LocalVar *var = nullptr;
+
+    ArrayDeclAST(Capture<std::string> name, SymbolTable &symbols, int elm_type, Capture<ASTPtr> size,
+                 std::vector<Capture<ASTPtr>> elements);
+
+    ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 };
 
 struct VariableAssnAST : public ExprAST {
@@ -137,6 +250,8 @@ struct VariableAssnAST : public ExprAST {
     VariableAssnAST(std::unique_ptr<LvalueAST> target, Capture<Token> op, ASTPtr body);
 
     ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 };
 
 struct BinOpAST : public ExprAST {
@@ -149,9 +264,9 @@ struct BinOpAST : public ExprAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    bool is_const() override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    bool is_const() override;
 };
 
 struct UnaryOpAST : public ExprAST {
@@ -162,9 +277,9 @@ struct UnaryOpAST : public ExprAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    bool is_const() override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    bool is_const() override;
 };
 
 struct SubscriptAST : public LvalueAST {
@@ -177,26 +292,108 @@ struct SubscriptAST : public LvalueAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+
+    bool is_readonly(ZulContext &zulctx) override;
+
+    llvm::Value *store(ZulContext &zulctx, llvm::Value *value) override;
+
+private:
+    //벡터 변수의 원소 번호. 상수면 범위를 확인하고, --bounds-check에서는 실행 중에 확인함
+    llvm::Value *get_lane_index(ZulContext &zulctx);
 };
 
 struct FuncCallAST : public ExprAST {
     FuncProtoAST &proto;
     std::vector<Capture<ASTPtr>> args;
 
-    static std::unordered_map<int, std::string_view> format_str_map;
-
     FuncCallAST(FuncProtoAST &proto, std::vector<Capture<ASTPtr>> args);
 
-    std::string_view get_format_str(int type_id);
-
     ZulValue handle_std_in(ZulContext &zulctx);
 
     ZulValue handle_std_out(ZulContext &zulctx);
 
+    ZulValue handle_prefix_sum(ZulContext &zulctx);
+
+    ZulValue handle_region(ZulContext &zulctx);
+
+    bool is_region_func() const;
+
+    ZulValue code_gen(ZulContext &zulctx) override;
+
+    //ㅈㅈ문에서 결과를 바로 반환하는 호출. 현재 함수 자신의 호출이면 인자를 매개변수에 넣고 함수의 처음으로 돌아간 뒤
+    //{nullptr, id_interrupt}를 반환하고, 다른 함수의 호출이면 호출을 꼬리 호출로 표시함. ret는 ㅈㅈ의 위치
+    ZulValue tail_code_gen(ZulContext &zulctx, const Capture<int> &ret);
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+
+    bool is_const() override;
+
+private:
+    //인자의 값을 만들고 매개변수의 타입으로 캐스팅함
+    bool gen_args(ZulContext &zulctx, std::vector<llvm::Value *> &arg_values);
+
+    ZulValue create_call(ZulContext &zulctx, const std::vector<llvm::Value *> &arg_values);
+};
+
+//벡터 타입 이름으로 부르는 생성 함수와 벡터 내장 함수. 인자의 타입에 따라 결과 타입이 정해지므로 FuncCallAST와 따로 처리함
+struct VectorOpAST : public ExprAST {
+    Capture<std::string> name;
+    std::vector<Capture<ASTPtr>> args;
+
+    static const std::unordered_map<std::string, Token> reduce_op_map; //수평 연산 함수의 연산자. 최소는 tok_lt, 최대는 tok_gt
+
+    //vector_type은 수4(...)처럼 벡터 타입 이름으로 부른 경우 그 타입, 내장 함수면 -1
+    VectorOpAST(Capture<std::string> name, int vector_type, std::vector<Capture<ASTPtr>> args);
+
+    static bool is_vector_op(const std::string &name);
+
+    ZulValue handle_make(ZulContext &zulctx);
+
+    ZulValue handle_store(ZulContext &zulctx);
+
+    ZulValue handle_shuffle(ZulContext &zulctx);
+
+    ZulValue handle_reduce(ZulContext &zulctx);
+
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+private:
+    //배열 array의 pos 번째 원소부터 lanes개에 접근하는 주소. array, pos, count는 args[0], args[1], args[count_idx]의 값이고,
+    //count가 있으면 번호가 count보다 작은 원소만 고르는 마스크도 만듦. count가 없으면 nullzul을 넘김
+    bool get_lane_access(ZulContext &zulctx, ZulValue array, ZulValue pos, ZulValue count, size_t count_idx,
+                         unsigned lanes, llvm::Value *&elm_ptr, llvm::Value *&mask);
+};
+
+//수학, 비트 연산 내장 함수. 인자 타입에 맞는 LLVM intrinsic 호출 하나로 내려가므로 명령어 하나로 컴파일되고 벡터화도 됨
+struct BuiltinCallAST : public ExprAST {
+    struct Builtin {
+        llvm::Intrinsic::ID int_id;   //정수 인자에 쓰는 intrinsic. 없으면 인자를 실수로 캐스팅함
+        llvm::Intrinsic::ID float_id; //실수 인자에 쓰는 intrinsic. 없으면 정수 인자만 받음
+        unsigned arg_count;
+        bool poison_flag;             //정수 intrinsic이 abs, ctlz, cttz처럼 결과를 poison으로 만들지 정하는 인자를 받는지
+    };
+
+    Capture<std::string> name;
+    std::vector<Capture<ASTPtr>> args;
+    const Builtin &builtin;
+
+    static const std::unordered_map<std::string, Builtin> builtin_map;
+
+    BuiltinCallAST(Capture<std::string> name, std::vector<Capture<ASTPtr>> args);
+
+    ZulValue code_gen(ZulContext &zulctx) override;
+
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
+
+    bool is_const() override;
+
+private:
+    //인자 타입들로 계산할 타입을 정함. 인자는 모두 이 타입으로 캐스팅되고 결과도 이 타입임. 쓸 수 없는 타입이면 -1
+    int get_calc_type(const std::vector<int> &arg_types) const;
+
+    //type_id로 캐스팅된 인자들로 intrinsic을 호출함
+    llvm::Value *create_intrinsic(ZulContext &zulctx, std::vector<llvm::Value *> values) const;
 };
 
 struct ImmBoolAST : public ExprAST {
@@ -206,9 +403,9 @@ struct ImmBoolAST : public ExprAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    bool is_const() override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    bool is_const() override;
 };
 
 struct ImmCharAST : public ExprAST {
@@ -218,9 +415,9 @@ struct ImmCharAST : public ExprAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    bool is_const() override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    bool is_const() override;
 };
 
 
@@ -231,9 +428,9 @@ struct ImmIntAST : public ExprAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    bool is_const() override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    bool is_const() override;
 };
 
 struct ImmRealAST : public ExprAST {
@@ -243,9 +440,9 @@ struct ImmRealAST : public ExprAST {
 
     ZulValue code_gen(ZulContext &zulctx) override;
 
-    bool is_const() override;
+    ZulValue const_eval(ConstEvaluator &evaluator) override;
 
-    int get_typeid(ZulContext &zulctx) override;
+    bool is_const() override;
 };
 
 struct ImmStrAST : public ExprAST {
@@ -256,8 +453,6 @@ struct ImmStrAST : public ExprAST {
     ZulValue code_gen(ZulContext &zulctx) override;
 
     bool is_const() override;
-
-    int get_typeid(ZulContext &zulctx) override;
 };
 
 #endif //ZULLANG_AST_H
@@ -0,0 +1,758 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/InstCombine/InstCombine.h"
+#include "llvm/Transforms/IPO/GlobalDCE.h"
+#include "llvm/Transforms/Scalar/LoopDistribute.h"
+#include "llvm/Transforms/Scalar/LoopUnrollPass.h"
+#include "llvm/Transforms/Scalar/SimplifyCFG.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/LCSSA.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/LoopSimplify.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+#include "llvm/Transforms/Vectorize/LoopVectorize.h"
+#include "llvm/Transforms/Vectorize/SLPVectorizer.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "CodeGen.h"
+
+using std::string;
+using std::string_view;
+using std::unique_ptr;
+using std::vector;
+using std::deque;
+using std::make_unique;
+
+using llvm::BranchInst;
+using llvm::ReturnInst;
+using llvm::isa;
+using llvm::Module;
+using llvm::LLVMContext;
+using llvm::BasicBlock;
+using llvm::Type;
+using llvm::ArrayType;
+using llvm::PointerType;
+using llvm::GlobalVariable;
+using llvm::GlobalValue;
+using llvm::CallInst;
+using llvm::ConstantInt;
+using llvm::ConstantFP;
+using llvm::Constant;
+using llvm::Value;
+using llvm::LoadInst;
+using llvm::OptimizationLevel;
+using llvm::PassBuilder;
+using llvm::orc::ThreadSafeModule;
+using llvm::orc::ThreadSafeContext;
+
+#define CHUNKS_PER_JOB 4 //스레드마다 나눠 줄 함수 묶음 수. 묶음이 잘수록 함수 크기 차이에 의한 쏠림이 줄어듦
+
+bool remove_all_pred(BasicBlock *bb) {
+    if (bb->isEntryBlock())
+        return false;
+    if (bb->hasNPredecessors(0)) {
+        llvm::DeleteDeadBlock(bb); //다른 블록의 phi에서도 이 블록을 지움
+        return true;
+    }
+    auto pred = bb->getSinglePredecessor();
+    if (!pred)
+        return false;
+    if (remove_all_pred(pred)) {
+        llvm::DeleteDeadBlock(bb);
+        return true;
+    }
+    return false;
+}
+
+//적용하지 못한 반복문 변환은 LLVM이 위치 없이 출력하는 대신 report_missed_loop_hints가 소스 위치와 함께 알림
+struct LoopHintDiagnosticHandler : llvm::DiagnosticHandler {
+    bool handleDiagnostics(const llvm::DiagnosticInfo &info) override {
+        if (info.getKind() == llvm::DK_OptimizationFailure)
+            return true;
+        //힌트로 강제한 변환이 실패한 이유는 -pass-remarks 없이도 항상 출력되므로 함께 막음
+        auto remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info);
+        return remark && remark->getPassName() == llvm::OptimizationRemarkAnalysis::AlwaysPrint;
+    }
+};
+
+void init_module(ZulContext &zulctx, const string &source_name, const string &target_triple) {
+    zulctx.module->setSourceFileName(source_name);
+    zulctx.module->setTargetTriple(target_triple);
+
+    auto i32ty = Type::getInt32Ty(*zulctx.context);
+    auto i8ptrty = PointerType::getUnqual(Type::getInt8Ty(*zulctx.context));
+    auto fty = llvm::FunctionType::get(i32ty, {i8ptrty}, true);
+
+    llvm::Function::Create(fty, llvm::Function::ExternalLinkage, "printf", *zulctx.module);
+    llvm::Function::Create(fty, llvm::Function::ExternalLinkage, "scanf", *zulctx.module);
+    zulctx.context->setDiagnosticHandler(std::make_unique<LoopHintDiagnosticHandler>());
+}
+
+//ㄱㄱ i = 초깃값; i < 상한; i += 증가량 꼴의 반복문에서, 몸체가 i를 바꾸지 않으면 몸체 안의 i는 항상 [0, 상한) 안에 있음
+//이를 이용해 몸체에서 i로 하는 인덱스 검사 중 컴파일 타임에 증명되는 것은 지우고,
+//반복문에 들어가기 전에 알 수 있는 값들로 증명되는 것은 진입 전에 한 번 계산한 조건으로 바꿈
+void optimize_loop_bounds_checks(ZulContext &zulctx, const CheckedLoop &loop) {
+    if (!loop.test_br->isConditional())
+        return;
+    auto header = loop.enter_br->getSuccessor(0);
+    auto func = header->getParent();
+    auto cmp = llvm::dyn_cast<llvm::ICmpInst>(loop.test_br->getCondition());
+    if (!cmp || (cmp->getPredicate() != llvm::CmpInst::ICMP_SLT && cmp->getPredicate() != llvm::CmpInst::ICMP_SLE))
+        return;
+    auto induction = llvm::dyn_cast<llvm::PHINode>(cmp->getOperand(0));
+    if (!induction || induction->getParent() != header)
+        return;
+    bool strict = cmp->getPredicate() == llvm::CmpInst::ICMP_SLT;
+    auto bound = cmp->getOperand(1);
+
+    //블록은 만들어진 순서대로 함수에 들어가므로, 조건 블록보다 앞에 있는 블록의 값은 반복문 밖에서 정해진 값임
+    auto before_loop = [&](Value *value) {
+        auto inst = llvm::dyn_cast<llvm::Instruction>(value);
+        if (!inst)
+            return true;
+        for (auto &block: *func) {
+            if (&block == header)
+                return false;
+            if (&block == inst->getParent())
+                return true;
+        }
+        return false;
+    };
+
+    //i는 0 이상에서 시작하고, 증가량은 i가 넘치지 않을 만큼 작은 0 이상의 수여야 함
+    const int64_t max_step = int64_t{1} << 62;
+    Value *init_check = nullptr; //반복문에 들어가기 전에 검사할 초깃값과 증가량
+    Value *step_check = nullptr;
+    for (unsigned i = 0; i < induction->getNumIncomingValues(); ++i) {
+        auto value = induction->getIncomingValue(i);
+        if (induction->getIncomingBlock(i) == loop.latch_br->getParent()) {
+            auto add = llvm::dyn_cast<llvm::BinaryOperator>(value);
+            if (!add || add->getOpcode() != llvm::Instruction::Add || add->getOperand(0) != induction)
+                return;
+            auto step = add->getOperand(1);
+            if (auto const_step = llvm::dyn_cast<ConstantInt>(step)) {
+                if (const_step->isNegative() || const_step->getSExtValue() >= max_step)
+                    return;
+            } else if (before_loop(step)) {
+                step_check = step;
+            } else {
+                return;
+            }
+        } else if (auto const_init = llvm::dyn_cast<ConstantInt>(value)) {
+            if (const_init->isNegative())
+                return;
+        } else if (before_loop(value)) {
+            init_check = value;
+        } else {
+            return;
+        }
+    }
+
+    auto proven = [&](Value *size) {
+        auto const_bound = llvm::dyn_cast<ConstantInt>(bound);
+        auto const_size = llvm::dyn_cast<ConstantInt>(size);
+        if (const_bound && const_size)
+            return strict ? const_bound->getSExtValue() <= const_size->getSExtValue()
+                          : const_bound->getSExtValue() < const_size->getSExtValue();
+        if (size == bound)
+            return strict;
+        //배열: 수[n + 1]과 i <= n 같은 경우
+        auto add = llvm::dyn_cast<llvm::BinaryOperator>(size);
+        if (add && add->getOpcode() == llvm::Instruction::Add && add->getOperand(0) == bound) {
+            auto offset = llvm::dyn_cast<ConstantInt>(add->getOperand(1));
+            return offset && offset->getSExtValue() >= (strict ? 0 : 1);
+        }
+        return false;
+    };
+
+    llvm::IRBuilder<> pre_builder(loop.enter_br);
+    Value *loop_cond = nullptr;
+    bool loop_cond_created = false;
+    auto get_loop_cond = [&]() { //검사를 하나라도 바꿀 때만 만듦
+        if (!loop_cond_created) {
+            loop_cond_created = true;
+            if (init_check)
+                loop_cond = pre_builder.CreateICmpSGE(init_check, pre_builder.getInt64(0));
+            if (step_check) {
+                auto step_cond = pre_builder.CreateICmpULT(step_check, pre_builder.getInt64(max_step));
+                loop_cond = loop_cond ? pre_builder.CreateAnd(loop_cond, step_cond) : step_cond;
+            }
+        }
+        return loop_cond;
+    };
+
+    for (auto i = loop.first_check; i < loop.last_check; ++i) {
+        auto &check = zulctx.bounds_checks[i];
+        if (!check.branch || check.index != induction)
+            continue;
+        Value *in_range;
+        if (proven(check.size)) {
+            in_range = get_loop_cond();
+        } else if (before_loop(bound) && before_loop(check.size)) {
+            Value *upper = strict ? pre_builder.CreateICmpSLE(bound, check.size)
+                                  : pre_builder.CreateICmpSLT(bound, check.size);
+            in_range = get_loop_cond() ? pre_builder.CreateAnd(loop_cond, upper) : upper;
+        } else {
+            continue;
+        }
+        auto branch = check.branch;
+        check.branch = nullptr;
+        if (!in_range) { //검사를 지우고, 에러 블록은 함수를 다 만든 뒤에 지움
+            auto cond = llvm::cast<llvm::Instruction>(branch->getCondition());
+            BranchInst::Create(branch->getSuccessor(0), branch);
+            branch->eraseFromParent();
+            if (cond->use_empty())
+                cond->eraseFromParent();
+        } else {
+            llvm::IRBuilder<> check_builder(branch);
+            branch->setCondition(check_builder.CreateOr(in_range, branch->getCondition()));
+        }
+    }
+}
+
+void create_func(ZulContext &zulctx, FuncDef &def) {
+    auto &proto = *def.proto;
+    auto llvm_func = zulctx.module->getFunction(proto.name);
+    if (!llvm_func)
+        llvm_func = proto.code_gen(zulctx);
+    zulctx.ret_count = def.ret_count;
+    auto entry_block = BasicBlock::Create(*zulctx.context, "entry", llvm_func);
+    zulctx.builder.SetInsertPoint(entry_block);
+    zulctx.ssa.reset();
+    zulctx.ssa.seal_block(entry_block);
+    zulctx.scope_arrays.clear();
+    zulctx.arena_allocs = 0;
+    zulctx.bounds_checks.clear();
+    zulctx.checked_loops.clear();
+    zulctx.outlined_funcs.clear();
+    zulctx.tail_entry = nullptr;
+    zulctx.tail_calls.clear();
+    zulctx.tail_jumps.clear();
+    zulctx.array_returns.clear();
+    llvm::IRBuilder<> entry_builder(entry_block, entry_block->begin());
+
+    if (zulctx.ret_count > 1) {
+        if (proto.return_type != -1)
+            zulctx.return_var = entry_builder.CreateAlloca(get_llvm_type(*zulctx.context, proto.return_type), nullptr,
+                                                           "ret");
+        zulctx.return_block = BasicBlock::Create(*zulctx.context, "func_ret");
+    }
+
+    int i = 0;
+    for (auto &arg: llvm_func->args()) {
+        auto param_var = proto.param_vars[i++];
+        if (!param_var) //이름 없는 매개변수는 사용될 일이 없음
+            continue;
+        arg.setName(param_var->name);
+        if (!param_var->address_taken) {
+            zulctx.ssa.write_var(param_var, entry_block, &arg);
+            continue;
+        }
+        auto alloca_val = entry_builder.CreateAlloca(arg.getType(), nullptr, param_var->name);
+        zulctx.builder.CreateStore(&arg, alloca_val);
+        param_var->alloca = alloca_val;
+    }
+    //꼬리 재귀는 매개변수를 바꾸고 여기로 돌아오는 반복문으로 만듦. 핫 리로드에서는 바뀐 함수를 다시 호출해야 하므로 그대로 둠
+    if (def.self_tail_calls > 0 && !zulctx.session.watch) {
+        zulctx.tail_entry = BasicBlock::Create(*zulctx.context, "tail_entry", llvm_func);
+        zulctx.builder.CreateBr(zulctx.tail_entry);
+        zulctx.builder.SetInsertPoint(zulctx.tail_entry);
+    }
+
+    for (auto &ast: def.body) {
+        auto code = ast->code_gen(zulctx).second;
+        if (code == id_interrupt)
+            break;
+    }
+    if (zulctx.tail_entry)
+        zulctx.ssa.seal_block(zulctx.tail_entry);
+    for (auto &ret: zulctx.array_returns) { //phi가 모두 채워진 뒤라야 반환하는 배열이 어디서 왔는지 끝까지 따라갈 수 있음
+        if (ret.value && points_to_arena({ret.value})) {
+            zulctx.logger.log_error(ret.loc, ret.word_size,
+                                    "크기가 변수이거나 큰 지역 배열은 함수가 끝나면 해제되므로 반환할 수 없습니다. 영역 함수로 할당한 배열을 반환해야 합니다");
+        }
+    }
+    for (auto &loop: zulctx.checked_loops) {
+        optimize_loop_bounds_checks(zulctx, loop);
+    }
+
+    auto cur_block = zulctx.builder.GetInsertBlock();
+    if (zulctx.ret_count == 0 || cur_block->empty() ||
+        (!isa<BranchInst>(cur_block->back()) && !isa<ReturnInst>(cur_block->back()))) {
+        if (proto.name == ENTRY_FN_NAME) {
+            if (zulctx.ret_count > 1)
+                zulctx.builder.CreateBr(zulctx.return_block);
+            else
+                zulctx.builder.CreateRet(ConstantInt::get(Type::getInt64Ty(*zulctx.context), 0, true));
+        } else if (proto.return_type == -1) {
+            zulctx.builder.CreateRetVoid();
+        } else if (!remove_all_pred(cur_block)) {
+            zulctx.logger.log_error(def.name_loc, proto.name.size(),
+                                    {"\"", proto.name, "\" 함수의 리턴 타입은 \"", get_type_name(proto.return_type),
+                                     "\" 입니다. ㅈㅈ구문이 필요합니다"});
+        }
+    }
+    if (zulctx.ret_count > 1) {
+        llvm_func->insert(llvm_func->end(), zulctx.return_block);
+        zulctx.builder.SetInsertPoint(zulctx.return_block);
+        if (proto.return_type == -1) {
+            zulctx.builder.CreateRetVoid();
+        } else {
+            auto ret = zulctx.builder.CreateLoad(zulctx.return_var->getAllocatedType(), zulctx.return_var);
+            zulctx.builder.CreateRet(ret);
+        }
+    }
+    if (zulctx.session.bounds_check) { //범위가 증명되어 지운 검사의 에러 블록
+        llvm::removeUnreachableBlocks(*llvm_func);
+        for (auto func: zulctx.outlined_funcs)
+            llvm::removeUnreachableBlocks(*func);
+    }
+    for (auto &tail: zulctx.tail_calls) {
+        //리턴할 때 아레나를 해제하면 호출 뒤에 해제 코드가 붙으므로 musttail을 보장할 수 없음
+        if (zulctx.arena_allocs > 0 && tail.call->isMustTailCall())
+            tail.call->setTailCallKind(CallInst::TCK_Tail);
+        if (zulctx.session.report_tail_calls) {
+            zulctx.logger.log_note(tail.loc, tail.word_size,
+                                   {"\"", tail.call->getCalledFunction()->getName(), "\" 함수의 호출을 ",
+                                    tail.call->isMustTailCall() ? "musttail" : "tail", "로 표시했습니다"});
+        }
+    }
+    if (zulctx.arena_allocs > 0) { //함수에서 아레나에 할당한 배열은 리턴할 때 모두 해제함
+        llvm::IRBuilder<> mark_builder(entry_block, entry_block->getFirstInsertionPt());
+        auto arena_mark = create_arena_mark(mark_builder);
+        for (auto &block: *llvm_func) {
+            if (auto ret = llvm::dyn_cast_or_null<ReturnInst>(block.getTerminator())) {
+                llvm::IRBuilder<> ret_builder(ret);
+                create_arena_release(ret_builder, arena_mark);
+            }
+        }
+        //꼬리 재귀를 바꾼 반복문도 반복마다 해제해야 메모리가 반복 횟수만큼 쌓이지 않음
+        for (auto &jump: zulctx.tail_jumps) {
+            vector<Value *> args;
+            for (auto &arg: jump.args) {
+                if (arg)
+                    args.push_back(arg);
+            }
+            if (points_to_arena(args)) //다음 반복에서 쓸 배열이므로 해제할 수 없음
+                continue;
+            llvm::IRBuilder<> jump_builder(jump.branch);
+            create_arena_release(jump_builder, arena_mark);
+        }
+    }
+    zulctx.ret_count = 0;
+}
+
+//분석 매니저는 스레드 간에 공유할 수 없으므로 모듈마다 새로 만듦
+struct Analyses {
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+
+    explicit Analyses(PassBuilder &pass_builder) {
+        pass_builder.registerModuleAnalyses(mam);
+        pass_builder.registerCGSCCAnalyses(cgam);
+        pass_builder.registerFunctionAnalyses(fam);
+        pass_builder.registerLoopAnalyses(lam);
+        pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
+    }
+};
+
+OptimizationLevel get_opt_level(unsigned opt_level) {
+    return opt_level == 1 ? OptimizationLevel::O1 :
+           opt_level == 2 ? OptimizationLevel::O2 : OptimizationLevel::O3;
+}
+
+//최적화가 벡터 레지스터의 크기 같은 타깃 정보를 알 수 있게 함. JIT으로 실행할 때는 호스트 CPU의 기능을 모두 사용하고,
+//파일로 내보낼 때는 다른 컴퓨터에서도 실행할 수 있게 기본 CPU를 가정함. 인터프리터는 벡터 명령을 실행하지 못하므로 nullptr
+unique_ptr<llvm::TargetMachine> create_target_machine(const Session &session) {
+    if (session.opt_interp || session.opt_auto)
+        return nullptr;
+    bool jit = !session.opt_compile && !session.opt_assembly && !session.opt_shared;
+    if (jit && session.target_triple == llvm::sys::getProcessTriple()) {
+        auto builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+        if (!builder) {
+            llvm::consumeError(builder.takeError());
+            return nullptr;
+        }
+        auto machine = builder->createTargetMachine();
+        if (!machine) {
+            llvm::consumeError(machine.takeError());
+            return nullptr;
+        }
+        return std::move(*machine);
+    }
+    string err;
+    auto target = llvm::TargetRegistry::lookupTarget(session.target_triple, err);
+    if (!target)
+        return nullptr;
+    return unique_ptr<llvm::TargetMachine>{target->createTargetMachine(session.target_triple, "generic", "",
+                                                                       llvm::TargetOptions{}, std::nullopt)};
+}
+
+llvm::PipelineTuningOptions get_tuning(unsigned opt_level, llvm::TargetMachine *machine) {
+    llvm::PipelineTuningOptions tuning;
+    tuning.LoopVectorization = machine && opt_level >= 2;
+    tuning.SLPVectorization = machine && opt_level >= 2;
+    return tuning;
+}
+
+//ㄱㄱ문의 힌트로 요청한 변환이 최적화 뒤에도 남아 있는 반복문을 경고로 알림. 인라인 등으로 복제된 반복문은 한 번만 알림
+void report_missed_loop_hints(Module &module, unsigned opt_level, Logger &logger) {
+    std::set<std::pair<std::pair<int, int>, string_view>> reported;
+    for (auto &func: module) {
+        if (func.isDeclaration())
+            continue;
+        llvm::DominatorTree dom_tree{func};
+        llvm::LoopInfo loop_info{dom_tree};
+        for (auto loop: loop_info.getLoopsInPreorder()) {
+            auto loc_md = llvm::findOptionMDForLoop(loop, LOOP_HINT_LOC);
+            if (!loc_md)
+                continue;
+            auto loc_value = [loc_md](unsigned idx) {
+                return static_cast<int>(llvm::mdconst::extract<ConstantInt>(loc_md->getOperand(idx))->getSExtValue());
+            };
+            std::pair<int, int> loc{loc_value(1), loc_value(2)};
+
+            vector<string_view> missed;
+            if (llvm::hasUnrollTransformation(loop) == llvm::TM_ForcedByUser)
+                missed.emplace_back("ㄱㄱ문을 펼치지 못했습니다");
+            auto vectorize = llvm::hasVectorizeTransformation(loop);
+            if (vectorize == llvm::TM_ForcedByUser)
+                missed.emplace_back("ㄱㄱ문을 벡터화하지 못했습니다");
+            else if (vectorize == llvm::TM_Enable) //너비 없이 교차 횟수만 지정함
+                missed.emplace_back("ㄱㄱ문을 교차 실행하지 못했습니다");
+            if (llvm::hasDistributeTransformation(loop) == llvm::TM_ForcedByUser)
+                missed.emplace_back("ㄱㄱ문을 분배하지 못했습니다");
+            if (opt_level == 0 && !missed.empty())
+                missed = {"최적화하지 않으면 반복문 힌트를 적용하지 않습니다. -O1 이상으로 컴파일하세요"};
+
+            for (auto msg: missed) {
+                if (reported.emplace(loc, msg).second)
+                    logger.log_warning(loc, loc_value(3), msg);
+            }
+        }
+    }
+}
+
+void optimize_module(Module &module, unsigned opt_level, Session &session) {
+    if (opt_level == 0) {
+        if (!session.whole_program) //전체 프로그램 모드는 링크한 뒤에 최적화함
+            report_missed_loop_hints(module, opt_level, session.logger);
+        return;
+    }
+    auto machine = create_target_machine(session);
+    auto tuning = get_tuning(opt_level, machine.get());
+    PassBuilder pass_builder{machine.get(), tuning};
+    Analyses analyses{pass_builder};
+    auto fpm = pass_builder.buildFunctionSimplificationPipeline(get_opt_level(opt_level),
+                                                                llvm::ThinOrFullLTOPhase::None);
+    //함수 단위 파이프라인에는 반복문 분배, 벡터화, 부분 펼치기가 없으므로 모듈 파이프라인의 최적화 단계 중
+    //함수 안에서 끝나는 부분을 붙임. 분배와 -O1의 벡터화는 힌트가 붙은 반복문에만 적용됨
+    //분배는 반복문이 단순한 형태여야 하는데 함수 단위 파이프라인의 마지막 CFG 정리가 이를 깰 수 있음
+    fpm.addPass(llvm::LoopSimplifyPass{});
+    fpm.addPass(llvm::LCSSAPass{});
+    fpm.addPass(llvm::LoopDistributePass{});
+    if (machine) {
+        fpm.addPass(llvm::LoopVectorizePass{llvm::LoopVectorizeOptions{!tuning.LoopInterleaving,
+                                                                        !tuning.LoopVectorization}});
+        fpm.addPass(llvm::InstCombinePass{});
+        if (tuning.SLPVectorization)
+            fpm.addPass(llvm::SLPVectorizerPass{});
+        fpm.addPass(llvm::SimplifyCFGPass{});
+        fpm.addPass(llvm::InstCombinePass{});
+    }
+    fpm.addPass(llvm::LoopUnrollPass{llvm::LoopUnrollOptions{static_cast<int>(opt_level), !tuning.LoopUnrolling,
+                                                             tuning.ForgetAllSCEVInLoopUnroll}});
+    for (auto &func: module) {
+        if (!func.isDeclaration())
+            fpm.run(func, analyses.fam);
+    }
+    report_missed_loop_hints(module, opt_level, session.logger);
+}
+
+//func와 func이 호출하는 함수들이 직접 사용하는 전역 변수를 모두 모음
+void collect_used_globals(llvm::Function &func, llvm::SmallPtrSetImpl<llvm::Function *> &visited,
+                          llvm::SmallPtrSetImpl<const Value *> &globals) {
+    if (!visited.insert(&func).second)
+        return;
+    for (auto &inst: llvm::instructions(func)) {
+        for (auto &operand: inst.operands()) {
+            auto object = llvm::getUnderlyingObject(operand.get());
+            if (isa<GlobalVariable>(object))
+                globals.insert(object);
+        }
+        if (auto call = llvm::dyn_cast<CallInst>(&inst); call && call->getCalledFunction() &&
+                                                         !call->getCalledFunction()->isDeclaration())
+            collect_used_globals(*call->getCalledFunction(), visited, globals);
+    }
+}
+
+//배열 매개변수가 호출되는 동안 다른 포인터로는 접근되지 않는 메모리를 가리키는지 확인해서 noalias를 붙임
+//모든 호출에서 그 인자가 서로 다른 전역 배열, 지역 배열 중 하나이고, 전역 배열이면 호출된 함수 쪽에서 그 배열을 직접 쓰지 않아야 함
+//함수의 모든 호출을 알아야 하므로 내부 함수에만 적용함. 인라인되면 noalias는 원소 접근의 scoped noalias 메타데이터로 바뀜
+void infer_noalias_params(Module &module) {
+    for (auto &func: module) {
+        if (func.isDeclaration() || !func.hasLocalLinkage())
+            continue;
+        vector<llvm::Argument *> params;
+        for (auto &arg: func.args()) {
+            if (arg.getType()->isPointerTy() && !arg.hasNoAliasAttr())
+                params.push_back(&arg);
+        }
+        if (params.empty())
+            continue;
+        vector<CallInst *> calls;
+        bool all_calls = true;
+        for (auto user: func.users()) {
+            auto call = llvm::dyn_cast<CallInst>(user);
+            if (!call || call->getCalledFunction() != &func) {
+                all_calls = false;
+                break;
+            }
+            calls.push_back(call);
+        }
+        if (!all_calls)
+            continue;
+
+        llvm::SmallPtrSet<llvm::Function *, 16> visited;
+        llvm::SmallPtrSet<const Value *, 16> used_globals;
+        collect_used_globals(func, visited, used_globals);
+        for (auto param: params) {
+            bool no_alias = true;
+            for (auto call: calls) {
+                auto object = llvm::getUnderlyingObject(call->getArgOperand(param->getArgNo()));
+                if (isa<GlobalVariable>(object) ? used_globals.contains(object) :
+                    !isa<llvm::AllocaInst>(object) && !llvm::isNoAliasCall(object)) {
+                    no_alias = false;
+                    break;
+                }
+                for (auto &other: call->args()) {
+                    if (other.getOperandNo() == param->getArgNo() || !other->getType()->isPointerTy())
+                        continue;
+                    //phi 등을 거쳐 어떤 배열인지 모르는 인자는 같은 배열일 수도 있음
+                    llvm::SmallVector<const Value *, 4> other_objects;
+                    llvm::getUnderlyingObjects(other.get(), other_objects);
+                    for (auto other_object: other_objects) {
+                        if (other_object == object || !llvm::isIdentifiedObject(other_object))
+                            no_alias = false;
+                    }
+                }
+                if (!no_alias)
+                    break;
+            }
+            if (no_alias)
+                param->addAttr(llvm::Attribute::NoAlias);
+        }
+    }
+}
+
+void optimize_whole_program(Module &module, unsigned opt_level, Session &session,
+                            const std::set<string> &exports) {
+    for (auto &func: module) {
+        if (func.isDeclaration() || exports.contains(func.getName().str()))
+            continue;
+        func.setLinkage(GlobalValue::InternalLinkage);
+        //병렬 ㄱㄱ문의 몸체처럼 런타임에 주소를 넘기는 함수는 C 호출 규약을 유지해야 함
+        if (func.hasAddressTaken())
+            continue;
+        func.setCallingConv(llvm::CallingConv::Fast);
+        for (auto user: func.users()) {
+            if (auto call = llvm::dyn_cast<CallInst>(user); call && call->getCalledFunction() == &func)
+                call->setCallingConv(llvm::CallingConv::Fast);
+        }
+    }
+    //호출 규약이 달라진 함수 사이의 musttail은 보장할 수 없으므로 tail로 바꿈
+    for (auto &func: module) {
+        for (auto &inst: llvm::instructions(func)) {
+            if (auto call = llvm::dyn_cast<CallInst>(&inst); call && call->isMustTailCall() &&
+                                                              call->getCallingConv() != func.getCallingConv())
+                call->setTailCallKind(CallInst::TCK_Tail);
+        }
+    }
+    for (auto &global: module.globals()) {
+        if (!global.isDeclaration() && !global.hasLocalLinkage())
+            global.setLinkage(GlobalValue::InternalLinkage);
+    }
+
+    auto machine = opt_level ? create_target_machine(session) : nullptr;
+    PassBuilder pass_builder{machine.get(), get_tuning(opt_level, machine.get())};
+    Analyses analyses{pass_builder};
+    llvm::ModulePassManager mpm;
+    if (opt_level == 0) {
+        mpm.addPass(llvm::GlobalDCEPass()); //최적화하지 않아도 호출되지 않는 함수는 지움
+    } else {
+        infer_noalias_params(module);
+        mpm = pass_builder.buildPerModuleDefaultPipeline(get_opt_level(opt_level));
+    }
+    mpm.run(module, analyses.mam);
+    report_missed_loop_hints(module, opt_level, session.logger);
+}
+
+Type *remap_type(LLVMContext &context, Type *type) {
+    if (type->isArrayTy())
+        return ArrayType::get(remap_type(context, type->getArrayElementType()), type->getArrayNumElements());
+    if (type->isDoubleTy())
+        return Type::getDoubleTy(context);
+    if (type->isPointerTy())
+        return PointerType::getUnqual(context);
+    return Type::getIntNTy(context, type->getIntegerBitWidth());
+}
+
+Constant *remap_const(LLVMContext &context, Constant *value) {
+    if (auto const_int = llvm::dyn_cast<ConstantInt>(value))
+        return ConstantInt::get(context, const_int->getValue());
+    if (auto const_fp = llvm::dyn_cast<ConstantFP>(value))
+        return ConstantFP::get(context, const_fp->getValueAPF());
+    return nullptr;
+}
+
+//ptr이 가리키는 메모리를 읽기만 하는지. 배열 원소의 주소를 거쳐 읽는 것도 포함함
+bool is_read_only(Value *ptr) {
+    for (auto user: ptr->users()) {
+        if (auto load = llvm::dyn_cast<LoadInst>(user); load && load->getPointerOperand() == ptr)
+            continue;
+        if (auto gep = llvm::dyn_cast<llvm::GEPOperator>(user); gep && gep->getPointerOperand() == ptr &&
+                                                                is_read_only(gep))
+            continue;
+        return false;
+    }
+    return true;
+}
+
+//어느 함수에서도 값을 바꾸지 않는 전역 변수를 상수로 만듦. 값이 하나인 전역 변수는 읽는 곳에 초깃값을 바로 넣어서,
+//반복문 조건에 쓰인 배열 크기 같은 값을 최적화에서 알 수 있게 함
+void promote_read_only_globals(ZulContext &zulctx, const vector<Module *> &modules) {
+    for (auto &[name, global]: zulctx.global_var_map) {
+        auto [global_var, type_id] = global;
+        if (!global_var->hasInitializer())
+            continue;
+        auto var_name = global_var->getName();
+        bool read_only = true;
+        for (auto module: modules) {
+            if (auto var = module->getNamedGlobal(var_name); var && !is_read_only(var))
+                read_only = false;
+        }
+        if (!read_only)
+            continue;
+        for (auto module: modules) {
+            auto var = module->getNamedGlobal(var_name);
+            if (!var)
+                continue;
+            var->setConstant(true);
+            auto init = type_id < TYPE_COUNTS ? remap_const(module->getContext(), global_var->getInitializer()) : nullptr;
+            if (!init)
+                continue;
+            vector<LoadInst *> loads;
+            for (auto user: var->users()) {
+                if (auto load = llvm::dyn_cast<LoadInst>(user); load && load->getType() == init->getType())
+                    loads.push_back(load);
+            }
+            for (auto load: loads) {
+                load->replaceAllUsesWith(init);
+                load->eraseFromParent();
+            }
+        }
+    }
+}
+
+//묶음 하나의 함수들을 새 콘텍스트에서 생성함. 전역 변수는 선언만 하고, 다른 함수는 호출할 때 선언됨
+ThreadSafeModule generate_chunk(ZulContext &origin, deque<FuncDef> &func_defs, size_t begin, size_t end) {
+    ZulContext zulctx{origin.session};
+    init_module(zulctx, origin.module->getSourceFileName(), origin.module->getTargetTriple());
+    for (auto &[name, global]: origin.global_var_map) {
+        auto [global_var, type_id] = global;
+        auto decl = new GlobalVariable(*zulctx.module, remap_type(*zulctx.context, global_var->getValueType()),
+                                       global_var->isConstant(), GlobalVariable::ExternalLinkage, nullptr,
+                                       global_var->getName());
+        decl->setAlignment(global_var->getAlign());
+        zulctx.global_var_map.emplace(name, std::make_pair(decl, type_id));
+    }
+    for (auto i = begin; i < end; ++i) {
+        create_func(zulctx, func_defs[i]);
+    }
+    return {std::move(zulctx.module), std::move(zulctx.context)};
+}
+
+vector<ThreadSafeModule> generate_code(ZulContext &zulctx, deque<FuncDef> &func_defs, unsigned jobs,
+                                       unsigned opt_level) {
+    //최적화는 여러 스레드에서 타깃 정보를 사용하므로 먼저 등록해 둠
+    llvm::InitializeNativeTarget();
+    vector<ThreadSafeModule> modules;
+    if (jobs <= 1 || func_defs.size() <= 1) {
+        for (auto &def: func_defs) {
+            create_func(zulctx, def);
+        }
+        if (!zulctx.session.watch) //핫 리로드로 새로 들어오는 함수는 전역 변수를 바꿀 수 있음
+            promote_read_only_globals(zulctx, {zulctx.module.get()});
+        optimize_module(*zulctx.module, opt_level, zulctx.session);
+        modules.emplace_back(std::move(zulctx.module), std::move(zulctx.context));
+        return modules;
+    }
+
+    //묶음은 정의 순서대로 나누고 링크도 같은 순서로 하므로, 스레드 수와 상관 없이 함수 순서가 유지됨
+    auto chunk_cnt = std::min<size_t>(func_defs.size(), jobs * CHUNKS_PER_JOB);
+    vector<ThreadSafeModule> chunks(chunk_cnt);
+    parallel_for(chunk_cnt, jobs, [&](size_t idx) {
+        auto begin = func_defs.size() * idx / chunk_cnt;
+        auto end = func_defs.size() * (idx + 1) / chunk_cnt;
+        chunks[idx] = generate_chunk(zulctx, func_defs, begin, end);
+    });
+
+    //전역 변수를 바꾸는 함수가 어느 묶음에 있을지 모르므로 모든 묶음을 생성한 뒤에 한 번에 확인하고 최적화함
+    vector<Module *> all_modules{zulctx.module.get()};
+    for (auto &chunk: chunks) {
+        all_modules.push_back(chunk.getModuleUnlocked());
+    }
+    if (!zulctx.session.watch)
+        promote_read_only_globals(zulctx, all_modules);
+    parallel_for(chunk_cnt, jobs, [&](size_t idx) {
+        optimize_module(*all_modules[idx + 1], opt_level, zulctx.session);
+    });
+
+    modules.emplace_back(std::move(zulctx.module), std::move(zulctx.context));
+    for (auto &chunk: chunks) {
+        modules.push_back(std::move(chunk));
+    }
+    return modules;
+}
+
+bool link_modules(vector<ThreadSafeModule> &modules, Logger &logger) {
+    //서로 다른 LLVMContext의 모듈은 바로 링크할 수 없으므로 비트코드로 옮겨서 링크함
+    bool linked = modules.front().withModuleDo([&](Module &target) {
+        llvm::Linker linker(target);
+        for (size_t i = 1; i < modules.size(); ++i) {
+            llvm::SmallVector<char, 0> buffer;
+            modules[i].withModuleDo([&](Module &module) {
+                llvm::raw_svector_ostream os(buffer);
+                llvm::WriteBitcodeToFile(module, os);
+            });
+            auto parsed = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(buffer.data(), buffer.size()), ""),
+                                                 target.getContext());
+            if (!parsed || linker.linkInModule(std::move(parsed.get()))) {
+                llvm::consumeError(parsed.takeError());
+                logger.log_error({"병렬로 생성된 모듈을 링크하지 못했습니다"});
+                return false;
+            }
+        }
+        return true;
+    });
+    modules.resize(1);
+    return linked;
+}
@@ -0,0 +1,53 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_CODEGEN_H
+#define ZULLANG_CODEGEN_H
+
+#include <deque>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/IR/Module.h"
+
+#include "AST.h"
+#include "ZulContext.h"
+
+//파싱이 끝난 함수 정의. 코드 생성은 파일 전체를 파싱한 뒤에 함
+struct FuncDef {
+    FuncProtoAST *proto;
+    std::vector<ASTPtr> body;
+    std::pair<int, int> name_loc;
+    int ret_count; //몸체 안의 ㅈㅈ문 개수
+    int self_tail_calls; //몸체 안에서 자기 자신을 호출한 결과를 바로 반환하는 ㅈㅈ문 개수
+    std::deque<LocalVar> local_vars; //몸체의 AST들이 가리키는 지역 변수 심볼
+    std::string_view source; //함수 정의 전체의 소스. 핫 리로드에서 바뀐 함수를 찾을 때 사용
+};
+
+void init_module(ZulContext &zulctx, const std::string &source_name, const std::string &target_triple);
+
+void create_func(ZulContext &zulctx, FuncDef &def);
+
+//함수마다 최적화함. 인터프리터로 실행하지 않으면 세션의 타깃에 맞춰 반복문을 벡터화함 (-O2 이상)
+//힌트로 요청한 반복문 변환이 적용되지 않으면 세션의 로거에 경고를 남김
+void optimize_module(llvm::Module &module, unsigned opt_level, Session &session);
+
+//링크가 끝난 모듈 전체를 최적화함. exports에 없는 함수와 전역 변수는 내부 링크로 바꾸고 함수는 fastcc로 호출하므로,
+//인라인한 함수를 지우거나 상수를 함수 사이로 전파할 수 있음
+//내부 함수의 배열 매개변수는 모든 호출에서 서로 다른 배열을 받으면 noalias가 됨
+void optimize_whole_program(llvm::Module &module, unsigned opt_level, Session &session,
+                            const std::set<std::string> &exports);
+
+//함수들의 코드를 생성함. jobs가 1보다 크면 함수들을 묶음으로 나눠 각자의 LLVMContext에서 병렬로 생성하고,
+//첫 번째 모듈(전역 변수를 가진 원래 모듈) 뒤에 묶음마다 만들어진 모듈을 붙여서 반환함
+std::vector<llvm::orc::ThreadSafeModule> generate_code(ZulContext &zulctx, std::deque<FuncDef> &func_defs,
+                                                       unsigned jobs, unsigned opt_level);
+
+//병렬로 생성된 모듈들을 첫 번째 모듈에 링크함. 실패하면 logger에 에러를 남기고 false를 반환함
+bool link_modules(std::vector<llvm::orc::ThreadSafeModule> &modules, Logger &logger);
+
+#endif //ZULLANG_CODEGEN_H
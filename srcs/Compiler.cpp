@@ -0,0 +1,185 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "Compiler.h"
+
+using std::string;
+using std::string_view;
+using std::unique_ptr;
+using std::vector;
+using std::make_unique;
+
+using llvm::orc::ThreadSafeModule;
+
+#define MIN_PARALLEL_BODIES 16 //몸체가 이보다 적게 모이면 스레드를 만들지 않고 바로 파싱함
+
+Compiler::Compiler(Session &session) : session(session), zulctx(session) {
+    init_module(zulctx, session.source_name, session.target_triple);
+    //수학, 비트 내장 함수는 인자 타입에 따라 호출할 intrinsic이 정해지므로 이름만 등록함
+    for (auto &[name, builtin]: BuiltinCallAST::builtin_map)
+        func_proto_map.emplace(name, FuncProtoAST(name, -1, {}, false, true));
+    //영역은 런타임의 영역 주소를 담은 영역 타입으로 다루고, 영역 타입의 값은 영역()만 만들 수 있음
+    func_proto_map.emplace(REGION_NEW_NAME, FuncProtoAST(REGION_NEW_NAME, id_region, {}, false, false));
+    func_proto_map.emplace(REGION_RESET_NAME, FuncProtoAST(REGION_RESET_NAME, -1, {{"", id_region}}, false, false));
+    func_proto_map.emplace(REGION_FREE_NAME, FuncProtoAST(REGION_FREE_NAME, -1, {{"", id_region}}, false, false));
+    for (int type_id = 0; type_id < TYPE_COUNTS; ++type_id) {
+        if (type_id == id_region)
+            continue;
+        auto name = get_type_name(type_id) + REGION_ARRAY_SUFFIX;
+        func_proto_map.emplace(name, FuncProtoAST(name, type_id + TYPE_COUNTS, {{"", id_region}, {"", id_int}}, false, false));
+    }
+}
+
+vector<ThreadSafeModule> Compiler::compile() {
+    std::ifstream file(session.source_name, std::ios::binary);
+    if (!file.is_open()) {
+        session.logger.log_error({"\"", session.source_name, "\" 파일이 존재하지 않습니다."});
+        return {};
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return compile(ss.str());
+}
+
+vector<ThreadSafeModule> Compiler::compile(string source_text) {
+    if (!parse(std::move(source_text)))
+        return {};
+    auto modules = generate();
+    session.logger.flush(); //최적화에서 나온 경고
+    return modules;
+}
+
+bool Compiler::parse(string source_text) {
+    source = std::move(source_text);
+    split_units();
+
+    //모든 함수의 프로토타입을 먼저 등록함
+    vector<unique_ptr<Parser>> parsers;
+    vector<bool> has_body;
+    parsers.reserve(units.size());
+    for (auto &unit: units) {
+        auto &parser = parsers.emplace_back(make_unique<Parser>(unit.text, unit.first_line, zulctx, func_proto_map));
+        has_body.push_back(parser->parse_func_header());
+    }
+
+    //전역 변수는 앞의 함수 몸체를 컴파일 타임에 호출할 수 있으므로, 전역 변수를 만나면 모아둔 몸체를 먼저 파싱함
+    vector<unique_ptr<Parser>> pending;
+    for (size_t i = 0; i < parsers.size(); ++i) {
+        parsers[i]->check_param_names();
+        if (has_body[i]) {
+            pending.push_back(std::move(parsers[i]));
+            continue;
+        }
+        parse_bodies(pending);
+        parsers[i]->parse_top_level();
+        parsers[i].reset();
+    }
+    parse_bodies(pending);
+    session.logger.flush();
+
+    auto entry = func_proto_map.find(ENTRY_FN_NAME);
+    if (session.need_entry && (entry == func_proto_map.end() || !entry->second.has_body)) {
+        session.logger.log_error({"진입점이 정의되지 않았습니다. \"", ENTRY_FN_NAME, "\" 함수 정의가 필요합니다"});
+    }
+    return !session.logger.has_error();
+}
+
+vector<ThreadSafeModule> Compiler::generate() {
+    //파일 전체를 파싱한 뒤에 함수들의 코드를 생성함
+    if (!session.whole_program)
+        return generate_code(zulctx, func_defs, session.jobs, session.opt_level);
+
+    std::set<string> exports{session.exports.begin(), session.exports.end()};
+    for (auto &name: exports) {
+        auto proto = func_proto_map.find(name);
+        if (proto == func_proto_map.end() || !proto->second.has_body) {
+            session.logger.log_error({"--export로 지정한 \"", name, "\" 함수가 정의되지 않았습니다"});
+            return {};
+        }
+    }
+    if (session.need_entry)
+        exports.insert(ENTRY_FN_NAME);
+    if (session.opt_shared && session.exports.empty()) { //내보낼 함수를 정하지 않은 라이브러리는 모든 함수를 내보냄
+        for (auto &def: func_defs) {
+            exports.insert(def.proto->name);
+        }
+    }
+
+    //함수 단위 최적화는 링크한 뒤 모듈 단위 최적화에서 함께 함
+    auto modules = generate_code(zulctx, func_defs, session.jobs, 0);
+    if (!link_modules(modules, session.logger))
+        return {};
+    modules.front().withModuleDo([&](llvm::Module &module) {
+        optimize_whole_program(module, session.opt_level, session, exports);
+    });
+    return modules;
+}
+
+void Compiler::keep_funcs(const std::function<bool(const FuncDef &)> &pred) {
+    std::deque<FuncDef> kept;
+    for (auto &def: func_defs) {
+        if (!pred(def)) { //버린 함수는 컴파일 타임에 호출할 수 없음
+            def.proto->body = nullptr;
+            continue;
+        }
+        auto &added = kept.emplace_back(std::move(def));
+        added.proto->body = &added.body;
+    }
+    func_defs = std::move(kept);
+}
+
+const std::map<string, FuncProtoAST> &Compiler::get_func_protos() const {
+    return func_proto_map;
+}
+
+const GlobalVarMap &Compiler::get_global_vars() const {
+    return zulctx.global_var_map;
+}
+
+void Compiler::split_units() {
+    //들여쓰기 없이 시작하는 줄이 최상위 단위의 시작임. 빈 줄과 주석만 있는 줄은 앞 단위에 붙임
+    string_view text = source;
+    size_t unit_begin = 0;
+    int unit_line = 1;
+    bool has_code = false;
+    int line = 1;
+    for (size_t pos = 0; pos < text.size(); ++line) {
+        auto line_end = text.find('\n', pos);
+        line_end = line_end == string_view::npos ? text.size() : line_end + 1;
+        auto first = static_cast<unsigned char>(text[pos]);
+        bool is_blank = text.find_first_not_of(" \t\r\n", pos) >= line_end || text.substr(pos, 2) == "//";
+        if (!is_blank && !isspace(first)) {
+            if (has_code) {
+                units.push_back({text.substr(unit_begin, pos - unit_begin), unit_line});
+                unit_begin = pos;
+                unit_line = line;
+            }
+            has_code = true;
+        }
+        pos = line_end;
+    }
+    if (unit_begin < text.size())
+        units.push_back({text.substr(unit_begin), unit_line});
+}
+
+void Compiler::parse_bodies(vector<unique_ptr<Parser>> &pending) {
+    if (pending.empty())
+        return;
+    //몸체마다 심볼 테이블이 따로 있고, 프로토타입과 전역 변수는 읽기만 하므로 동시에 파싱할 수 있음
+    vector<unique_ptr<FuncDef>> results(pending.size());
+    unsigned jobs = pending.size() < MIN_PARALLEL_BODIES ? 1 : session.jobs;
+    parallel_for(pending.size(), jobs, [&](size_t idx) {
+        results[idx] = pending[idx]->parse_func_body();
+    });
+    for (auto &def: results) {
+        if (!def)
+            continue;
+        auto &added = func_defs.emplace_back(std::move(*def));
+        added.proto->body = &added.body;
+    }
+    pending.clear();
+}
@@ -0,0 +1,82 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_COMPILER_H
+#define ZULLANG_COMPILER_H
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+
+#include "ZulContext.h"
+#include "AST.h"
+#include "CodeGen.h"
+#include "Parser.h"
+
+//소스 파일 하나를 최상위 단위로 나눠서 파싱하고 코드를 생성함
+//1. 들여쓰기 없이 시작하는 줄마다 소스를 나눔
+//2. 모든 함수의 프로토타입을 먼저 파싱함. 그래서 함수는 전방 선언 없이도 뒤에 정의된 함수를 호출할 수 있음
+//3. 전역 변수는 소스 순서대로 파싱하고, 그 사이의 함수 몸체들은 여러 스레드에서 동시에 파싱함
+class Compiler {
+public:
+    explicit Compiler(Session &session);
+
+    std::vector<llvm::orc::ThreadSafeModule> compile();
+
+    std::vector<llvm::orc::ThreadSafeModule> compile(std::string source_text);
+
+    //파일 전체를 파싱함. 에러가 없으면 true를 반환함
+    bool parse(std::string source_text);
+
+    //파싱된 함수들의 코드를 생성함
+    std::vector<llvm::orc::ThreadSafeModule> generate();
+
+    //pred를 만족하는 함수만 코드를 생성하도록 나머지 함수 정의를 버림
+    void keep_funcs(const std::function<bool(const FuncDef &)> &pred);
+
+    [[nodiscard]] const std::map<std::string, FuncProtoAST> &get_func_protos() const;
+
+    [[nodiscard]] const GlobalVarMap &get_global_vars() const;
+
+private:
+    struct Unit {
+        std::string_view text;
+        int first_line;
+    };
+
+    Session &session;
+
+    std::string source;
+
+    std::vector<Unit> units;
+
+    ZulContext zulctx;
+
+    std::map<std::string, FuncProtoAST> func_proto_map = {
+            {STDIN_NAME, FuncProtoAST(STDIN_NAME, -1, {}, false, true)},
+            {STDOUT_NAME, FuncProtoAST(STDOUT_NAME, -1, {}, false, true)},
+            {PREFIX_SUM_NAME, FuncProtoAST(PREFIX_SUM_NAME, -1, {{"", id_int + TYPE_COUNTS}, {"", id_int}}, false, false)},
+            {VECTOR_STORE_NAME, FuncProtoAST(VECTOR_STORE_NAME, -1, {}, false, true)},
+            {VECTOR_SHUFFLE_NAME, FuncProtoAST(VECTOR_SHUFFLE_NAME, -1, {}, false, true)},
+            {VECTOR_SUM_NAME, FuncProtoAST(VECTOR_SUM_NAME, -1, {}, false, true)},
+            {VECTOR_PRODUCT_NAME, FuncProtoAST(VECTOR_PRODUCT_NAME, -1, {}, false, true)},
+            {VECTOR_MIN_NAME, FuncProtoAST(VECTOR_MIN_NAME, -1, {}, false, true)},
+            {VECTOR_MAX_NAME, FuncProtoAST(VECTOR_MAX_NAME, -1, {}, false, true)},
+            {"scanf", FuncProtoAST("scanf", id_int, {{"", id_char + TYPE_COUNTS}}, false, true)},
+            {"printf", FuncProtoAST("printf", id_int, {{"", id_char + TYPE_COUNTS}}, false, true)},
+    };
+
+    std::deque<FuncDef> func_defs; //정의된 함수들. 정의된 순서대로 코드가 생성됨
+
+    void split_units();
+
+    void parse_bodies(std::vector<std::unique_ptr<Parser>> &pending);
+};
+
+#endif //ZULLANG_COMPILER_H
@@ -0,0 +1,204 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "llvm/Analysis/ConstantFolding.h"
+
+#include "ConstEval.h"
+#include "AST.h"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using llvm::Value;
+using llvm::Constant;
+using llvm::UndefValue;
+using llvm::Instruction;
+using llvm::CallInst;
+
+#define MAX_CALL_DEPTH 512 //컴파일 타임 호출 깊이 제한
+
+ConstEvaluator::ConstEvaluator(ZulContext &zulctx, bool read_globals, long long step_limit) :
+        zulctx(zulctx), steps_left(step_limit), read_globals(read_globals), saved_ip(zulctx.builder.saveIP()) {
+    //폴딩에 실패한 연산이 실제 함수에 끼어들지 않도록 삽입 위치를 비워둠
+    zulctx.builder.ClearInsertionPoint();
+    frames.emplace_back();
+}
+
+ConstEvaluator::~ConstEvaluator() {
+    zulctx.builder.restoreIP(saved_ip);
+}
+
+ZulValue ConstEvaluator::eval(ExprAST &ast) {
+    if (failed() || !tick())
+        return nullzul;
+    auto result = ast.const_eval(*this);
+    if (failed())
+        return nullzul;
+    return result;
+}
+
+bool ConstEvaluator::eval_block(const vector<ASTPtr> &body) {
+    for (auto &ast: body) {
+        eval(*ast);
+        if (failed())
+            return false;
+        if (flow != flow_normal)
+            break;
+    }
+    return true;
+}
+
+ZulValue ConstEvaluator::call(FuncProtoAST &proto, vector<ZulValue> args) {
+    if (!proto.body && proto.has_body) { //전역 변수를 만나기 전에 파싱한 몸체만 있음
+        fail("\"" + proto.name + "\" 함수는 전역 변수보다 아래에 정의되어 있어 컴파일 타임에 호출할 수 없습니다. "
+             "전역 변수의 초기화에 쓰는 함수는 전역 변수보다 위에 정의해야 합니다");
+        return nullzul;
+    }
+    if (!proto.body) {
+        fail("\"" + proto.name + "\" 함수는 본문이 없어 컴파일 타임에 호출할 수 없습니다");
+        return nullzul;
+    }
+    //호출을 미리 계산할 때 가장 바깥 호출은 결과와 실패를 기억해 둠
+    //전역 변수 초기화는 상수가 아닌 전역 변수도 읽고, 안쪽 호출은 남은 계산 횟수에 따라 실패 여부가 달라지므로 기억하지 않음
+    if (read_globals || frames.size() > 1)
+        return call_body(proto, std::move(args));
+    FoldKey key{proto.name, {}};
+    for (auto &arg: args) {
+        auto constant = llvm::dyn_cast_or_null<Constant>(arg.first);
+        if (!constant)
+            return call_body(proto, std::move(args));
+        key.second.push_back(constant);
+    }
+    if (zulctx.unfoldable_funcs.contains(proto.name)) {
+        fail("\"" + proto.name + "\" 함수는 컴파일 타임 계산 횟수 제한을 초과한 적이 있어 미리 계산하지 않습니다");
+        return nullzul;
+    }
+    if (auto iter = zulctx.fold_cache.find(key); iter != zulctx.fold_cache.end()) {
+        if (!iter->second.fail_reason.empty())
+            fail(iter->second.fail_reason);
+        return iter->second.value;
+    }
+    auto result = call_body(proto, std::move(args));
+    if (steps_left < 0)
+        zulctx.unfoldable_funcs.insert(proto.name);
+    else
+        zulctx.fold_cache.emplace(std::move(key), FoldResult{result, fail_reason});
+    return result;
+}
+
+ZulValue ConstEvaluator::call_body(FuncProtoAST &proto, vector<ZulValue> args) {
+    if (frames.size() >= MAX_CALL_DEPTH) {
+        fail("컴파일 타임 호출 깊이 제한을 초과했습니다");
+        return nullzul;
+    }
+    frames.emplace_back();
+    for (size_t i = 0; i < proto.params.size(); ++i) {
+        frames.back()[proto.params[i].first] = args[i];
+    }
+    eval_block(*proto.body);
+    frames.pop_back();
+    if (failed())
+        return nullzul;
+
+    auto result = flow == flow_return ? ret_value : nullzul;
+    flow = flow_normal;
+    ret_value = nullzul;
+    if (proto.return_type != -1 && !result.first) {
+        fail("\"" + proto.name + "\" 함수가 값을 반환하지 않았습니다");
+        return nullzul;
+    }
+    return result;
+}
+
+ZulValue *ConstEvaluator::find_local(const string &name) {
+    auto &locals = frames.back();
+    auto iter = locals.find(name);
+    if (iter == locals.end())
+        return nullptr;
+    return &iter->second;
+}
+
+void ConstEvaluator::declare_local(const string &name, ZulValue value) {
+    frames.back()[name] = value;
+}
+
+bool ConstEvaluator::eval_cond(ExprAST &cond, bool &result) {
+    auto value = eval(cond);
+    if (failed())
+        return false;
+    if (!to_boolean_expr(zulctx, value)) {
+        fail("조건식을 \"논리\" 자료형으로 캐스팅 할 수 없습니다");
+        return false;
+    }
+    value = fold(value.first, id_bool);
+    if (failed())
+        return false;
+    result = !static_cast<Constant *>(value.first)->isNullValue();
+    return true;
+}
+
+ZulValue ConstEvaluator::read_global(const string &name) {
+    auto [global_var, type_id] = zulctx.global_var_map[name];
+    //상수는 런타임에도 초깃값 그대로이므로 함수 호출을 계산할 때도 읽을 수 있음. 병렬로 생성되는 모듈에서는 선언만 있음
+    if ((!read_globals && !global_var->isConstant()) || !global_var->hasInitializer()) {
+        fail("전역 변수 \"" + name + "\" 는 런타임에 바뀔 수 있어 컴파일 타임에 읽을 수 없습니다");
+        return nullzul;
+    }
+    if (type_id >= TYPE_COUNTS) //배열과 문자열은 주소를 그대로 사용
+        return {global_var, type_id};
+    return {global_var->getInitializer(), type_id};
+}
+
+ZulValue ConstEvaluator::fold(Value *value, int type_id) {
+    if (!value) {
+        fail("해당 연산을 컴파일 타임에 계산할 수 없습니다");
+        return nullzul;
+    }
+    if (auto call = llvm::dyn_cast<CallInst>(value)) {
+        //IRBuilder는 intrinsic 호출을 폴딩하지 않으므로 LLVM의 상수 폴딩을 직접 시도함
+        if (auto folded = llvm::ConstantFoldInstruction(call, zulctx.module->getDataLayout())) {
+            call->deleteValue();
+            value = folded;
+        }
+    }
+    if (!llvm::isa<Constant>(value)) {
+        //폴딩이 안 되면 삽입되지 않은 명령어가 만들어지므로 바로 지움
+        if (auto inst = llvm::dyn_cast<Instruction>(value))
+            inst->deleteValue();
+        fail("컴파일 타임에 계산할 수 없는 연산입니다");
+        return nullzul;
+    }
+    if (llvm::isa<UndefValue>(value)) {
+        fail("정의되지 않은 연산입니다. 0으로 나누거나 비트 수보다 크게 시프트하고 있습니다");
+        return nullzul;
+    }
+    return {value, type_id};
+}
+
+bool ConstEvaluator::cast(ZulValue &value, int type_id) {
+    if (value.second == type_id)
+        return true;
+    if (!create_cast(zulctx, value, type_id)) {
+        fail("\"" + get_type_name(value.second) + "\" 타입을 \"" + get_type_name(type_id) + "\" 타입으로 캐스팅 할 수 없습니다");
+        return false;
+    }
+    value = fold(value.first, type_id);
+    return !failed();
+}
+
+bool ConstEvaluator::tick() {
+    if (--steps_left >= 0)
+        return true;
+    fail("컴파일 타임 계산 횟수 제한을 초과했습니다. 무한 루프인지 확인하세요");
+    return false;
+}
+
+void ConstEvaluator::fail(string_view reason) {
+    if (fail_reason.empty())
+        fail_reason = reason;
+}
+
+bool ConstEvaluator::failed() const {
+    return !fail_reason.empty();
+}
@@ -0,0 +1,74 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_CONSTEVAL_H
+#define ZULLANG_CONSTEVAL_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+
+#include "ZulContext.h"
+
+struct FuncProtoAST;
+
+//AST를 컴파일 타임에 직접 계산하는 상수 평가기
+//연산은 IRBuilder의 상수 폴딩을 그대로 사용하므로 런타임 코드와 결과가 항상 같음
+struct ConstEvaluator {
+    enum Flow {
+        flow_normal,
+        flow_return,
+        flow_break,
+        flow_continue
+    };
+
+    ZulContext &zulctx;
+    Flow flow = flow_normal;
+    ZulValue ret_value{nullptr, -1};
+    std::string fail_reason;
+
+    ConstEvaluator(ZulContext &zulctx, bool read_globals, long long step_limit = 10'000'000);
+
+    ~ConstEvaluator();
+
+    ZulValue eval(ExprAST &ast);
+
+    bool eval_block(const std::vector<ASTPtr> &body);
+
+    ZulValue call(FuncProtoAST &proto, std::vector<ZulValue> args);
+
+    ZulValue *find_local(const std::string &name);
+
+    void declare_local(const std::string &name, ZulValue value);
+
+    bool eval_cond(ExprAST &cond, bool &result);
+
+    ZulValue read_global(const std::string &name);
+
+    ZulValue fold(llvm::Value *value, int type_id);
+
+    bool cast(ZulValue &value, int type_id);
+
+    bool tick();
+
+    void fail(std::string_view reason);
+
+    [[nodiscard]] bool failed() const;
+
+private:
+    ZulValue call_body(FuncProtoAST &proto, std::vector<ZulValue> args);
+
+    std::vector<std::unordered_map<std::string, ZulValue>> frames; //호출 스택 (함수마다 지역 변수 하나의 맵)
+
+    long long steps_left;
+
+    bool read_globals; //전역 변수의 초깃값을 읽을 수 있는지 (전역 변수 초기화 중에만 허용)
+
+    llvm::IRBuilderBase::InsertPoint saved_ip;
+};
+
+#endif //ZULLANG_CONSTEVAL_H
@@ -0,0 +1,222 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "HotReload.h"
+#include "Compiler.h"
+#include "RuntimeSymbols.h"
+
+using std::string;
+using std::vector;
+using std::pair;
+
+using llvm::Module;
+using llvm::JITSymbolFlags;
+using llvm::orc::LLJITBuilder;
+using llvm::orc::SymbolMap;
+using llvm::orc::absoluteSymbols;
+
+#define WATCH_INTERVAL_MS 200 //소스 파일의 수정 시간을 확인하는 간격
+
+//정의된 함수의 이름에 suffix를 붙이고, 함수 호출은 모두 원래 이름(스텁)으로 하게 바꿈
+//define_globals가 false면 전역 변수는 선언만 남겨서 처음 로드할 때 만든 전역 변수를 그대로 사용함
+void redirect_to_stubs(Module &module, const string &suffix, bool define_globals) {
+    vector<llvm::Function *> defined;
+    for (auto &func: module) {
+        if (!func.isDeclaration())
+            defined.push_back(&func);
+    }
+    for (auto func: defined) {
+        auto name = func->getName().str();
+        func->setName(name + suffix);
+        auto decl = llvm::Function::Create(func->getFunctionType(), llvm::Function::ExternalLinkage, name, module);
+        decl->setAttributes(func->getAttributes());
+        func->replaceAllUsesWith(decl);
+    }
+    if (define_globals)
+        return;
+    for (auto &global: module.globals()) {
+        if (global.hasExternalLinkage() && global.hasInitializer())
+            global.setInitializer(nullptr);
+    }
+}
+
+HotReloader::HotReloader(Session &session) : session(session) {}
+
+int HotReloader::run() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    ExitOnErr.setBanner(session.source_name + ": ");
+
+    jit = ExitOnErr(LLJITBuilder().create());
+    ExitOnErr(add_runtime_symbols(*jit));
+    stubs = llvm::orc::createLocalIndirectStubsManagerBuilder(jit->getTargetTriple())();
+
+    string source_text;
+    if (!read_source(source_text) || !load(source_text))
+        return 1;
+
+    std::thread watcher(&HotReloader::watch, this);
+    long long (*zul_main)() = ExitOnErr(jit->lookup(ENTRY_FN_NAME)).toPtr<long long()>();
+    zul_main();
+    running = false;
+    watcher.join();
+    return 0;
+}
+
+bool HotReloader::read_source(string &source_text) {
+    std::ifstream file(session.source_name, std::ios::binary);
+    if (!file.is_open()) {
+        session.logger.log_error({"\"", session.source_name, "\" 파일이 존재하지 않습니다."});
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    source_text = ss.str();
+    return true;
+}
+
+bool HotReloader::load(const string &source_text) {
+    bool initial = version == 0;
+    Session reload_session{session.source_name};
+    reload_session.opt_level = session.opt_level;
+    reload_session.jobs = session.jobs;
+    reload_session.bounds_check = session.bounds_check;
+    reload_session.watch = true;
+
+    Compiler compiler{reload_session};
+    if (!compiler.parse(source_text))
+        return false;
+
+    //이미 만들어진 전역 변수와 스텁은 타입을 바꿀 수 없음
+    //상수의 초깃값은 읽는 함수의 코드에 바로 들어가므로, 바뀌면 다시 컴파일하지 않은 함수는 이전 값을 계속 사용하게 됨
+    std::map<string, int> new_globals;
+    std::map<string, string> new_consts;
+    for (auto &[name, global]: compiler.get_global_vars()) {
+        new_globals.emplace(name, global.second);
+        if (global.first->isConstant() && global.first->hasInitializer()) {
+            llvm::raw_string_ostream os(new_consts[name]);
+            global.first->getInitializer()->print(os);
+        }
+    }
+    if (!initial && new_globals != globals) {
+        session.logger.log_error({"전역 변수 선언이 바뀌어 다시 로드할 수 없습니다. 프로그램을 다시 시작하세요"});
+        return false;
+    }
+    if (!initial && new_consts != consts) {
+        session.logger.log_error({"상수의 선언이나 값이 바뀌어 다시 로드할 수 없습니다. 프로그램을 다시 시작하세요"});
+        return false;
+    }
+    auto &protos = compiler.get_func_protos();
+    for (auto &[name, state]: funcs) {
+        auto iter = protos.find(name);
+        if (iter == protos.end() || !iter->second.has_body) //지워진 함수는 이전 코드를 계속 사용함
+            continue;
+        vector<int> param_types;
+        for (auto &param: iter->second.params) {
+            param_types.push_back(param.second);
+        }
+        if (iter->second.return_type != state.return_type || param_types != state.param_types) {
+            session.logger.log_error({"\"", name, "\" 함수의 프로토타입이 바뀌어 다시 로드할 수 없습니다. 프로그램을 다시 시작하세요"});
+            return false;
+        }
+    }
+
+    //소스가 바뀐 함수와 새로 정의된 함수만 코드를 생성함
+    vector<pair<string, FuncState>> changed;
+    compiler.keep_funcs([&](const FuncDef &def) {
+        auto &proto = *def.proto;
+        auto iter = funcs.find(proto.name);
+        if (iter != funcs.end() && iter->second.source == def.source)
+            return false;
+        auto &state = changed.emplace_back(proto.name, FuncState{string(def.source), proto.return_type, {}}).second;
+        for (auto &param: proto.params) {
+            state.param_types.push_back(param.second);
+        }
+        return true;
+    });
+    if (changed.empty())
+        return true;
+    auto modules = compiler.generate();
+    if (reload_session.logger.has_error())
+        return false;
+
+    if (auto err = add_modules(std::move(modules), changed, initial)) {
+        session.logger.log_error({"다시 컴파일한 코드를 JIT에 올리지 못했습니다. ", llvm::toString(std::move(err))});
+        return false;
+    }
+    if (initial) {
+        globals = std::move(new_globals);
+        consts = std::move(new_consts);
+    } else {
+        session.logger.log_note({"리로드: 함수 ", std::to_string(changed.size()), "개를 다시 컴파일했습니다"});
+    }
+    return true;
+}
+
+llvm::Error HotReloader::add_modules(vector<llvm::orc::ThreadSafeModule> modules,
+                                     vector<pair<string, FuncState>> &changed, bool initial) {
+    auto suffix = ".v" + std::to_string(++version);
+    for (auto &tsm: modules) {
+        tsm.withModuleDo([&](Module &module) {
+            redirect_to_stubs(module, suffix, initial);
+        });
+    }
+
+    //새 함수의 스텁은 모듈을 올리기 전에 만들어야 모듈의 호출이 스텁으로 연결됨
+    llvm::orc::IndirectStubsManager::StubInitsMap stub_inits;
+    for (auto &[name, state]: changed) {
+        if (!funcs.contains(name))
+            stub_inits[name] = {{}, JITSymbolFlags::Exported | JITSymbolFlags::Callable};
+    }
+    if (!stub_inits.empty()) {
+        if (auto err = stubs->createStubs(stub_inits))
+            return err;
+        SymbolMap stub_symbols;
+        for (auto &entry: stub_inits) {
+            stub_symbols[jit->mangleAndIntern(entry.getKey())] = stubs->findStub(entry.getKey(), true);
+        }
+        if (auto err = jit->getMainJITDylib().define(absoluteSymbols(std::move(stub_symbols))))
+            return err;
+    }
+
+    for (auto &tsm: modules) {
+        if (auto err = jit->addIRModule(std::move(tsm)))
+            return err;
+    }
+    //스텁의 주소는 포인터 하나라서, 실행 중인 코드는 이전 함수나 새 함수 중 하나를 온전히 호출하게 됨
+    //찾지 못한 함수가 있으면 그 함수부터는 스텁을 바꾸지 않으므로 이전 코드를 계속 사용함
+    for (auto &[name, state]: changed) {
+        auto impl = jit->lookup(name + suffix);
+        if (!impl)
+            return impl.takeError();
+        if (auto err = stubs->updatePointer(name, *impl))
+            return err;
+        funcs[name] = std::move(state);
+    }
+    return llvm::Error::success();
+}
+
+void HotReloader::watch() {
+    std::error_code ec;
+    auto last_write = std::filesystem::last_write_time(session.source_name, ec);
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_INTERVAL_MS));
+        auto cur_write = std::filesystem::last_write_time(session.source_name, ec);
+        if (ec || cur_write == last_write)
+            continue;
+        last_write = cur_write;
+        string source_text;
+        if (!read_source(source_text) || !load(source_text))
+            session.logger.log_note({"리로드에 실패했습니다. 이전 코드로 계속 실행합니다"});
+    }
+}
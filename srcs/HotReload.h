@@ -0,0 +1,66 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_HOTRELOAD_H
+#define ZULLANG_HOTRELOAD_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+
+#include "Session.h"
+
+//--watch 모드. 소스 파일이 바뀌면 바뀐 함수만 다시 컴파일해서 실행 중인 프로그램에 반영함
+//모든 줄랭 함수는 간접 호출 스텁을 거쳐서 호출되고, 함수를 다시 컴파일하면 스텁이 가리키는 주소만 바꿈
+//전역 변수는 처음 컴파일한 것을 계속 사용하므로 다시 로드해도 값이 유지됨
+class HotReloader {
+public:
+    explicit HotReloader(Session &session);
+
+    //처음 컴파일한 뒤 시작 함수를 실행하고, 실행되는 동안 다른 스레드에서 소스 파일을 감시함
+    int run();
+
+private:
+    struct FuncState {
+        std::string source; //함수 정의 전체의 소스
+        int return_type;
+        std::vector<int> param_types;
+    };
+
+    Session &session;
+
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+
+    std::unique_ptr<llvm::orc::IndirectStubsManager> stubs;
+
+    std::map<std::string, FuncState> funcs; //스텁이 만들어진 함수들
+
+    std::map<std::string, int> globals; //처음 컴파일할 때의 전역 변수 타입
+
+    std::map<std::string, std::string> consts; //처음 컴파일할 때의 상수 전역 변수와 초깃값을 출력한 문자열
+
+    unsigned version = 0; //다시 컴파일할 때마다 증가하고, 함수 구현 이름에 붙음
+
+    std::atomic<bool> running{true};
+
+    llvm::ExitOnError ExitOnErr;
+
+    bool read_source(std::string &source_text);
+
+    //소스를 컴파일해서 바뀐 함수를 반영함. 실패하면 에러를 출력하고 false를 반환하며, 실행 중인 코드는 그대로 둠
+    bool load(const std::string &source_text);
+
+    //다시 컴파일한 모듈들을 JIT에 올리고 바뀐 함수들의 스텁을 새 구현으로 바꿈
+    llvm::Error add_modules(std::vector<llvm::orc::ThreadSafeModule> modules,
+                            std::vector<std::pair<std::string, FuncState>> &changed, bool initial);
+
+    void watch();
+};
+
+#endif //ZULLANG_HOTRELOAD_H
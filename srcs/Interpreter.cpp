@@ -0,0 +1,1036 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/DynamicLibrary.h"
+
+#include "Interpreter.h"
+#include "RuntimeSymbols.h"
+#include "Utility.h"
+
+using std::string;
+using std::vector;
+using std::pair;
+using std::cerr;
+
+using llvm::Value;
+using llvm::Type;
+using llvm::Constant;
+using llvm::ConstantInt;
+using llvm::ConstantFP;
+using llvm::ConstantExpr;
+using llvm::BasicBlock;
+using llvm::Instruction;
+using llvm::AllocaInst;
+using llvm::LoadInst;
+using llvm::StoreInst;
+using llvm::ICmpInst;
+using llvm::FCmpInst;
+using llvm::CmpInst;
+using llvm::BranchInst;
+using llvm::SwitchInst;
+using llvm::CallInst;
+using llvm::PHINode;
+using llvm::GetElementPtrInst;
+using llvm::GlobalVariable;
+using llvm::isa;
+using llvm::dyn_cast;
+
+#define INTERP_STACK_SLOTS (1 << 24) //인터프리터 스택 크기(8바이트 단위). 실제로 사용한 만큼만 메모리가 잡힘
+
+#define FFI_INT_ARGS 6 //C 함수에 넘길 수 있는 정수, 포인터 인자 수
+
+#define FFI_FLOAT_ARGS 8 //C 함수에 넘길 수 있는 실수 인자 수
+
+//정수 인자와 실수 인자가 각각 정해진 레지스터로 넘어가는 플랫폼에서만 C 함수를 호출할 수 있음
+#if (defined(__x86_64__) || defined(__aarch64__)) && !defined(_WIN32) && !defined(__APPLE__)
+#define ZUL_INTERP_FFI
+#endif
+
+//GCC, Clang에서는 명령어마다 다음 명령어로 바로 점프하는 threaded dispatch를 사용함
+#if defined(__GNUC__)
+#define ZUL_INTERP_THREADED
+#endif
+
+#define ZUL_INTERP_OPS(X) \
+    X(mov) X(alloca) X(load8) X(load16) X(load32) X(load64) X(store8) X(store16) X(store32) X(store64) \
+    X(add) X(sub) X(mul) X(sdiv) X(srem) X(udiv) X(urem) X(shl) X(ashr) X(lshr) X(band) X(bor) X(bxor) \
+    X(sext) X(mask) X(neg) X(fadd) X(fsub) X(fmul) X(fdiv) X(frem) X(fneg) \
+    X(ieq) X(ine) X(islt) X(isle) X(isgt) X(isge) X(iult) X(iule) X(iugt) X(iuge) \
+    X(foeq) X(fone) X(folt) X(fole) X(fogt) X(foge) X(ford) \
+    X(fueq) X(fune) X(fult) X(fule) X(fugt) X(fuge) X(funo) \
+    X(sitofp) X(uitofp) X(fptosi) X(fptoui) X(select) X(gep) X(gep_index) \
+    X(smin) X(smax) X(abs) X(ctpop) X(ctlz) X(cttz) \
+    X(jmp) X(br) X(call) X(tail_call) X(call_c) X(ret) X(ret_void) X(unreachable)
+
+//레지스터에는 항상 정규화된 값이 들어감. 논리는 0 또는 1, 나머지 정수는 64비트로 부호 확장된 값, 실수는 double의 비트
+enum InterpOp : uint16_t {
+#define ZUL_INTERP_ENUM(name) op_##name,
+    ZUL_INTERP_OPS(ZUL_INTERP_ENUM)
+#undef ZUL_INTERP_ENUM
+};
+
+namespace {
+    template<typename T>
+    uint64_t load_as(uint64_t address) {
+        T value;
+        std::memcpy(&value, reinterpret_cast<const void *>(address), sizeof(T));
+        return static_cast<uint64_t>(static_cast<int64_t>(value));
+    }
+
+    template<typename T>
+    void store_as(uint64_t address, uint64_t value) {
+        auto narrow = static_cast<T>(value);
+        std::memcpy(reinterpret_cast<void *>(address), &narrow, sizeof(T));
+    }
+
+    //아래쪽 width 비트만 1인 마스크
+    uint64_t low_bits(int64_t width) {
+        return width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+    }
+
+    bool is_supported_type(Type *type) {
+        return type->isVoidTy() || type->isDoubleTy() || type->isPointerTy() ||
+               (type->isIntegerTy() && type->getIntegerBitWidth() <= 64);
+    }
+
+    unsigned get_width(Type *type) {
+        return type->isIntegerTy() ? type->getIntegerBitWidth() : 64;
+    }
+
+    void *find_c_symbol(const string &name) {
+        static bool loaded = [] {
+            llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+            return true;
+        }();
+        (void) loaded;
+        if (auto runtime_func = find_runtime_symbol(name))
+            return runtime_func;
+        return llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(name);
+    }
+}
+
+struct Interpreter::Lowering {
+    struct Patch {
+        size_t inst;
+        bool true_target; //조건 분기의 참 쪽(b)이면 true, 나머지는 imm
+        const BasicBlock *block;
+    };
+
+    Interpreter &interp;
+
+    llvm::Function &func;
+
+    Function &target;
+
+    Lowering(Interpreter &interp, llvm::Function &func, Function &target) : interp(interp), func(func), target(target) {}
+
+    std::unordered_map<const Value *, int32_t> regs;
+
+    std::unordered_map<uint64_t, int32_t> const_regs;
+
+    std::unordered_map<const BasicBlock *, int64_t> block_pc;
+
+    vector<Patch> patches;
+
+    bool ok = true;
+
+    bool fail(const string &reason) {
+        if (ok)
+            interp.fail(reason + " (" + func.getName().str() + " 함수)");
+        ok = false;
+        return false;
+    }
+
+    int32_t new_reg() {
+        target.init_regs.push_back(0);
+        return static_cast<int32_t>(target.init_regs.size() - 1);
+    }
+
+    int32_t const_reg(uint64_t value) {
+        auto [iter, inserted] = const_regs.try_emplace(value, 0);
+        if (inserted) {
+            iter->second = new_reg();
+            target.init_regs[iter->second] = value;
+        }
+        return iter->second;
+    }
+
+    int32_t get_reg(Value *value) {
+        if (auto iter = regs.find(value); iter != regs.end())
+            return iter->second;
+        uint64_t const_value = 0;
+        auto constant = dyn_cast<Constant>(value);
+        if (!constant || !interp.get_const_value(constant, const_value)) {
+            fail("인터프리터가 지원하지 않는 값입니다");
+            return 0;
+        }
+        return const_reg(const_value);
+    }
+
+    size_t emit(uint16_t op, int32_t dst = 0, int32_t a = 0, int32_t b = 0, int64_t imm = 0) {
+        target.code.push_back({op, dst, a, b, imm});
+        return target.code.size() - 1;
+    }
+
+    //src를 width 비트 정수로 보고 정규화해서 dst에 넣음
+    void emit_norm(int32_t dst, int32_t src, unsigned width) {
+        if (width == 1)
+            emit(op_mask, dst, src, 0, 1);
+        else if (width < 64)
+            emit(op_sext, dst, src, 0, 64 - width);
+        else if (dst != src)
+            emit(op_mov, dst, src);
+    }
+
+    //부호 없는 연산을 위해 0으로 확장한 값을 임시 레지스터에 만듦
+    int32_t zext_operand(int32_t src, unsigned width) {
+        if (width >= 64)
+            return src;
+        auto temp = new_reg();
+        emit(op_mask, temp, src, 0, static_cast<int64_t>((uint64_t{1} << width) - 1));
+        return temp;
+    }
+
+    //논리 값을 부호 있는 정수로 볼 때는 1이 -1임
+    int32_t sext_bool_operand(int32_t src, unsigned width) {
+        if (width != 1)
+            return src;
+        auto temp = new_reg();
+        emit(op_neg, temp, src);
+        return temp;
+    }
+
+    void jump_to(size_t inst, bool true_target, const BasicBlock *block) {
+        patches.push_back({inst, true_target, block});
+    }
+
+    //from에서 to로 갈 때 to의 phi들에 값을 넣음. phi끼리 값을 주고받을 수 있으므로 필요하면 임시 레지스터를 거침
+    void emit_phi_moves(const BasicBlock *from, const BasicBlock *to) {
+        vector<pair<int32_t, int32_t>> moves;
+        for (auto &phi: to->phis()) {
+            auto src = get_reg(phi.getIncomingValueForBlock(from));
+            auto dst = regs[&phi];
+            if (src != dst)
+                moves.emplace_back(dst, src);
+        }
+        bool overlap = false;
+        for (auto &[dst, src]: moves) {
+            for (auto &other: moves) {
+                if (other.second == dst)
+                    overlap = true;
+            }
+        }
+        if (!overlap) {
+            for (auto &[dst, src]: moves) {
+                emit(op_mov, dst, src);
+            }
+            return;
+        }
+        vector<int32_t> temps;
+        for (auto &[dst, src]: moves) {
+            temps.push_back(new_reg());
+            emit(op_mov, temps.back(), src);
+        }
+        for (size_t i = 0; i < moves.size(); ++i) {
+            emit(op_mov, moves[i].first, temps[i]);
+        }
+    }
+
+    //분기 명령어의 목적지를 정함. 목적지에 phi가 있으면 값을 옮기는 코드를 분기 명령어 뒤에 따로 만듦
+    void finish_edges(const BasicBlock *from, const vector<Patch> &edges) {
+        for (auto &edge: edges) {
+            if (!isa<PHINode>(edge.block->front())) {
+                patches.push_back(edge);
+                continue;
+            }
+            auto pc = static_cast<int64_t>(target.code.size());
+            if (edge.true_target)
+                target.code[edge.inst].b = static_cast<int32_t>(pc);
+            else
+                target.code[edge.inst].imm = pc;
+            emit_phi_moves(from, edge.block);
+            jump_to(emit(op_jmp), false, edge.block);
+        }
+    }
+
+    bool lower_call(CallInst &call);
+
+    bool lower_gep(GetElementPtrInst &gep);
+
+    bool lower_inst(Instruction &inst);
+
+    bool lower();
+};
+
+bool Interpreter::Lowering::lower_call(CallInst &call) {
+    auto callee = call.getCalledFunction();
+    if (!callee)
+        return fail("인터프리터는 함수 포인터 호출을 지원하지 않습니다");
+
+    CallSite site{-1, nullptr, {}, {}, call.getType()->isDoubleTy(),
+                  call.getType()->isVoidTy() ? 0 : get_width(call.getType())};
+    unsigned arg_count = call.arg_size();
+    string c_name = callee->getName().str();
+
+    if (callee->isIntrinsic()) {
+        switch (callee->getIntrinsicID()) {
+            case llvm::Intrinsic::lifetime_start:
+            case llvm::Intrinsic::lifetime_end:
+            case llvm::Intrinsic::assume:
+            case llvm::Intrinsic::donothing:
+                return true;
+            case llvm::Intrinsic::memset:
+            case llvm::Intrinsic::memcpy:
+            case llvm::Intrinsic::memmove:
+                c_name = c_name.substr(5, c_name.find('.', 5) - 5); //llvm.memset.p0.i64 -> memset
+                arg_count = 3;
+                site.ret_width = 0;
+                break;
+            case llvm::Intrinsic::smin:
+            case llvm::Intrinsic::smax:
+                emit(callee->getIntrinsicID() == llvm::Intrinsic::smin ? op_smin : op_smax, regs[&call],
+                     get_reg(call.getArgOperand(0)), get_reg(call.getArgOperand(1)));
+                return ok;
+            case llvm::Intrinsic::abs:
+                emit(op_abs, regs[&call], get_reg(call.getArgOperand(0)));
+                emit_norm(regs[&call], regs[&call], site.ret_width); //최솟값의 절댓값은 다시 최솟값이 됨
+                return ok;
+            case llvm::Intrinsic::ctpop:
+            case llvm::Intrinsic::ctlz:
+            case llvm::Intrinsic::cttz: { //imm은 비트 수
+                auto id = callee->getIntrinsicID();
+                emit(id == llvm::Intrinsic::ctpop ? op_ctpop : id == llvm::Intrinsic::ctlz ? op_ctlz : op_cttz,
+                     regs[&call], get_reg(call.getArgOperand(0)), 0, site.ret_width);
+                return ok;
+            }
+            default:
+                if (isa<llvm::DbgInfoIntrinsic>(call))
+                    return true;
+                //llvm.sqrt.f64 처럼 libm 함수와 같은 실수 intrinsic은 libm 함수를 호출함
+                if (!c_name.ends_with(".f64"))
+                    return fail("인터프리터가 지원하지 않는 intrinsic입니다: " + c_name);
+                c_name = c_name.substr(5, c_name.size() - 9);
+                if (c_name == "minnum" || c_name == "maxnum") //libm에서는 fmin, fmax
+                    c_name = "f" + c_name.substr(0, 3);
+                break;
+        }
+    }
+
+    //병렬 ㄱㄱ문은 몸체 함수로 전체 범위를 한 번에 호출해서 순서대로 실행함. 누적 변수는 결과에 바로 누적함
+    if (c_name == "zul_parallel_for" || c_name == "zul_parallel_reduce") {
+        if (auto body = dyn_cast<llvm::Function>(call.getArgOperand(0)); body && !body->isDeclaration()) {
+            auto partial = c_name == "zul_parallel_reduce" ? get_reg(call.getArgOperand(4)) : const_reg(0);
+            site.func = interp.func_index[body];
+            site.args = {get_reg(call.getArgOperand(1)), const_reg(0), get_reg(call.getArgOperand(2)), partial};
+            site.arg_is_float = {false, false, false, false};
+            interp.call_sites.push_back(std::move(site));
+            emit(op_call, new_reg(), 0, 0, static_cast<int64_t>(interp.call_sites.size() - 1));
+            return ok;
+        }
+    }
+
+    for (unsigned i = 0; i < arg_count; ++i) {
+        auto arg = call.getArgOperand(i);
+        site.args.push_back(get_reg(arg));
+        site.arg_is_float.push_back(arg->getType()->isDoubleTy());
+    }
+
+    int32_t dst = call.getType()->isVoidTy() ? new_reg() : regs[&call];
+    if (!callee->isDeclaration()) {
+        site.func = interp.func_index[callee];
+        interp.call_sites.push_back(std::move(site));
+        emit(call.isMustTailCall() ? op_tail_call : op_call, dst, 0, 0, static_cast<int64_t>(interp.call_sites.size() - 1));
+        return ok;
+    }
+
+#ifdef ZUL_INTERP_FFI
+    auto float_count = std::count(site.arg_is_float.begin(), site.arg_is_float.end(), true);
+    if (float_count > FFI_FLOAT_ARGS || static_cast<long>(site.args.size()) - float_count > FFI_INT_ARGS)
+        return fail("인자가 너무 많은 C 함수는 호출할 수 없습니다: " + c_name);
+    site.c_func = find_c_symbol(c_name);
+    if (!site.c_func)
+        return fail("C 함수를 찾을 수 없습니다: " + c_name);
+    auto ret_width = site.ret_float ? 64 : site.ret_width;
+    interp.call_sites.push_back(std::move(site));
+    emit(op_call_c, dst, 0, 0, static_cast<int64_t>(interp.call_sites.size() - 1));
+    if (ret_width && ret_width < 64)
+        emit_norm(dst, dst, ret_width);
+    return ok;
+#else
+    return fail("이 플랫폼에서는 인터프리터가 C 함수를 호출할 수 없습니다: " + c_name);
+#endif
+}
+
+bool Interpreter::Lowering::lower_gep(GetElementPtrInst &gep) {
+    auto &data_layout = interp.data_layout;
+    auto dst = regs[&gep];
+    auto base = get_reg(gep.getPointerOperand());
+    int64_t offset = 0;
+    for (auto iter = llvm::gep_type_begin(gep); iter != llvm::gep_type_end(gep); ++iter) {
+        auto index = iter.getOperand();
+        if (auto struct_type = iter.getStructTypeOrNull()) {
+            auto field = static_cast<unsigned>(llvm::cast<ConstantInt>(index)->getZExtValue());
+            offset += static_cast<int64_t>(data_layout.getStructLayout(struct_type)->getElementOffset(field));
+            continue;
+        }
+        auto scale = static_cast<int64_t>(data_layout.getTypeAllocSize(iter.getIndexedType()).getFixedValue());
+        if (auto const_index = dyn_cast<ConstantInt>(index)) {
+            offset += const_index->getSExtValue() * scale;
+            continue;
+        }
+        if (index->getType()->isVectorTy())
+            return fail("인터프리터는 벡터 getelementptr을 지원하지 않습니다");
+        emit(op_gep_index, dst, base, get_reg(index), scale);
+        base = dst;
+    }
+    if (offset != 0)
+        emit(op_gep, dst, base, 0, offset);
+    else if (base != dst)
+        emit(op_mov, dst, base);
+    return ok;
+}
+
+bool Interpreter::Lowering::lower_inst(Instruction &inst) {
+    if (!is_supported_type(inst.getType()))
+        return fail("인터프리터가 지원하지 않는 타입의 명령어입니다: " + string(inst.getOpcodeName()));
+    for (auto &operand: inst.operands()) {
+        auto type = operand->getType();
+        if (!type->isLabelTy() && !type->isMetadataTy() && !is_supported_type(type))
+            return fail("인터프리터가 지원하지 않는 타입의 명령어입니다: " + string(inst.getOpcodeName()));
+    }
+
+    auto dst = inst.getType()->isVoidTy() ? 0 : regs[&inst];
+    switch (inst.getOpcode()) {
+        case Instruction::PHI:
+            return true; //값은 들어오는 분기에서 옮김
+        case Instruction::Alloca: {
+            auto &alloca = static_cast<AllocaInst &>(inst);
+            auto count = dyn_cast<ConstantInt>(alloca.getArraySize());
+            if (!count)
+                return fail("인터프리터는 크기가 정해지지 않은 alloca를 지원하지 않습니다");
+            auto size = interp.data_layout.getTypeAllocSize(alloca.getAllocatedType()).getFixedValue() *
+                        count->getZExtValue();
+            auto align = std::max<uint64_t>(8, std::min<uint64_t>(16, alloca.getAlign().value()));
+            auto offset = llvm::alignTo(target.frame_bytes, align);
+            target.frame_bytes = offset + size;
+            emit(op_alloca, dst, 0, 0, static_cast<int64_t>(offset));
+            return true;
+        }
+        case Instruction::Load: {
+            auto &load = static_cast<LoadInst &>(inst);
+            auto width = inst.getType()->isIntegerTy() ? get_width(inst.getType()) : 64;
+            auto op = width <= 8 ? op_load8 : width <= 16 ? op_load16 : width <= 32 ? op_load32 : op_load64;
+            emit(op, dst, get_reg(load.getPointerOperand()));
+            if (width == 1)
+                emit_norm(dst, dst, 1);
+            return ok;
+        }
+        case Instruction::Store: {
+            auto &store = static_cast<StoreInst &>(inst);
+            auto type = store.getValueOperand()->getType();
+            auto width = type->isIntegerTy() ? get_width(type) : 64;
+            auto op = width <= 8 ? op_store8 : width <= 16 ? op_store16 : width <= 32 ? op_store32 : op_store64;
+            emit(op, 0, get_reg(store.getValueOperand()), get_reg(store.getPointerOperand()));
+            return ok;
+        }
+        case Instruction::Add:
+        case Instruction::Sub:
+        case Instruction::Mul:
+        case Instruction::Shl:
+        case Instruction::SDiv:
+        case Instruction::SRem:
+        case Instruction::AShr:
+        case Instruction::And:
+        case Instruction::Or:
+        case Instruction::Xor: {
+            uint16_t op;
+            switch (inst.getOpcode()) {
+                case Instruction::Add: op = op_add; break;
+                case Instruction::Sub: op = op_sub; break;
+                case Instruction::Mul: op = op_mul; break;
+                case Instruction::Shl: op = op_shl; break;
+                case Instruction::SDiv: op = op_sdiv; break;
+                case Instruction::SRem: op = op_srem; break;
+                case Instruction::AShr: op = op_ashr; break;
+                case Instruction::And: op = op_band; break;
+                case Instruction::Or: op = op_bor; break;
+                default: op = op_bxor; break;
+            }
+            auto width = get_width(inst.getType());
+            auto lhs = get_reg(inst.getOperand(0));
+            auto rhs = get_reg(inst.getOperand(1));
+            if (op == op_sdiv || op == op_srem) {
+                lhs = sext_bool_operand(lhs, width);
+                rhs = sext_bool_operand(rhs, width);
+            }
+            emit(op, dst, lhs, rhs);
+            //and, or, xor는 정규화된 값끼리 연산하면 결과도 정규화되어 있음
+            if (op != op_band && op != op_bor && op != op_bxor)
+                emit_norm(dst, dst, width);
+            return ok;
+        }
+        case Instruction::UDiv:
+        case Instruction::URem:
+        case Instruction::LShr: {
+            auto op = inst.getOpcode() == Instruction::UDiv ? op_udiv :
+                      inst.getOpcode() == Instruction::URem ? op_urem : op_lshr;
+            auto width = get_width(inst.getType());
+            auto lhs = zext_operand(get_reg(inst.getOperand(0)), width);
+            auto rhs = zext_operand(get_reg(inst.getOperand(1)), width);
+            emit(op, dst, lhs, rhs);
+            emit_norm(dst, dst, width);
+            return ok;
+        }
+        case Instruction::FAdd:
+            emit(op_fadd, dst, get_reg(inst.getOperand(0)), get_reg(inst.getOperand(1)));
+            return ok;
+        case Instruction::FSub:
+            emit(op_fsub, dst, get_reg(inst.getOperand(0)), get_reg(inst.getOperand(1)));
+            return ok;
+        case Instruction::FMul:
+            emit(op_fmul, dst, get_reg(inst.getOperand(0)), get_reg(inst.getOperand(1)));
+            return ok;
+        case Instruction::FDiv:
+            emit(op_fdiv, dst, get_reg(inst.getOperand(0)), get_reg(inst.getOperand(1)));
+            return ok;
+        case Instruction::FRem:
+            emit(op_frem, dst, get_reg(inst.getOperand(0)), get_reg(inst.getOperand(1)));
+            return ok;
+        case Instruction::FNeg:
+            emit(op_fneg, dst, get_reg(inst.getOperand(0)));
+            return ok;
+        case Instruction::ICmp: {
+            auto &cmp = static_cast<ICmpInst &>(inst);
+            auto width = get_width(cmp.getOperand(0)->getType());
+            auto lhs = get_reg(cmp.getOperand(0));
+            auto rhs = get_reg(cmp.getOperand(1));
+            if (cmp.isUnsigned()) {
+                lhs = zext_operand(lhs, width);
+                rhs = zext_operand(rhs, width);
+            } else if (cmp.isSigned()) {
+                lhs = sext_bool_operand(lhs, width);
+                rhs = sext_bool_operand(rhs, width);
+            }
+            uint16_t op;
+            switch (cmp.getPredicate()) {
+                case CmpInst::ICMP_EQ: op = op_ieq; break;
+                case CmpInst::ICMP_NE: op = op_ine; break;
+                case CmpInst::ICMP_SLT: op = op_islt; break;
+                case CmpInst::ICMP_SLE: op = op_isle; break;
+                case CmpInst::ICMP_SGT: op = op_isgt; break;
+                case CmpInst::ICMP_SGE: op = op_isge; break;
+                case CmpInst::ICMP_ULT: op = op_iult; break;
+                case CmpInst::ICMP_ULE: op = op_iule; break;
+                case CmpInst::ICMP_UGT: op = op_iugt; break;
+                default: op = op_iuge; break;
+            }
+            emit(op, dst, lhs, rhs);
+            return ok;
+        }
+        case Instruction::FCmp: {
+            auto &cmp = static_cast<FCmpInst &>(inst);
+            auto lhs = get_reg(cmp.getOperand(0));
+            auto rhs = get_reg(cmp.getOperand(1));
+            uint16_t op;
+            switch (cmp.getPredicate()) {
+                case CmpInst::FCMP_FALSE: emit(op_mov, dst, const_reg(0)); return ok;
+                case CmpInst::FCMP_TRUE: emit(op_mov, dst, const_reg(1)); return ok;
+                case CmpInst::FCMP_OEQ: op = op_foeq; break;
+                case CmpInst::FCMP_ONE: op = op_fone; break;
+                case CmpInst::FCMP_OLT: op = op_folt; break;
+                case CmpInst::FCMP_OLE: op = op_fole; break;
+                case CmpInst::FCMP_OGT: op = op_fogt; break;
+                case CmpInst::FCMP_OGE: op = op_foge; break;
+                case CmpInst::FCMP_ORD: op = op_ford; break;
+                case CmpInst::FCMP_UEQ: op = op_fueq; break;
+                case CmpInst::FCMP_UNE: op = op_fune; break;
+                case CmpInst::FCMP_ULT: op = op_fult; break;
+                case CmpInst::FCMP_ULE: op = op_fule; break;
+                case CmpInst::FCMP_UGT: op = op_fugt; break;
+                case CmpInst::FCMP_UGE: op = op_fuge; break;
+                default: op = op_funo; break;
+            }
+            emit(op, dst, lhs, rhs);
+            return ok;
+        }
+        case Instruction::ZExt: {
+            auto width = get_width(inst.getOperand(0)->getType());
+            auto src = get_reg(inst.getOperand(0));
+            if (width == 1)
+                emit(op_mov, dst, src);
+            else
+                emit(op_mask, dst, src, 0, static_cast<int64_t>((uint64_t{1} << width) - 1));
+            return ok;
+        }
+        case Instruction::SExt: {
+            auto width = get_width(inst.getOperand(0)->getType());
+            emit(width == 1 ? op_neg : op_mov, dst, get_reg(inst.getOperand(0)));
+            return ok;
+        }
+        case Instruction::Trunc:
+        case Instruction::BitCast:
+        case Instruction::PtrToInt:
+        case Instruction::IntToPtr:
+        case Instruction::Freeze:
+            emit_norm(dst, get_reg(inst.getOperand(0)), get_width(inst.getType()));
+            return ok;
+        case Instruction::SIToFP: {
+            auto width = get_width(inst.getOperand(0)->getType());
+            emit(op_sitofp, dst, sext_bool_operand(get_reg(inst.getOperand(0)), width));
+            return ok;
+        }
+        case Instruction::UIToFP: {
+            auto width = get_width(inst.getOperand(0)->getType());
+            emit(op_uitofp, dst, zext_operand(get_reg(inst.getOperand(0)), width));
+            return ok;
+        }
+        case Instruction::FPToSI:
+        case Instruction::FPToUI:
+            emit(inst.getOpcode() == Instruction::FPToSI ? op_fptosi : op_fptoui, dst, get_reg(inst.getOperand(0)));
+            emit_norm(dst, dst, get_width(inst.getType()));
+            return ok;
+        case Instruction::Select:
+            emit(op_select, dst, get_reg(inst.getOperand(0)), get_reg(inst.getOperand(1)),
+                 get_reg(inst.getOperand(2)));
+            return ok;
+        case Instruction::GetElementPtr:
+            return lower_gep(static_cast<GetElementPtrInst &>(inst));
+        case Instruction::Call:
+            return lower_call(static_cast<CallInst &>(inst));
+        case Instruction::Ret:
+            if (inst.getNumOperands() == 0)
+                emit(op_ret_void);
+            else
+                emit(op_ret, 0, get_reg(inst.getOperand(0)));
+            return ok;
+        case Instruction::Br: {
+            auto &branch = static_cast<BranchInst &>(inst);
+            auto from = branch.getParent();
+            if (branch.isUnconditional()) {
+                auto dest = branch.getSuccessor(0);
+                emit_phi_moves(from, dest);
+                if (dest != from->getNextNode()) //바로 다음 블록이면 점프하지 않음
+                    jump_to(emit(op_jmp), false, dest);
+                return ok;
+            }
+            auto br = emit(op_br, 0, get_reg(branch.getCondition()));
+            finish_edges(from, {{br, true, branch.getSuccessor(0)}, {br, false, branch.getSuccessor(1)}});
+            return ok;
+        }
+        case Instruction::Switch: {
+            auto &switch_inst = static_cast<SwitchInst &>(inst);
+            auto cond = get_reg(switch_inst.getCondition());
+            vector<Patch> edges;
+            for (auto &case_handle: switch_inst.cases()) {
+                auto temp = new_reg();
+                emit(op_ieq, temp, cond, get_reg(case_handle.getCaseValue()));
+                auto br = emit(op_br, 0, temp, 0, static_cast<int64_t>(target.code.size() + 1));
+                edges.push_back({br, true, case_handle.getCaseSuccessor()});
+            }
+            edges.push_back({emit(op_jmp), false, switch_inst.getDefaultDest()});
+            finish_edges(switch_inst.getParent(), edges);
+            return ok;
+        }
+        case Instruction::Unreachable:
+            emit(op_unreachable);
+            return true;
+        default:
+            return fail("인터프리터가 지원하지 않는 명령어입니다: " + string(inst.getOpcodeName()));
+    }
+}
+
+bool Interpreter::Lowering::lower() {
+    target.param_count = func.arg_size();
+    for (auto &arg: func.args()) {
+        if (!is_supported_type(arg.getType()))
+            return fail("인터프리터가 지원하지 않는 타입의 매개변수입니다");
+        regs[&arg] = new_reg();
+    }
+    //뒤쪽 블록에서 정의되는 값을 phi가 참조할 수 있으므로 레지스터를 먼저 정함
+    for (auto &block: func) {
+        for (auto &inst: block) {
+            if (!inst.getType()->isVoidTy())
+                regs[&inst] = new_reg();
+        }
+    }
+    for (auto &block: func) {
+        block_pc[&block] = static_cast<int64_t>(target.code.size());
+        for (auto &inst: block) {
+            if (!lower_inst(inst))
+                return false;
+        }
+    }
+    for (auto &patch: patches) {
+        auto pc = block_pc[patch.block];
+        if (patch.true_target)
+            target.code[patch.inst].b = static_cast<int32_t>(pc);
+        else
+            target.code[patch.inst].imm = pc;
+    }
+    return ok;
+}
+
+Interpreter::Interpreter() = default;
+
+Interpreter::~Interpreter() = default;
+
+bool Interpreter::fail(const string &reason) {
+    error = "에러: " + reason + '\n';
+    return false;
+}
+
+const string &Interpreter::get_error() const {
+    return error;
+}
+
+size_t Interpreter::count_insts(llvm::Module &module) {
+    size_t count = 0;
+    for (auto &func: module) {
+        count += func.getInstructionCount();
+    }
+    return count;
+}
+
+bool Interpreter::load(llvm::Module &module) {
+    data_layout = module.getDataLayout();
+    if (!init_globals(module))
+        return false;
+    for (auto &func: module) {
+        if (func.isDeclaration())
+            continue;
+        func_index[&func] = static_cast<int32_t>(funcs.size());
+        funcs.emplace_back();
+        funcs.back().name = func.getName().str();
+    }
+    for (auto &func: module) {
+        if (func.isDeclaration())
+            continue;
+        if (!Lowering{*this, func, funcs[func_index[&func]]}.lower())
+            return false;
+    }
+    return true;
+}
+
+bool Interpreter::init_globals(llvm::Module &module) {
+    //다른 전역 변수의 주소로 초기화될 수 있으므로 메모리를 먼저 모두 만듦
+    for (auto &global: module.globals()) {
+        if (global.isDeclaration()) {
+            auto address = find_c_symbol(global.getName().str());
+            if (!address)
+                return fail("전역 변수를 찾을 수 없습니다: " + global.getName().str());
+            global_addrs[&global] = static_cast<char *>(address);
+            continue;
+        }
+        auto size = data_layout.getTypeAllocSize(global.getValueType()).getFixedValue();
+        global_memory.emplace_back(new uint64_t[std::max<uint64_t>(1, (size + 7) / 8)]());
+        global_addrs[&global] = reinterpret_cast<char *>(global_memory.back().get());
+    }
+    for (auto &global: module.globals()) {
+        if (global.hasInitializer() && !write_const(global_addrs[&global], global.getInitializer()))
+            return false;
+    }
+    return true;
+}
+
+bool Interpreter::write_const(char *dest, Constant *constant) {
+    if (isa<llvm::ConstantAggregateZero>(constant) || isa<llvm::ConstantPointerNull>(constant) ||
+        isa<llvm::UndefValue>(constant))
+        return true;
+    auto type = constant->getType();
+    if (auto data = dyn_cast<llvm::ConstantDataSequential>(constant)) {
+        auto raw = data->getRawDataValues();
+        std::memcpy(dest, raw.data(), raw.size());
+        return true;
+    }
+    if (isa<llvm::ConstantAggregate>(constant)) {
+        auto struct_type = dyn_cast<llvm::StructType>(type);
+        auto layout = struct_type ? data_layout.getStructLayout(struct_type) : nullptr;
+        for (unsigned i = 0; i < constant->getNumOperands(); ++i) {
+            auto element = static_cast<Constant *>(constant->getOperand(i));
+            auto offset = layout ? layout->getElementOffset(i) :
+                          i * data_layout.getTypeAllocSize(element->getType()).getFixedValue();
+            if (!write_const(dest + offset, element))
+                return false;
+        }
+        return true;
+    }
+    if (auto const_fp = dyn_cast<ConstantFP>(constant); const_fp && type->isFloatTy()) {
+        auto value = const_fp->getValueAPF().convertToFloat();
+        std::memcpy(dest, &value, sizeof(value));
+        return true;
+    }
+    uint64_t value;
+    if (!get_const_value(constant, value))
+        return false;
+    std::memcpy(dest, &value, data_layout.getTypeStoreSize(type).getFixedValue());
+    return true;
+}
+
+bool Interpreter::get_const_value(Constant *constant, uint64_t &value) {
+    if (auto const_int = dyn_cast<ConstantInt>(constant)) {
+        value = const_int->getBitWidth() == 1 ? const_int->getZExtValue() :
+                static_cast<uint64_t>(const_int->getSExtValue());
+        return const_int->getBitWidth() <= 64 || fail("64비트보다 큰 정수는 지원하지 않습니다");
+    }
+    if (auto const_fp = dyn_cast<ConstantFP>(constant)) {
+        if (!const_fp->getType()->isDoubleTy())
+            return fail("인터프리터는 double이 아닌 실수 타입을 지원하지 않습니다");
+        value = std::bit_cast<uint64_t>(const_fp->getValueAPF().convertToDouble());
+        return true;
+    }
+    if (isa<llvm::ConstantPointerNull>(constant) || isa<llvm::UndefValue>(constant)) {
+        value = 0;
+        return true;
+    }
+    if (auto global = dyn_cast<GlobalVariable>(constant)) {
+        value = reinterpret_cast<uint64_t>(global_addrs[global]);
+        return true;
+    }
+    if (auto expr = dyn_cast<ConstantExpr>(constant)) {
+        if (auto gep = dyn_cast<llvm::GEPOperator>(expr)) {
+            llvm::APInt offset(64, 0);
+            if (!gep->accumulateConstantOffset(data_layout, offset) ||
+                !get_const_value(static_cast<Constant *>(gep->getPointerOperand()), value))
+                return fail("인터프리터가 지원하지 않는 상수 getelementptr입니다");
+            value += offset.getZExtValue();
+            return true;
+        }
+        if (expr->isCast())
+            return get_const_value(expr->getOperand(0), value);
+    }
+    return fail("인터프리터가 지원하지 않는 상수입니다");
+}
+
+long long Interpreter::run() {
+    int32_t entry = -1;
+    for (size_t i = 0; i < funcs.size(); ++i) {
+        if (funcs[i].name == ENTRY_FN_NAME)
+            entry = static_cast<int32_t>(i);
+    }
+    if (entry == -1) {
+        cerr << "에러: 시작 함수가 존재하지 않습니다.\n";
+        return 1;
+    }
+    stack.reset(new uint64_t[INTERP_STACK_SLOTS]);
+    stack_top = 0;
+    return static_cast<long long>(execute(entry));
+}
+
+uint64_t Interpreter::call_c(const CallSite &site, const uint64_t *regs) {
+#ifdef ZUL_INTERP_FFI
+    //가변 인자 함수 포인터로 호출하면 정수 인자는 정수 레지스터에, 실수 인자는 실수 레지스터에 순서대로 들어가므로
+    //printf 같은 가변 인자 함수와 sqrt 같은 일반 함수를 같은 방법으로 호출할 수 있음
+    int64_t ints[FFI_INT_ARGS] = {};
+    double floats[FFI_FLOAT_ARGS] = {};
+    int int_count = 0, float_count = 0;
+    for (size_t i = 0; i < site.args.size(); ++i) {
+        if (site.arg_is_float[i])
+            floats[float_count++] = std::bit_cast<double>(regs[site.args[i]]);
+        else
+            ints[int_count++] = static_cast<int64_t>(regs[site.args[i]]);
+    }
+    if (site.ret_float) {
+        auto func = reinterpret_cast<double (*)(int64_t, ...)>(site.c_func);
+        return std::bit_cast<uint64_t>(func(ints[0], ints[1], ints[2], ints[3], ints[4], ints[5],
+                                            floats[0], floats[1], floats[2], floats[3],
+                                            floats[4], floats[5], floats[6], floats[7]));
+    }
+    auto func = reinterpret_cast<int64_t (*)(int64_t, ...)>(site.c_func);
+    return static_cast<uint64_t>(func(ints[0], ints[1], ints[2], ints[3], ints[4], ints[5],
+                                      floats[0], floats[1], floats[2], floats[3],
+                                      floats[4], floats[5], floats[6], floats[7]));
+#else
+    (void) site;
+    (void) regs;
+    return 0;
+#endif
+}
+
+uint64_t Interpreter::execute(int32_t func_idx) {
+    //줄랭 함수를 호출해도 C 스택을 쓰지 않도록 호출한 함수의 상태는 call_frames에 쌓고 같은 루프에서 계속 실행함
+    call_frames.clear();
+    auto frame_base = stack_top;
+    const uint64_t *caller_regs = nullptr;
+    const int32_t *arg_regs = nullptr;
+    bool tail_entered = false;
+    const Function *func;
+    uint64_t *regs;
+    char *memory;
+    const Inst *code;
+    const Inst *pc;
+    uint64_t result = 0;
+    //새 함수의 프레임을 만들고 처음부터 실행함. musttail 호출은 현재 프레임을 호출된 함수의 프레임으로 바꾸고 여기서 다시 시작함
+    enter:
+    func = &funcs[func_idx];
+    auto reg_count = func->init_regs.size();
+    auto reg_slots = (reg_count + 1) / 2 * 2; //alloca 메모리를 16바이트로 정렬함
+    auto frame_slots = reg_slots + (func->frame_bytes + 7) / 8;
+    if (frame_base + frame_slots > INTERP_STACK_SLOTS) {
+        cerr << "에러: 인터프리터 스택이 넘쳤습니다. 재귀 호출이 너무 깊습니다\n";
+        exit(1);
+    }
+    regs = stack.get() + frame_base;
+    memory = reinterpret_cast<char *>(regs + reg_slots);
+    stack_top = frame_base + frame_slots;
+    std::memcpy(regs, func->init_regs.data(), reg_count * sizeof(uint64_t));
+    for (unsigned i = 0; i < func->param_count; ++i) {
+        regs[i] = tail_entered ? tail_args[i] : caller_regs[arg_regs[i]];
+    }
+
+    code = func->code.data();
+    pc = code;
+
+#define R(field) regs[pc->field]
+#define I(field) static_cast<int64_t>(regs[pc->field])
+#define F(field) std::bit_cast<double>(regs[pc->field])
+#define SET_F(value) regs[pc->dst] = std::bit_cast<uint64_t>(static_cast<double>(value))
+
+#ifdef ZUL_INTERP_THREADED
+    static const void *const labels[] = {
+#define ZUL_INTERP_LABEL(name) &&do_##name,
+            ZUL_INTERP_OPS(ZUL_INTERP_LABEL)
+#undef ZUL_INTERP_LABEL
+    };
+#define CASE(name) do_##name:
+#define DISPATCH() goto *labels[pc->op]
+#define NEXT() { ++pc; DISPATCH(); }
+    DISPATCH();
+#else
+#define CASE(name) case op_##name:
+#define DISPATCH() continue
+#define NEXT() { ++pc; continue; }
+    for (;;) switch (pc->op) {
+#endif
+    CASE(mov) R(dst) = R(a); NEXT()
+    CASE(alloca) R(dst) = reinterpret_cast<uint64_t>(memory + pc->imm); NEXT()
+    CASE(load8) R(dst) = load_as<int8_t>(R(a)); NEXT()
+    CASE(load16) R(dst) = load_as<int16_t>(R(a)); NEXT()
+    CASE(load32) R(dst) = load_as<int32_t>(R(a)); NEXT()
+    CASE(load64) R(dst) = load_as<int64_t>(R(a)); NEXT()
+    CASE(store8) store_as<uint8_t>(R(b), R(a)); NEXT()
+    CASE(store16) store_as<uint16_t>(R(b), R(a)); NEXT()
+    CASE(store32) store_as<uint32_t>(R(b), R(a)); NEXT()
+    CASE(store64) store_as<uint64_t>(R(b), R(a)); NEXT()
+    CASE(add) R(dst) = R(a) + R(b); NEXT()
+    CASE(sub) R(dst) = R(a) - R(b); NEXT()
+    CASE(mul) R(dst) = R(a) * R(b); NEXT()
+    CASE(sdiv) R(dst) = static_cast<uint64_t>(I(a) / I(b)); NEXT()
+    CASE(srem) R(dst) = static_cast<uint64_t>(I(a) % I(b)); NEXT()
+    CASE(udiv) R(dst) = R(a) / R(b); NEXT()
+    CASE(urem) R(dst) = R(a) % R(b); NEXT()
+    CASE(shl) R(dst) = R(a) << (R(b) & 63); NEXT()
+    CASE(ashr) R(dst) = static_cast<uint64_t>(I(a) >> (R(b) & 63)); NEXT()
+    CASE(lshr) R(dst) = R(a) >> (R(b) & 63); NEXT()
+    CASE(band) R(dst) = R(a) & R(b); NEXT()
+    CASE(bor) R(dst) = R(a) | R(b); NEXT()
+    CASE(bxor) R(dst) = R(a) ^ R(b); NEXT()
+    CASE(sext) R(dst) = static_cast<uint64_t>(static_cast<int64_t>(R(a) << pc->imm) >> pc->imm); NEXT()
+    CASE(mask) R(dst) = R(a) & static_cast<uint64_t>(pc->imm); NEXT()
+    CASE(neg) R(dst) = 0 - R(a); NEXT()
+    CASE(fadd) SET_F(F(a) + F(b)); NEXT()
+    CASE(fsub) SET_F(F(a) - F(b)); NEXT()
+    CASE(fmul) SET_F(F(a) * F(b)); NEXT()
+    CASE(fdiv) SET_F(F(a) / F(b)); NEXT()
+    CASE(frem) SET_F(std::fmod(F(a), F(b))); NEXT()
+    CASE(fneg) SET_F(-F(a)); NEXT()
+    CASE(ieq) R(dst) = R(a) == R(b); NEXT()
+    CASE(ine) R(dst) = R(a) != R(b); NEXT()
+    CASE(islt) R(dst) = I(a) < I(b); NEXT()
+    CASE(isle) R(dst) = I(a) <= I(b); NEXT()
+    CASE(isgt) R(dst) = I(a) > I(b); NEXT()
+    CASE(isge) R(dst) = I(a) >= I(b); NEXT()
+    CASE(iult) R(dst) = R(a) < R(b); NEXT()
+    CASE(iule) R(dst) = R(a) <= R(b); NEXT()
+    CASE(iugt) R(dst) = R(a) > R(b); NEXT()
+    CASE(iuge) R(dst) = R(a) >= R(b); NEXT()
+    CASE(foeq) R(dst) = F(a) == F(b); NEXT()
+    CASE(fone) R(dst) = F(a) < F(b) || F(a) > F(b); NEXT()
+    CASE(folt) R(dst) = F(a) < F(b); NEXT()
+    CASE(fole) R(dst) = F(a) <= F(b); NEXT()
+    CASE(fogt) R(dst) = F(a) > F(b); NEXT()
+    CASE(foge) R(dst) = F(a) >= F(b); NEXT()
+    CASE(ford) R(dst) = !std::isnan(F(a)) && !std::isnan(F(b)); NEXT()
+    CASE(fueq) R(dst) = !(F(a) < F(b) || F(a) > F(b)); NEXT()
+    CASE(fune) R(dst) = !(F(a) == F(b)); NEXT()
+    CASE(fult) R(dst) = !(F(a) >= F(b)); NEXT()
+    CASE(fule) R(dst) = !(F(a) > F(b)); NEXT()
+    CASE(fugt) R(dst) = !(F(a) <= F(b)); NEXT()
+    CASE(fuge) R(dst) = !(F(a) < F(b)); NEXT()
+    CASE(funo) R(dst) = std::isnan(F(a)) || std::isnan(F(b)); NEXT()
+    CASE(sitofp) SET_F(I(a)); NEXT()
+    CASE(uitofp) SET_F(R(a)); NEXT()
+    CASE(fptosi) R(dst) = static_cast<uint64_t>(static_cast<int64_t>(F(a))); NEXT()
+    CASE(fptoui) R(dst) = static_cast<uint64_t>(F(a)); NEXT()
+    CASE(select) R(dst) = R(a) ? R(b) : regs[pc->imm]; NEXT()
+    CASE(smin) R(dst) = static_cast<uint64_t>(std::min(I(a), I(b))); NEXT()
+    CASE(smax) R(dst) = static_cast<uint64_t>(std::max(I(a), I(b))); NEXT()
+    CASE(abs) R(dst) = I(a) < 0 ? 0 - R(a) : R(a); NEXT()
+    CASE(ctpop) R(dst) = std::popcount(R(a) & low_bits(pc->imm)); NEXT()
+    CASE(ctlz) R(dst) = std::countl_zero(R(a) & low_bits(pc->imm)) - (64 - pc->imm); NEXT()
+    CASE(cttz) R(dst) = std::min<int64_t>(std::countr_zero(R(a)), pc->imm); NEXT()
+    CASE(gep) R(dst) = R(a) + static_cast<uint64_t>(pc->imm); NEXT()
+    CASE(gep_index) R(dst) = R(a) + R(b) * static_cast<uint64_t>(pc->imm); NEXT()
+    CASE(jmp) pc = code + pc->imm; DISPATCH();
+    CASE(br) pc = code + (R(a) ? pc->b : pc->imm); DISPATCH();
+    CASE(call) {
+        auto &site = call_sites[pc->imm];
+        call_frames.push_back({func, pc, frame_base, regs, memory});
+        func_idx = site.func;
+        frame_base = stack_top;
+        caller_regs = regs;
+        arg_regs = site.args.data();
+        tail_entered = false;
+        goto enter;
+    }
+    CASE(tail_call) {
+        auto &site = call_sites[pc->imm];
+        tail_args.resize(site.args.size());
+        for (size_t i = 0; i < site.args.size(); ++i) {
+            tail_args[i] = regs[site.args[i]];
+        }
+        func_idx = site.func;
+        tail_entered = true;
+        goto enter;
+    }
+    CASE(call_c) R(dst) = call_c(call_sites[pc->imm], regs); NEXT()
+    CASE(ret) result = R(a); goto leave;
+    CASE(ret_void) result = 0; goto leave;
+    CASE(unreachable)
+        cerr << "에러: " << func->name << " 함수에서 도달할 수 없는 코드를 실행했습니다\n";
+        exit(1);
+    //프레임을 지우고 호출한 함수의 call 명령어 다음부터 실행함. 호출한 함수가 없으면 실행을 마침
+    leave:
+        stack_top = frame_base;
+        if (call_frames.empty())
+            return result;
+        func = call_frames.back().func;
+        pc = call_frames.back().call_pc;
+        frame_base = call_frames.back().frame_base;
+        regs = call_frames.back().regs;
+        memory = call_frames.back().memory;
+        code = func->code.data();
+        call_frames.pop_back();
+        R(dst) = result;
+        NEXT()
+#ifndef ZUL_INTERP_THREADED
+    }
+#endif
+#undef CASE
+#undef DISPATCH
+#undef NEXT
+#undef R
+#undef I
+#undef F
+#undef SET_F
+}
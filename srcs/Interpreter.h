@@ -0,0 +1,116 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_INTERPRETER_H
+#define ZULLANG_INTERPRETER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Module.h"
+
+#define AUTO_INTERP_LIMIT 2000 //--auto 모드에서 IR 명령어 수가 이보다 적으면 인터프리터로 실행함
+
+//--interp 모드의 바이트코드 인터프리터
+//AST의 코드 생성기가 만든 IR을 레지스터 기반 바이트코드로 바꿔서 바로 실행하므로, JIT 초기화와 기계어 생성 비용이 없음
+//C 함수(printf, rand 등)는 프로세스에서 심볼을 찾아 레지스터 호출 규약대로 호출함
+class Interpreter {
+public:
+    Interpreter();
+
+    ~Interpreter();
+
+    Interpreter(const Interpreter &) = delete;
+
+    Interpreter &operator=(const Interpreter &) = delete;
+
+    //모듈을 바이트코드로 바꾸고 전역 변수를 만듦. 지원하지 않는 구문이 있으면 false를 반환함
+    bool load(llvm::Module &module);
+
+    //시작 함수를 실행함
+    long long run();
+
+    [[nodiscard]] const std::string &get_error() const;
+
+    static size_t count_insts(llvm::Module &module);
+
+private:
+    struct Inst {
+        uint16_t op;
+        int32_t dst;
+        int32_t a;
+        int32_t b;
+        int64_t imm;
+    };
+
+    struct CallSite {
+        int32_t func; //인터프리터 함수 번호. C 함수면 -1
+        void *c_func;
+        std::vector<int32_t> args;
+        std::vector<bool> arg_is_float;
+        bool ret_float;
+        unsigned ret_width; //반환값을 정규화할 비트 수. 반환값이 없으면 0
+    };
+
+    struct Function {
+        std::string name;
+        std::vector<Inst> code;
+        std::vector<uint64_t> init_regs; //상수가 채워진 레지스터 초깃값
+        unsigned param_count = 0;
+        size_t frame_bytes = 0; //alloca들이 사용할 메모리 크기
+    };
+
+    //줄랭 함수를 호출한 함수로 돌아갈 때 필요한 상태
+    struct CallFrame {
+        const Function *func;
+        const Inst *call_pc; //호출한 call 명령어. 반환값은 이 명령어의 dst에 들어감
+        size_t frame_base;
+        uint64_t *regs;
+        char *memory;
+    };
+
+    struct Lowering; //함수 하나를 바이트코드로 바꾸는 동안의 상태
+
+    std::vector<Function> funcs;
+
+    std::vector<CallSite> call_sites;
+
+    std::unordered_map<const llvm::Function *, int32_t> func_index;
+
+    std::unordered_map<const llvm::GlobalVariable *, char *> global_addrs;
+
+    std::vector<std::unique_ptr<uint64_t[]>> global_memory;
+
+    std::unique_ptr<uint64_t[]> stack; //레지스터와 alloca 메모리가 쌓이는 스택
+
+    size_t stack_top = 0;
+
+    std::vector<uint64_t> tail_args; //musttail 호출로 프레임을 바꿀 때 새 함수에 넘길 인자
+
+    std::vector<CallFrame> call_frames; //실행 중인 함수를 호출한 함수들. 재귀 깊이는 C 스택이 아니라 stack 크기로만 제한됨
+
+    llvm::DataLayout data_layout{""};
+
+    std::string error;
+
+    bool fail(const std::string &reason);
+
+    bool init_globals(llvm::Module &module);
+
+    bool write_const(char *dest, llvm::Constant *constant);
+
+    bool get_const_value(llvm::Constant *constant, uint64_t &value);
+
+    bool lower_func(llvm::Function &func, Function &target);
+
+    //인자가 없는 함수를 실행함. 안에서 호출하는 줄랭 함수들도 재귀 없이 같은 디스패치 루프에서 실행함
+    uint64_t execute(int32_t func_idx);
+
+    static uint64_t call_c(const CallSite &site, const uint64_t *regs);
+};
+
+#endif //ZULLANG_INTERPRETER_H
@@ -6,20 +6,15 @@
 #include "Utility.h"
 
 using std::string;
-using std::cerr;
-using std::ifstream;
 using std::pair;
 using std::initializer_list;
 using std::string_view;
 using std::unordered_map;
 
-Lexer::Lexer(const string &source_name) : source(source_name) {
+Lexer::Lexer(string_view source, int first_line, Logger &logger) :
+        source(source), logger(logger), cur_loc(first_line, 0), token_loc(first_line, 0) {
     last_word.reserve(30);
     cur_line.reserve(80);
-    if (!source.is_open()) {
-        cerr << "에러: \"" << source_name << "\" 파일이 존재하지 않습니다.";
-        exit(1);
-    }
     advance();
 }
 
@@ -33,22 +28,28 @@ void Lexer::log_unexpected(string_view msg) {
 }
 
 void Lexer::log_token(string_view msg) {
-    System::logger.log_error(token_loc, last_word.size(), msg);
+    logger.log_error(token_loc, last_word.size(), msg);
 }
 
 void Lexer::log_token(const std::initializer_list<std::string_view> &msgs) {
-    System::logger.log_error(token_loc, last_word.size(), msgs);
+    logger.log_error(token_loc, last_word.size(), msgs);
+}
+
+int Lexer::read_byte() {
+    if (source_pos >= source.size())
+        return EOF;
+    return static_cast<unsigned char>(source[source_pos++]);
 }
 
 int Lexer::inner_advance() {
-    int input = source.get();
+    int input = read_byte();
     cur_line.push_back(input);
     raw_last_char.push_back(input);
     return input;
 }
 
 void Lexer::advance() {
-    int input = source.get();
+    int input = read_byte();
     cur_loc.second++;
     raw_last_char.clear();
     if (input != '\n' && input != EOF) {
@@ -73,8 +74,6 @@ void Lexer::advance() {
 }
 
 Token Lexer::get_token() {
-    static bool is_line_start = true;
-
     last_word.clear();
 
     if (is_line_start) {
@@ -108,7 +107,7 @@ Token Lexer::get_token() {
 
     if (last_char == '\n') {
         is_line_start = true;
-        System::logger.register_line(cur_loc.first, std::move(cur_line));
+        logger.register_line(cur_loc.first, std::move(cur_line));
         cur_line.reserve(80);
         cur_loc.first++;
         cur_loc.second = 0;
@@ -121,8 +120,8 @@ Token Lexer::get_token() {
             last_word.append(raw_last_char);
             advance();
         }
-        if (token_map.contains(last_word))
-            return token_map[last_word];
+        if (auto iter = token_map.find(last_word); iter != token_map.end())
+            return iter->second;
 
         return tok_identifier;
     }
@@ -163,7 +162,9 @@ Token Lexer::get_token() {
     }
 
     if (last_char == EOF) {
-        System::logger.register_line(cur_loc.first, std::move(cur_line));
+        //단위가 줄바꿈으로 끝났으면 이 줄은 다음 단위의 첫 줄이므로 등록하지 않음
+        if (!cur_line.empty())
+            logger.register_line(cur_loc.first, std::move(cur_line));
         return tok_eof;
     }
 
@@ -185,13 +186,14 @@ Token Lexer::get_token() {
 
     last_word.pop_back();
 
-    if (token_map[last_word] == tok_anno) {
-        while (last_char != '\n')
+    auto token = token_map.at(last_word);
+    if (token == tok_anno) {
+        while (last_char != '\n' && last_char != EOF)
             advance();
         return get_token();
     }
 
-    return token_map[last_word];
+    return token;
 }
 
 string &Lexer::get_word() {
@@ -210,7 +212,7 @@ std::string Lexer::get_line_substr(int st, int ed) {
     return cur_line.substr(st, ed - st);
 }
 
-unordered_map<string_view, Token> Lexer::token_map =
+const unordered_map<string_view, Token> Lexer::token_map =
         {{"ㅎㅇ",  tok_hi},
          {"ㄱㄱ",  tok_go},
          {"ㅇㅈ?", tok_ij},
@@ -219,6 +221,7 @@ unordered_map<string_view, Token> Lexer::token_map =
          {"ㅈㅈ",  tok_gg},
          {"ㅅㄱ",  tok_sg},
          {"ㅌㅌ",  tok_tt},
+         {"ㄱㅈ",  tok_const},
          {"참",   tok_true},
          {"거짓",  tok_false},
 
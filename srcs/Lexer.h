@@ -5,7 +5,6 @@
 #ifndef ZULLANG_LEXER_H
 #define ZULLANG_LEXER_H
 
-#include <fstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -13,7 +12,6 @@
 #include <initializer_list>
 
 #include "Logger.h"
-#include "System.h"
 
 enum Token {
     // keyword
@@ -25,6 +23,7 @@ enum Token {
     tok_gg, // ㅈㅈ
     tok_sg, //ㅅㄱ
     tok_tt, //ㅌㅌ
+    tok_const, //ㄱㅈ
     tok_true, //참
     tok_false, //거짓
 
@@ -95,7 +94,8 @@ enum Token {
 
 class Lexer {
 public:
-    explicit Lexer(const std::string& source_name);
+    //소스의 일부분(최상위 단위 하나)을 읽음. first_line은 그 부분이 시작하는 줄 번호
+    Lexer(std::string_view source, int first_line, Logger &logger);
 
     Token get_token();
 
@@ -122,13 +122,21 @@ private:
 
     std::string raw_last_char; //utf8 한 글자를 그대로 저장하기 위한 버퍼
 
-    std::ifstream source;
+    std::string_view source;
 
-    std::pair<int, int> cur_loc = {1, 0};
+    Logger &logger;
 
-    std::pair<int, int> token_loc = {1, 0}; //마지막으로 읽은 토큰의 시작 위치
+    size_t source_pos = 0;
 
-    static std::unordered_map<std::string_view, Token> token_map;
+    bool is_line_start = true;
+
+    std::pair<int, int> cur_loc;
+
+    std::pair<int, int> token_loc; //마지막으로 읽은 토큰의 시작 위치
+
+    static const std::unordered_map<std::string_view, Token> token_map;
+
+    int read_byte();
 
     int inner_advance();
 
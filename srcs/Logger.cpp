@@ -8,7 +8,8 @@ using std::pair;
 using std::string;
 using std::unordered_map;
 using std::string_view;
-using std::clog;
+
+const string_view level_labels[] = {": 에러: ", ": 경고: ", ": 참고: "}; //Logger::Level 순서
 
 Logger::Logger() : error_flag(false) {
     line_map.reserve(70);
@@ -19,6 +20,7 @@ Logger::~Logger() {
 }
 
 void Logger::log_error(pair<int, int> loc, unsigned word_size, string_view msg) {
+    std::lock_guard lock{log_mutex};
     buffer.emplace(loc, word_size, string(msg));
     error_flag = true;
 }
@@ -34,11 +36,45 @@ void Logger::log_error(pair<int, int> loc, unsigned word_size, const std::initia
     for (const auto &x: msgs) {
         str.append(x);
     }
+    std::lock_guard lock{log_mutex};
     buffer.emplace(loc, word_size, std::move(str));
     error_flag = true;
 }
 
+void Logger::log_error(const std::initializer_list<std::string_view> &msgs) {
+    write_message(level_error, msgs);
+    error_flag = true;
+}
+
+void Logger::log_warning(pair<int, int> loc, unsigned word_size, string_view msg) {
+    std::lock_guard lock{log_mutex};
+    buffer.emplace(loc, word_size, string(msg), level_warning);
+}
+
+void Logger::log_note(pair<int, int> loc, unsigned word_size, const std::initializer_list<string_view> &msgs) {
+    string str;
+    for (const auto &x: msgs) {
+        str.append(x);
+    }
+    std::lock_guard lock{log_mutex};
+    buffer.emplace(loc, word_size, std::move(str), level_note);
+}
+
+void Logger::log_note(const std::initializer_list<string_view> &msgs) {
+    write_message(level_note, msgs);
+}
+
+void Logger::write_message(Level level, const std::initializer_list<string_view> &msgs) {
+    std::lock_guard lock{log_mutex};
+    *output << level_labels[level].substr(2); //위치가 없으므로 "에러: "처럼 앞의 ": "를 뺌
+    for (const auto &x: msgs) {
+        *output << x;
+    }
+    *output << '\n';
+}
+
 void Logger::register_line(int line_num, string &&line) {
+    std::lock_guard lock{log_mutex};
     line_map.emplace(line_num, std::move(line));
 }
 
@@ -77,10 +113,10 @@ string Logger::highlight(std::string_view str, int col, unsigned word_size) {
     int c = get_byte_count(str[idx]);
     if (c > 1)
         ret.push_back('~');
-    word_size -= c;
+    word_size = word_size > static_cast<unsigned>(c) ? word_size - c : 0; //글자 수로 계산된 길이가 들어와도 줄을 넘지 않게 함
     idx += c;
     int m_byte = 0;
-    for (int i = 0; i < word_size;) {
+    for (unsigned i = 0; i < word_size && idx < static_cast<int>(str.size());) {
         int cnt = get_byte_count(str[idx]);
         if (cnt == 1) {
             ret.push_back('~');
@@ -98,15 +134,17 @@ string Logger::highlight(std::string_view str, int col, unsigned word_size) {
 }
 
 void Logger::flush() {
+    std::lock_guard lock{log_mutex};
     while (!buffer.empty()) {
         auto &log = buffer.top();
-        clog << source_name << ' ' << log.row << ':' << log.col << ": 에러: " << log.msg << '\n';
-        clog.width(5);
-        clog << log.row << " | " << line_map[log.row]
-             << "\n      | " << highlight(line_map[log.row], log.col - 1, log.word_size) << '\n';
+        auto &os = *output;
+        os << source_name << ' ' << log.row << ':' << log.col << level_labels[log.level] << log.msg << '\n';
+        os.width(5);
+        os << log.row << " | " << line_map[log.row]
+           << "\n      | " << highlight(line_map[log.row], log.col - 1, log.word_size) << '\n';
         buffer.pop();
     }
-    line_map.clear();
+    //함수의 코드 생성은 파싱이 모두 끝난 뒤에 하므로, 그때 남는 에러를 위해 줄은 지우지 않음
 }
 
 void Logger::set_error() {
@@ -119,4 +157,8 @@ bool Logger::has_error() const {
 
 void Logger::set_source_name(const string &name) {
     source_name = name;
+}
+
+void Logger::set_output(std::ostream &os) {
+    output = &os;
 }
\ No newline at end of file
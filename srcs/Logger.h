@@ -5,6 +5,8 @@
 #ifndef ZULLANG_LOGGER_H
 #define ZULLANG_LOGGER_H
 
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -15,15 +17,22 @@
 
 class Logger {
 public:
+    enum Level {
+        level_error,
+        level_warning, //경고는 출력만 하고 컴파일을 멈추지 않음
+        level_note //진단 옵션으로 요청한 정보
+    };
+
     struct LogInfo {
         int row, col;
         unsigned word_size;
         std::string msg;
+        Level level = level_error;
 
         LogInfo() = default;
 
-        LogInfo(std::pair<int, int> loc, unsigned word_size, std::string &&msg)
-                : row(loc.first), col(loc.second), word_size(word_size), msg(std::move(msg)) {}
+        LogInfo(std::pair<int, int> loc, unsigned word_size, std::string &&msg, Level level = level_error)
+                : row(loc.first), col(loc.second), word_size(word_size), msg(std::move(msg)), level(level) {}
 
         bool operator>(const LogInfo &other) const {
             if (row == other.row) return col > other.col;
@@ -37,10 +46,22 @@ public:
 
     void set_source_name(const std::string &name);
 
+    void set_output(std::ostream &os);
+
     void log_error(std::pair<int, int> loc, unsigned word_size, std::string_view msg);
 
     void log_error(std::pair<int, int> loc, unsigned word_size, const std::initializer_list<std::string_view> &msgs);
 
+    //파일이 없거나 진입점이 없는 것처럼 소스의 위치가 없는 에러. 버퍼에 모으지 않고 바로 출력함
+    void log_error(const std::initializer_list<std::string_view> &msgs);
+
+    void log_warning(std::pair<int, int> loc, unsigned word_size, std::string_view msg);
+
+    void log_note(std::pair<int, int> loc, unsigned word_size, const std::initializer_list<std::string_view> &msgs);
+
+    //소스의 위치가 없는 참고 메세지. 바로 출력함
+    void log_note(const std::initializer_list<std::string_view> &msgs);
+
     void register_line(int line_num, std::string &&line);
 
     void flush();
@@ -52,11 +73,17 @@ public:
 private:
     std::string source_name;
 
+    std::ostream *output = &std::clog; //에러 메세지를 출력할 스트림. 임베딩할 때는 문자열로 받을 수 있음
+
     std::priority_queue<LogInfo, std::vector<LogInfo>, std::greater<>> buffer;
 
     std::unordered_map<int, std::string> line_map;
 
-    bool error_flag;
+    std::atomic<bool> error_flag;
+
+    std::mutex log_mutex; //코드 생성 스레드들이 동시에 에러를 남길 수 있음
+
+    void write_message(Level level, const std::initializer_list<std::string_view> &msgs);
 
     static int get_byte_count(int c);
 
@@ -15,12 +15,8 @@ using std::make_unique;
 using std::make_pair;
 using std::to_string;
 
-using llvm::BranchInst;
-using llvm::ReturnInst;
-using llvm::isa;
 using llvm::Module;
 using llvm::LLVMContext;
-using llvm::BasicBlock;
 using llvm::Type;
 using llvm::Value;
 using llvm::ArrayType;
@@ -30,92 +26,47 @@ using llvm::Function;
 using llvm::Constant;
 using llvm::ConstantInt;
 using llvm::ConstantAggregateZero;
+using llvm::ConstantArray;
 using llvm::sys::getProcessTriple;
 
-bool remove_all_pred(BasicBlock *bb) {
-    if (bb->isEntryBlock())
-        return false;
-    if (bb->hasNPredecessors(0)) {
-        bb->dropAllReferences();
-        bb->eraseFromParent();
-        return true;
-    }
-    auto pred = bb->getSinglePredecessor();
-    if (!pred)
-        return false;
-    if (remove_all_pred(pred)) {
-        bb->dropAllReferences();
-        bb->eraseFromParent();
-        return true;
-    }
-    return false;
-}
-
-Parser::Parser(const string &source_name, const std::string &target_triple) : lexer(source_name) {
-    zulctx.module->setSourceFileName(source_name);
-    zulctx.module->setTargetTriple(target_triple);
-
-    auto i32ty = Type::getInt32Ty(*zulctx.context);
-    auto i8ptrty = PointerType::getUnqual(Type::getInt8Ty(*zulctx.context));
-    auto fty = llvm::FunctionType::get(i32ty, {i8ptrty}, true);
-
-    llvm::Function::Create(fty, llvm::Function::ExternalLinkage, "printf", *zulctx.module);
-    llvm::Function::Create(fty, llvm::Function::ExternalLinkage, "scanf", *zulctx.module);
+#define LOOP_HINT_MAX 64 //반복문 힌트에 적을 수 있는 가장 큰 값
 
+Parser::Parser(std::string_view source, int first_line, ZulContext &zulctx,
+               std::map<std::string, FuncProtoAST> &func_proto_map) :
+        zulctx(zulctx), func_proto_map(func_proto_map), symbols(zulctx.global_var_map), source(source),
+        lexer(source, first_line, zulctx.logger) {
     advance();
 }
 
-pair<unique_ptr<llvm::LLVMContext>, unique_ptr<llvm::Module>> Parser::parse() {
-    parse_top_level();
-
-    if (!func_proto_map.contains(ENTRY_FN_NAME) || !func_proto_map[ENTRY_FN_NAME].has_body) {
-        cerr << "에러: 진입점이 정의되지 않았습니다. \"" << ENTRY_FN_NAME << "\" 함수 정의가 필요합니다\n";
-        System::logger.set_error();
-    }
-
-    return {std::move(zulctx.context), std::move(zulctx.module)};
-}
-
 void Parser::advance() {
     cur_tok = lexer.get_token();
 }
 
 int Parser::get_op_prec() {
-    if (op_prec_map.contains(cur_tok))
-        return op_prec_map[cur_tok];
+    if (auto iter = op_prec_map.find(cur_tok); iter != op_prec_map.end())
+        return iter->second;
     return -1;
 }
 
 void Parser::parse_top_level() {
-    string name;
-    pair<int, int> name_loc;
     while (true) {
         if (cur_tok == tok_eof)
             break;
         if (cur_tok == tok_newline) {
-            System::logger.flush();
             advance();
         } else if (cur_tok == tok_identifier) { //전역 변수 선언
             parse_global_var();
-        } else if (cur_tok == tok_hi) {
+        } else if (cur_tok == tok_const) { //상수 전역 변수 선언
             advance();
-            if (cur_tok != tok_identifier) {
-                lexer.log_unexpected("함수 또는 클래스의 이름이 와야 합니다");
+            if (cur_tok == tok_identifier) {
+                parse_global_var(true);
             } else {
-                name = lexer.get_word();
-                name_loc = lexer.get_token_loc();
-                advance();
-            }
-            if (cur_tok == tok_colon) { //클래스 정의
-                lexer.log_token("아직 클래스 정의가 지원되지 않습니다");
-                advance();
-            } else if (cur_tok == tok_lpar) { //함수 정의
-                advance();
-                parse_func_def(name, name_loc, 1);
-            } else {
-                lexer.log_unexpected();
+                lexer.log_unexpected("상수의 이름이 와야 합니다");
                 advance();
             }
+        } else if (cur_tok == tok_hi) { //잘못 들여쓰기된 함수 정의. 에러를 모두 찾기 위해 파싱만 함
+            if (parse_func_header())
+                parse_func_body();
         } else {
             lexer.log_unexpected();
             advance();
@@ -123,96 +74,195 @@ void Parser::parse_top_level() {
     }
 }
 
-void Parser::parse_global_var() {
+void Parser::parse_global_var(bool is_const) {
     auto var_name = lexer.get_word();
     auto var_loc = lexer.get_token_loc();
     advance();
     if (zulctx.global_var_map.contains(var_name)) {
-        System::logger.log_error(var_loc, var_name.size(), "변수가 다시 정의되었습니다.");
+        zulctx.logger.log_error(var_loc, var_name.size(), "변수가 다시 정의되었습니다.");
         return;
     }
+    //상수는 값이 바뀌지 않으므로 코드 생성 때 초깃값으로 바로 바뀜
+    auto require_init = [&] {
+        if (is_const && cur_tok != tok_assn) {
+            zulctx.logger.log_error(var_loc, var_name.size(), "상수는 선언할 때 초기화해야 합니다");
+            return false;
+        }
+        return true;
+    };
     if (cur_tok == tok_colon) { //타입 명시
         advance();
         auto [type_id, size_expr] = parse_type();
         if (type_id == -1)
             return;
-        if (cur_tok == tok_assn) { //선언과 초기화
-            advance();
-            auto body = parse_expr();
-            if (!body)
-                return;
-            if (!body->is_const()) {
-                System::logger.log_error(var_loc, var_name.size(), "대입 구문이 상수식이 아닙니다. 전역 변수는 상수식으로만 초기화 할 수 있습니다.");
-                return;
-            }
-            if (size_expr != nullptr) {
-                System::logger.log_error(var_loc, var_name.size(), "배열 타입은 아직 선언과 동시에 초기화 할 수 없습니다");
-                return;
-            }
-            auto init_val = body->code_gen(zulctx);
-            if (init_val.second != type_id && !create_cast(zulctx, init_val, type_id)) {
-                System::logger.log_error(var_loc, var_name.size(),
-                                         {"대입 연산식의 타입 \"",
-                                          get_type_name(init_val.second), "\" 에서 변수의 타입 \"",
-                                          get_type_name(type_id),
-                                          "\" 로 캐스팅 할 수 없습니다"});
-                return;
-            }
-            auto global_var = new GlobalVariable(*zulctx.module, init_val.first->getType(), false,
-                                                 GlobalVariable::ExternalLinkage,
-                                                 static_cast<Constant *>(init_val.first), var_name);
-            zulctx.global_var_map.emplace(var_name, make_pair(global_var, type_id));
+        if (!require_init())
             return;
-        }
-        //선언만
-        auto llvm_type = get_llvm_type(*zulctx.context, type_id);
         if (size_expr == nullptr) { //배열이 아닌 경우
+            auto llvm_type = get_llvm_type(*zulctx.context, type_id);
             auto init_val = get_const_zero(llvm_type, type_id);
+            if (cur_tok == tok_assn) { //선언과 초기화
+                advance();
+                auto body = parse_expr();
+                if (!body)
+                    return;
+                auto init_capture = Capture<ASTPtr>(std::move(body), var_loc, var_name.size());
+                init_val = static_cast<Constant *>(eval_global_init(init_capture, type_id).first);
+                if (!init_val)
+                    return;
+            }
             //GlobalVariable 소멸자 호출되면 dropAllReferences 때문에 에러남. 그냥 동적 할당 해야됨
-            auto global_var = new GlobalVariable(*zulctx.module, llvm_type, false, GlobalVariable::ExternalLinkage,
+            auto global_var = new GlobalVariable(*zulctx.module, llvm_type, is_const, GlobalVariable::ExternalLinkage,
                                                  init_val, var_name);
             zulctx.global_var_map.emplace(var_name, make_pair(global_var, type_id));
             return;
         }
         //배열인 경우
-        if (size_expr->is_const()) {
-            auto size_val = size_expr->code_gen(zulctx);
-            if (size_val.second == id_int) {
-                int arr_size = static_cast<ConstantInt *>(size_val.first)->getSExtValue();
-                if (arr_size > 0) {
-                    auto arr_type = ArrayType::get(llvm_type, arr_size);
-                    auto global_var = new GlobalVariable(*zulctx.module, arr_type, false,
-                                                         GlobalVariable::ExternalLinkage,
-                                                         ConstantAggregateZero::get(arr_type), var_name);
-                    zulctx.global_var_map.emplace(var_name, make_pair(global_var, type_id));
-                    return;
-                }
-            }
+        auto size_capture = Capture<ASTPtr>(std::move(size_expr), var_loc, var_name.size());
+        ConstEvaluator evaluator{zulctx, true};
+        auto size_val = evaluator.eval(*size_capture.value);
+        if (evaluator.failed() || size_val.second != id_int ||
+            static_cast<ConstantInt *>(size_val.first)->getSExtValue() <= 0) {
+            zulctx.logger.log_error(var_loc, var_name.size(), "배열 크기는 0이 아닌 상수 정수여야 합니다");
+            return;
         }
-        System::logger.log_error(var_loc, var_name.size(), "배열 크기는 0이 아닌 상수 정수여야 합니다");
-
+        auto arr_size = static_cast<ConstantInt *>(size_val.first)->getSExtValue();
+        vector<Capture<ASTPtr>> elements;
+        if (cur_tok == tok_assn) { //선언과 초기화
+            advance();
+            auto [literal, ok] = parse_array_literal();
+            if (!ok)
+                return;
+            elements = std::move(literal);
+        }
+        create_global_array(var_name, var_loc, type_id, arr_size, elements, is_const);
     } else if (cur_tok == tok_assn) { //타입 추론 및 초기화
         advance();
+        if (cur_tok == tok_lbrk) { //리터럴 배열
+            auto [elements, ok] = parse_array_literal();
+            if (ok)
+                create_global_array(var_name, var_loc, -1, static_cast<long long>(elements.size()), elements, is_const);
+            return;
+        }
         auto body = parse_expr();
         if (!body)
             return;
-        if (!body->is_const()) {
-            System::logger.log_error(var_loc, var_name.size(), "대입 구문이 상수식이 아닙니다. 전역 변수는 상수식으로만 초기화 할 수 있습니다.");
+        if (body->is_const() && body->get_typeid() == id_char + TYPE_COUNTS) { //문자열은 글로벌 스트링 그대로 사용
+            auto init_val = body->code_gen(zulctx);
+            auto global_str = static_cast<GlobalVariable *>(init_val.first);
+            //다른 모듈에서 생성되는 함수도 이름으로 찾을 수 있어야 함
+            global_str->setName(var_name);
+            global_str->setLinkage(GlobalVariable::ExternalLinkage);
+            global_str->setUnnamedAddr(GlobalVariable::UnnamedAddr::None);
+            zulctx.global_var_map.emplace(var_name, make_pair(global_str, init_val.second));
             return;
         }
-        auto init_val = body->code_gen(zulctx);
-        GlobalVariable *global_var;
-        if (init_val.second == id_char + TYPE_COUNTS) {
-            global_var = static_cast<GlobalVariable *>(init_val.first);
-        } else {
-            global_var = new GlobalVariable(*zulctx.module, init_val.first->getType(), false,
-                                            GlobalVariable::ExternalLinkage,
-                                            static_cast<Constant *>(init_val.first), var_name);
-        }
+        auto init_capture = Capture<ASTPtr>(std::move(body), var_loc, var_name.size());
+        auto init_val = eval_global_init(init_capture, -1);
+        if (!init_val.first)
+            return;
+        auto global_var = new GlobalVariable(*zulctx.module, init_val.first->getType(), is_const,
+                                             GlobalVariable::ExternalLinkage,
+                                             static_cast<Constant *>(init_val.first), var_name);
         zulctx.global_var_map.emplace(var_name, make_pair(global_var, init_val.second));
     } else {
-        lexer.log_unexpected();
+        if (require_init())
+            lexer.log_unexpected();
+    }
+}
+
+pair<vector<Capture<ASTPtr>>, bool> Parser::parse_array_literal() {
+    vector<Capture<ASTPtr>> elements;
+    if (cur_tok != tok_lbrk) {
+        lexer.log_unexpected("리터럴 배열이 와야 합니다. {가 필요합니다");
+        return {std::move(elements), false};
+    }
+    advance(); // {
+    while (cur_tok != tok_rbrk) {
+        auto elm_start_loc = lexer.get_token_loc();
+        auto elm = parse_expr();
+        if (!elm) {
+            lexer.log_unexpected("배열의 원소가 와야 합니다");
+            while (cur_tok != tok_newline && cur_tok != tok_eof)
+                advance();
+            return {std::move(elements), false};
+        }
+        elements.emplace_back(std::move(elm), elm_start_loc, lexer.get_token_loc().second - elm_start_loc.second);
+        if (cur_tok == tok_comma) {
+            advance();
+        } else if (cur_tok != tok_rbrk) {
+            lexer.log_unexpected("중괄호가 닫히지 않았습니다. }가 필요합니다");
+            while (cur_tok != tok_newline && cur_tok != tok_eof)
+                advance();
+            return {std::move(elements), false};
+        }
+    }
+    advance(); // }
+    return {std::move(elements), true};
+}
+
+ZulValue Parser::eval_global_init(Capture<ASTPtr> &init, int type_id) {
+    ConstEvaluator evaluator{zulctx, true};
+    auto init_val = evaluator.eval(*init.value);
+    if (evaluator.failed()) {
+        zulctx.logger.log_error(init.loc, init.word_size,
+                                {"대입 구문이 상수식이 아닙니다. 전역 변수는 상수식으로만 초기화 할 수 있습니다. ",
+                                 evaluator.fail_reason});
+        return nullzul;
+    }
+    if (type_id == -1)
+        type_id = init_val.second;
+    if (type_id < 0 || type_id >= TYPE_COUNTS) {
+        zulctx.logger.log_error(init.loc, init.word_size, {"\"", get_type_name(type_id), "\" 타입으로 전역 변수를 초기화 할 수 없습니다"});
+        return nullzul;
+    }
+    int init_type = init_val.second;
+    if (!evaluator.cast(init_val, type_id)) {
+        zulctx.logger.log_error(init.loc, init.word_size,
+                                {"대입 연산식의 타입 \"", get_type_name(init_type), "\" 에서 변수의 타입 \"",
+                                 get_type_name(type_id), "\" 로 캐스팅 할 수 없습니다"});
+        return nullzul;
     }
+    return init_val;
+}
+
+void Parser::create_global_array(const string &var_name, pair<int, int> var_loc, int type_id, long long arr_size,
+                                 vector<Capture<ASTPtr>> &elements, bool is_const) {
+    if (static_cast<long long>(elements.size()) > arr_size) {
+        zulctx.logger.log_error(var_loc, var_name.size(), {"배열 원소의 개수가 배열 크기 ", to_string(arr_size), "보다 많습니다"});
+        return;
+    }
+    if (arr_size == 0) {
+        zulctx.logger.log_error(var_loc, var_name.size(), "빈 배열은 만들 수 없습니다");
+        return;
+    }
+    if (type_id == -1) { //원소 타입 추론. 이항 연산처럼 가장 큰 타입으로 맞춤
+        int elm_type = id_bool;
+        for (auto &elm: elements) {
+            elm_type = std::max(elm_type, elm.value->get_typeid());
+        }
+        type_id = elm_type + TYPE_COUNTS;
+    }
+    vector<Constant *> init_vals;
+    init_vals.reserve(arr_size);
+    for (auto &elm: elements) {
+        auto init_val = eval_global_init(elm, type_id - TYPE_COUNTS);
+        if (!init_val.first)
+            return;
+        init_vals.push_back(static_cast<Constant *>(init_val.first));
+    }
+    auto elm_type = get_llvm_type(*zulctx.context, type_id - TYPE_COUNTS);
+    auto arr_type = ArrayType::get(elm_type, arr_size);
+    Constant *arr_init;
+    if (init_vals.empty()) {
+        arr_init = ConstantAggregateZero::get(arr_type);
+    } else {
+        init_vals.resize(arr_size, get_const_zero(elm_type, type_id - TYPE_COUNTS));
+        arr_init = ConstantArray::get(arr_type, init_vals);
+    }
+    auto global_var = new GlobalVariable(*zulctx.module, arr_type, is_const, GlobalVariable::ExternalLinkage,
+                                         arr_init, var_name);
+    global_var->setAlignment(get_array_align(zulctx.module->getDataLayout(), arr_type));
+    zulctx.global_var_map.emplace(var_name, make_pair(global_var, type_id));
 }
 
 tuple<vector<pair<string, int>>, bool, bool> Parser::parse_parameter() {
@@ -242,12 +292,8 @@ tuple<vector<pair<string, int>>, bool, bool> Parser::parse_parameter() {
         if (type_map.contains(name)) { //타입만 명시
             auto type = parse_type(true);
             params.emplace_back("", type.first);
-        } else if (zulctx.global_var_map.contains(name)) {
-            lexer.log_token("이미 존재하는 변수명을 함수 매개변수로 사용할 수 없습니다");
-            err = true;
-            while (cur_tok != tok_comma && cur_tok != tok_rpar && cur_tok != tok_eof)
-                advance();
         } else {
+            param_names.push_back(make_capture(name, lexer));
             advance();
             if (cur_tok != tok_colon) {
                 lexer.log_unexpected("콜론이 와야 합니다");
@@ -256,7 +302,8 @@ tuple<vector<pair<string, int>>, bool, bool> Parser::parse_parameter() {
             advance();
             auto type = parse_type(true);
             params.emplace_back(name, type.first);
-            zulctx.local_var_map.emplace(name, make_pair(nullptr, type.first));
+            //배열 매개변수는 배열의 포인터를 저장하는 지역 변수가 됨
+            symbols.declare_local(name, type.first >= TYPE_COUNTS ? type.first + TYPE_COUNTS : type.first);
         }
         if (cur_tok == tok_rpar)
             break;
@@ -274,37 +321,59 @@ tuple<vector<pair<string, int>>, bool, bool> Parser::parse_parameter() {
     return {params, false, err};
 }
 
-void Parser::parse_func_def(string &func_name, pair<int, int> name_loc, int target_level) {
+bool Parser::parse_func_header() {
+    if (cur_tok != tok_hi)
+        return false;
+    advance();
+    if (cur_tok != tok_identifier) {
+        lexer.log_unexpected("함수 또는 클래스의 이름이 와야 합니다");
+    } else {
+        func_name = lexer.get_word();
+        name_loc = lexer.get_token_loc();
+        advance();
+    }
+    if (cur_tok == tok_colon) { //클래스 정의
+        lexer.log_token("아직 클래스 정의가 지원되지 않습니다");
+        advance();
+        return false;
+    }
+    if (cur_tok != tok_lpar) {
+        lexer.log_unexpected();
+        advance();
+        return false;
+    }
+    advance();
 //---------------------------------전방 선언된 함수인지 확인---------------------------------
     bool exist = false;
-    if (func_proto_map.contains(func_name)) {
+    //내장 함수의 이름은 미리 등록돼 있어서 전방 선언으로 보면 엉뚱한 에러가 나거나, 정의가 내장 함수의 호출로 바뀜
+    bool is_builtin = BuiltinCallAST::builtin_map.contains(func_name) || is_region_func_name(func_name);
+    if (is_builtin) {
+        zulctx.logger.log_error(name_loc, func_name.size(),
+                                {"\"", func_name, "\" 는 내장 함수 이름입니다. 내장 함수와 이름이 겹치는 함수는 정의할 수 없습니다"});
+    } else if (func_proto_map.contains(func_name)) {
         exist = true;
         if (func_proto_map[func_name].has_body) {
-            System::logger.log_error(name_loc, func_name.size(), {"\"", func_name, "\" 함수는 이미 정의된 함수입니다."});
-            Token before = cur_tok;
-            while (true) {
-                if (cur_tok == tok_eof || (before == tok_newline && cur_tok != tok_indent))
-                    break;
-                before = cur_tok;
+            zulctx.logger.log_error(name_loc, func_name.size(), {"\"", func_name, "\" 함수는 이미 정의된 함수입니다."});
+            while (cur_tok != tok_eof)
                 advance();
-            }
-            return;
+            return false;
         }
     }
 //---------------------------------함수 프로토타입 파싱---------------------------------
     auto [params, is_var_arg, err] = parse_parameter();
+    err = err || is_builtin;
     if (exist && !err) { //전방 선언된 함수면 프로토타입이 같은지 확인
         auto &origin_params = func_proto_map[func_name].params;
         if (params.size() != origin_params.size() || func_proto_map[func_name].is_var_arg != is_var_arg) {
-            System::logger.log_error(name_loc, func_name.size(), "전방 선언된 함수와 매개변수 개수가 맞지 않습니다");
+            zulctx.logger.log_error(name_loc, func_name.size(), "전방 선언된 함수와 매개변수 개수가 맞지 않습니다");
             err = true;
         } else {
-            for (int i = 0; i < origin_params.size(); ++i) {
+            for (size_t i = 0; i < origin_params.size(); ++i) {
                 if (origin_params[i].second != params[i].second) {
-                    System::logger.log_error(name_loc, func_name.size(),
-                                             {"전방 선언된 함수와 매개변수의 타입이 일치하지 않습니다. 전방 선언된 함수의 매개변수 타입은 \"",
-                                              get_type_name(origin_params[i].second),
-                                              "\" 이고, 정의된 타입은 \"", get_type_name(params[i].second), "\" 입니다"});
+                    zulctx.logger.log_error(name_loc, func_name.size(),
+                                            {"전방 선언된 함수와 매개변수의 타입이 일치하지 않습니다. 전방 선언된 함수의 매개변수 타입은 \"",
+                                             get_type_name(origin_params[i].second),
+                                             "\" 이고, 정의된 타입은 \"", get_type_name(params[i].second), "\" 입니다"});
                     err = true;
                 }
             }
@@ -316,36 +385,46 @@ void Parser::parse_func_def(string &func_name, pair<int, int> name_loc, int targ
     cur_ret_type = -1;
     if (cur_tok == tok_identifier) {
         auto type_name = lexer.get_word();
-        if (type_map.contains(type_name)) {
-            cur_ret_type = type_map[type_name];
+        if (auto iter = type_map.find(type_name); iter != type_map.end()) {
+            cur_ret_type = iter->second;
         } else {
             lexer.log_token({"\"", type_name, "\" 는 존재하지 않는 타입입니다."});
             err = true;
         }
         advance();
+        if (cur_tok == tok_lsqbrk) { //배열은 매개변수처럼 크기 없이 포인터를 리턴함
+            advance();
+            if (cur_tok == tok_rsqbrk) {
+                advance();
+                if (cur_ret_type != -1)
+                    cur_ret_type += TYPE_COUNTS;
+            } else {
+                lexer.log_unexpected("리턴 타입의 배열은 크기 없이 []로 적어야 합니다");
+                err = true;
+            }
+        }
     }
     if (exist && func_proto_map[func_name].return_type != cur_ret_type) {
-        System::logger.log_error(name_loc, func_name.size(), {"전방 선언된 함수와 반환 타입이 일치하지 않습니다. 전방 선언된 함수의 리턴 타입은 \"",
-                                                              get_type_name(func_proto_map[func_name].return_type),
-                                                              "\" 이고, 정의된 리턴 타입은 \"", get_type_name(cur_ret_type),
-                                                              "\" 입니다"});
+        zulctx.logger.log_error(name_loc, func_name.size(), {"전방 선언된 함수와 반환 타입이 일치하지 않습니다. 전방 선언된 함수의 리턴 타입은 \"",
+                                                             get_type_name(func_proto_map[func_name].return_type),
+                                                             "\" 이고, 정의된 리턴 타입은 \"", get_type_name(cur_ret_type),
+                                                             "\" 입니다"});
         err = true;
     }
     if (func_name == ENTRY_FN_NAME && cur_ret_type != id_int) {
-        System::logger.log_error(name_loc, func_name.size(), {ENTRY_FN_NAME, " 함수의 반환 타입은 반드시 \"수\" 여야 합니다"});
+        zulctx.logger.log_error(name_loc, func_name.size(), {ENTRY_FN_NAME, " 함수의 반환 타입은 반드시 \"수\" 여야 합니다"});
         err = true;
     }
     if (cur_tok == tok_newline) { //함수 선언만
         if (exist) {
-            System::logger.log_error(name_loc, func_name.size(), "이미 선언된 함수를 다시 선언할 수 없습니다");
+            zulctx.logger.log_error(name_loc, func_name.size(), "이미 선언된 함수를 다시 선언할 수 없습니다");
         } else if (!err) {
             func_proto_map.emplace(func_name,
                                    FuncProtoAST(func_name, cur_ret_type, std::move(params), false, is_var_arg));
             func_proto_map[func_name].code_gen(zulctx);
         }
-        zulctx.local_var_map.clear();
         advance();
-        return;
+        return false;
     }
     if (cur_tok != tok_colon) {
         lexer.log_unexpected("콜론이 와야 합니다");
@@ -364,17 +443,39 @@ void Parser::parse_func_def(string &func_name, pair<int, int> name_loc, int targ
             func_proto_map.emplace(func_name,
                                    FuncProtoAST(func_name, cur_ret_type, std::move(params), true, is_var_arg));
         }
+        cur_proto = &func_proto_map[func_name];
     }
-//---------------------------------함수 몸체 파싱---------------------------------
-    auto [func_body, stop_level] = parse_block_body(target_level);
-    if (func_body.empty() && !System::logger.has_error()) {
-        System::logger.log_error(name_loc, func_name.size(),
-                                 "함수의 몸체가 정의되지 않았습니다. 함수 선언만 하기 위해선 콜론을 사용하지 않아야 합니다");
-        return;
+    return true;
+}
+
+void Parser::check_param_names() {
+    //전역 변수는 소스 순서대로 만들어지므로, 여기서는 함수보다 위에 선언된 전역 변수만 보임
+    for (auto &param: param_names) {
+        if (zulctx.global_var_map.contains(param.value))
+            zulctx.logger.log_error(param.loc, param.word_size, "이미 존재하는 변수명을 함수 매개변수로 사용할 수 없습니다");
     }
-    if (!err) {
-        create_func(func_proto_map[func_name], func_body, name_loc, exist);
+}
+
+unique_ptr<FuncDef> Parser::parse_func_body() {
+    auto [func_body, stop_level] = parse_block_body(1);
+    if (cur_tok != tok_eof) { //에러 때문에 몸체가 일찍 끝남. 남은 줄은 다른 스레드의 전역 상태를 건드리지 않도록 건너뜀
+        lexer.log_unexpected();
+        while (cur_tok != tok_eof)
+            advance();
     }
+    if (func_body.empty() && !zulctx.logger.has_error()) {
+        zulctx.logger.log_error(name_loc, func_name.size(),
+                                "함수의 몸체가 정의되지 않았습니다. 함수 선언만 하기 위해선 콜론을 사용하지 않아야 합니다");
+        return nullptr;
+    }
+    if (!cur_proto)
+        return nullptr;
+    cur_proto->param_vars.clear();
+    for (auto &param: cur_proto->params) {
+        cur_proto->param_vars.push_back(param.first.empty() ? nullptr : symbols.local_var_map[param.first]);
+    }
+    return make_unique<FuncDef>(FuncDef{cur_proto, std::move(func_body), name_loc, symbols.ret_count,
+                                        symbols.self_tail_calls, std::move(symbols.local_vars), source});
 }
 
 pair<vector<ASTPtr>, int> Parser::parse_block_body(int target_level) {
@@ -419,23 +520,40 @@ std::pair<ASTPtr, int> Parser::parse_line(int start_level, int target_level) {
     } else if (cur_tok == tok_ij) { //ㅇㅈ?문
         return parse_if(target_level + 1);
     } else if (cur_tok == tok_gg) { //ㅈㅈ문
-        zulctx.ret_count++;
+        if (!symbols.parallel_scopes.empty()) {
+            lexer.log_token("병렬 ㄱㄱ문 안에서는 ㅈㅈ문을 사용할 수 없습니다");
+            while (cur_tok != tok_newline && cur_tok != tok_eof)
+                advance();
+            advance();
+            return {nullptr, -1};
+        }
+        symbols.ret_count++;
         auto cap = make_capture(cur_ret_type, lexer);
         advance();
         auto body = parse_expr();
+        //자기 자신을 호출한 결과를 바로 반환하면 코드 생성에서 함수의 처음으로 돌아가는 반복문으로 만듦
+        if (auto call = dynamic_cast<FuncCallAST *>(body.get()); call && cur_proto && &call->proto == cur_proto)
+            symbols.self_tail_calls++;
         ret = make_unique<FuncRetAST>(std::move(body), std::move(cap));
     } else if (cur_tok == tok_tt) { //ㅌㅌ
-        if (!zulctx.in_loop) {
+        if (!symbols.in_loop) {
             lexer.log_token("ㅌㅌ문을 사용할 수 없습니다. 루프가 아닙니다");
             return {nullptr, -1};
         }
         advance();
         ret = make_unique<ContinueAST>();
     } else if (cur_tok == tok_sg) { //ㅅㄱ
-        if (!zulctx.in_loop) {
+        if (!symbols.in_loop) {
             lexer.log_token("ㅅㄱ문을 사용할 수 없습니다. 루프가 아닙니다");
             return {nullptr, -1};
         }
+        if (symbols.in_parallel_body) {
+            lexer.log_token("병렬 ㄱㄱ문은 ㅅㄱ문으로 빠져나갈 수 없습니다");
+            while (cur_tok != tok_newline && cur_tok != tok_eof)
+                advance();
+            advance();
+            return {nullptr, -1};
+        }
         advance();
         ret = make_unique<BreakAST>();
     } else {
@@ -461,9 +579,9 @@ ASTPtr Parser::parse_expr_start() {
             auto lvalue = parse_lvalue(name_cap.value, name_cap.loc, false);
             if (cur_tok == tok_colon || (tok_assn <= cur_tok && cur_tok <= tok_xor_assn)) {
                 return parse_local_var(std::move(lvalue), std::move(name_cap));
-            } else if (!zulctx.var_exist(name_cap.value)) {
-                System::logger.log_error(name_cap.loc, name_cap.word_size,
-                                         {"\"", name_cap.value, "\" 는 존재하지 않는 변수입니다"});
+            } else if (!symbols.var_exist(name_cap.value)) {
+                zulctx.logger.log_error(name_cap.loc, name_cap.word_size,
+                                        {"\"", name_cap.value, "\" 는 존재하지 않는 변수입니다"});
                 return nullptr;
             }
             left = std::move(lvalue);
@@ -473,7 +591,7 @@ ASTPtr Parser::parse_expr_start() {
     }
     if (!left)
         return nullptr;
-    if (get_op_prec() == op_prec_map[tok_assn]) {
+    if (get_op_prec() == op_prec_map.at(tok_assn)) {
         lexer.log_token("대입 연산을 사용할 수 없습니다. 식의 좌변이 적절한 좌측값이 아닙니다");
         while (cur_tok != tok_newline && cur_tok != tok_eof)
             advance();
@@ -483,38 +601,67 @@ ASTPtr Parser::parse_expr_start() {
 }
 
 ASTPtr Parser::parse_local_var(std::unique_ptr<LvalueAST> lvalue, Capture<std::string> name_cap) {
-    bool is_exist = zulctx.var_exist(name_cap.value);
+    bool is_exist = symbols.var_exist(name_cap.value);
     auto op_cap = make_capture(cur_tok, lexer);
     if (op_cap.value == tok_colon) { //선언
         if (is_exist) {
-            System::logger.log_error(name_cap.loc, name_cap.word_size, "변수가 재정의되었습니다");
+            zulctx.logger.log_error(name_cap.loc, name_cap.word_size, "변수가 재정의되었습니다");
             return nullptr;
         }
         advance();
-        auto type = parse_type(true);
+        auto [type_id, size_expr] = parse_type();
+        if (size_expr) { //배열 선언
+            vector<Capture<ASTPtr>> elements;
+            if (cur_tok == tok_assn) { //선언과 초기화
+                advance();
+                auto [literal, ok] = parse_array_literal();
+                if (!ok)
+                    return nullptr;
+                elements = std::move(literal);
+            }
+            auto size_cap = Capture<ASTPtr>(std::move(size_expr), name_cap.loc, name_cap.word_size);
+            return make_unique<ArrayDeclAST>(std::move(name_cap), symbols, type_id - TYPE_COUNTS,
+                                             std::move(size_cap), std::move(elements));
+        }
         if (cur_tok == tok_assn) { //선언 + 초기화
             advance();
             ASTPtr body = parse_expr();
             if (!body)
                 return nullptr;
-            return make_unique<VariableDeclAST>(std::move(name_cap), zulctx, type.first, std::move(body));
+            return make_unique<VariableDeclAST>(std::move(name_cap), symbols, type_id, std::move(body));
         }
-        return make_unique<VariableDeclAST>(std::move(name_cap), zulctx, type.first);
+        return make_unique<VariableDeclAST>(std::move(name_cap), symbols, type_id);
     }
     //자동추론 + 초기화
     advance();
+    if (!is_exist && op_cap.value == tok_assn && cur_tok == tok_lbrk) { //리터럴 배열
+        auto [elements, ok] = parse_array_literal();
+        if (!ok)
+            return nullptr;
+        auto size_cap = Capture<ASTPtr>(make_unique<ImmIntAST>(static_cast<long long>(elements.size())),
+                                        name_cap.loc, name_cap.word_size);
+        return make_unique<ArrayDeclAST>(std::move(name_cap), symbols, -1, std::move(size_cap), std::move(elements));
+    }
     ASTPtr body = parse_expr();
     if (!body) {
         return nullptr;
     }
     if (!is_exist) {
         if (op_cap.value == tok_assn) {
-            return make_unique<VariableDeclAST>(std::move(name_cap), zulctx, std::move(body));
+            return make_unique<VariableDeclAST>(std::move(name_cap), symbols, std::move(body));
         } else {
-            System::logger.log_error(name_cap.loc, name_cap.word_size, {"\"", name_cap.value, "\" 는 존재하지 않는 변수입니다"});
+            zulctx.logger.log_error(name_cap.loc, name_cap.word_size, {"\"", name_cap.value, "\" 는 존재하지 않는 변수입니다"});
             return nullptr;
         }
     }
+    auto var = dynamic_cast<VariableAST *>(lvalue.get());
+    if (auto subscript = dynamic_cast<SubscriptAST *>(lvalue.get()); subscript && is_vector_type(subscript->target->get_typeid()))
+        var = subscript->target.get(); //벡터의 원소에 대입하면 벡터 변수 전체를 바꿈
+    if (var && var->local && symbols.is_parallel_readonly(var->local)) {
+        zulctx.logger.log_error(name_cap.loc, name_cap.word_size,
+                                "병렬 ㄱㄱ문 안에서는 반복 변수와 바깥의 지역 변수에 대입할 수 없습니다");
+        return nullptr;
+    }
     return make_unique<VariableAssnAST>(std::move(lvalue), std::move(op_cap), std::move(body));
 }
 
@@ -531,7 +678,7 @@ ASTPtr Parser::parse_bin_op(int prev_prec, ASTPtr left) {
 
         if (cur_prec < prev_prec) //연산자가 아니면 자연스럽게 리턴함
             return left;
-        if (cur_prec == op_prec_map[tok_assn]) {
+        if (cur_prec == op_prec_map.at(tok_assn)) {
             lexer.log_token("하나의 식에는 하나의 대입 연산자만 사용할 수 있습니다");
             while (cur_tok != tok_newline && cur_tok != tok_eof)
                 advance();
@@ -584,13 +731,23 @@ ASTPtr Parser::parse_primary() {
     }
 }
 
+void Parser::check_cond_type(const ExprAST &cond, pair<int, int> cond_loc) {
+    //배열과 벡터는 "논리"로 바꿀 수 없음
+    if (cond.get_typeid() > id_float) {
+        zulctx.logger.log_error(cond_loc, lexer.get_token_loc().second - cond_loc.second, {"\"", get_type_name(cond.get_typeid()), "\" 타입은 조건식으로 쓸 수 없습니다"});
+    }
+}
+
 pair<ASTPtr, bool> Parser::parse_if_header() {
     ASTPtr cond;
     bool error = false;
+    auto cond_loc = lexer.get_token_loc();
     cond = parse_expr();
     if (!cond) {
         lexer.log_unexpected("조건식이 필요합니다");
         error = true;
+    } else {
+        check_cond_type(*cond, cond_loc);
     }
     if (cur_tok != tok_colon) {
         lexer.log_unexpected("콜론이 필요합니다");
@@ -605,26 +762,26 @@ std::pair<ASTPtr, int> Parser::parse_if(int target_level) {
     std::vector<CondBodyPair> elif_pair_list;
     std::vector<ASTPtr> else_body;
 //---------------------------------if문 파싱---------------------------------
-    zulctx.scope_stack.emplace();
+    symbols.scope_stack.emplace();
     advance(); //ㅇㅈ? 지나치기
     auto [if_cond, error] = parse_if_header();
     auto [if_body, stop_level] = parse_block_body(target_level);
-    zulctx.remove_scope_vars();
-    if (if_body.empty() && !System::logger.has_error()) {
+    symbols.remove_scope_vars();
+    if (if_body.empty() && !zulctx.logger.has_error()) {
         lexer.log_token("ㅇㅈ?문의 몸체가 정의되지 않았습니다");
         error = true;
     }
     if_pair = {std::move(if_cond), std::move(if_body)};
 //---------------------------------elif문 파싱---------------------------------
     while (stop_level == target_level - 1 && cur_tok == tok_no) {
-        zulctx.scope_stack.emplace();
+        symbols.scope_stack.emplace();
         advance();
         auto [elif_cond, elif_err] = parse_if_header();
         auto [elif_body, level] = parse_block_body(target_level);
-        zulctx.remove_scope_vars();
+        symbols.remove_scope_vars();
         stop_level = level;
         error = error || elif_err;
-        if (elif_body.empty() && !System::logger.has_error()) {
+        if (elif_body.empty() && !zulctx.logger.has_error()) {
             lexer.log_token("ㄴㄴ?문의 몸체가 정의되지 않았습니다");
             error = true;
         }
@@ -633,16 +790,16 @@ std::pair<ASTPtr, int> Parser::parse_if(int target_level) {
 //---------------------------------else문 파싱---------------------------------
     if (stop_level == target_level - 1 && cur_tok == tok_nope) {
         advance();
-        zulctx.scope_stack.emplace();
+        symbols.scope_stack.emplace();
         if (cur_tok != tok_colon) {
             lexer.log_unexpected("콜론이 필요합니다");
             error = true;
         }
         advance();
         auto [body, level] = parse_block_body(target_level);
-        zulctx.remove_scope_vars();
+        symbols.remove_scope_vars();
         stop_level = level;
-        if (body.empty() && !System::logger.has_error()) {
+        if (body.empty() && !zulctx.logger.has_error()) {
             lexer.log_token("ㄴㄴ문의 몸체가 정의되지 않았습니다");
             error = true;
         }
@@ -657,38 +814,247 @@ std::pair<ASTPtr, int> Parser::parse_for(int target_level) {
     ASTPtr init_for = nullptr;
     ASTPtr test_for = nullptr;
     ASTPtr update_for = nullptr;
-    zulctx.scope_stack.emplace(); //스코프 등록
+    symbols.scope_stack.emplace(); //스코프 등록
 //---------------------------------for문 헤더 파싱---------------------------------
     advance(); //ㄱㄱ 지나치기
+    auto expr_loc = lexer.get_token_loc();
     auto expr = parse_expr_start();
     if (cur_tok == tok_semicolon) {
         init_for = std::move(expr);
         advance();
+        auto test_loc = lexer.get_token_loc();
         test_for = parse_expr_start();
+        if (test_for)
+            check_cond_type(*test_for, test_loc);
         if (cur_tok != tok_semicolon) {
             lexer.log_unexpected("ㄱㄱ문에는 세미콜론이 아예 오지 않거나, 2개가 와야 합니다. 세미콜론이 필요합니다");
         }
         advance();
         update_for = parse_expr_start();
     } else if (expr) {
+        check_cond_type(*expr, expr_loc);
         test_for = std::move(expr);
     }
     if (cur_tok != tok_colon) {
         lexer.log_unexpected("콜론이 와야 합니다");
     }
     advance();
+    LoopHints hints;
+    if (cur_tok == tok_identifier)
+        hints = parse_loop_hints();
+    if (hints.parallel)
+        return parse_parallel_for(target_level, std::move(init_for), std::move(test_for), std::move(update_for), hints);
+    if (!hints.reductions.empty()) {
+        auto &reduction = hints.reductions.front();
+        zulctx.logger.log_error(reduction.loc, reduction.word_size, "누적 힌트는 병렬 힌트와 함께 써야 합니다");
+    }
 //---------------------------------for문 몸체 파싱---------------------------------
-    bool in_loop = zulctx.in_loop;
-    zulctx.in_loop = true;
+    bool in_loop = symbols.in_loop;
+    bool in_parallel_body = symbols.in_parallel_body;
+    symbols.in_loop = true;
+    symbols.in_parallel_body = false;
     auto [for_body, stop_level] = parse_block_body(target_level);
-    zulctx.in_loop = in_loop;
-    zulctx.remove_scope_vars();
-    if (for_body.empty() && !System::logger.has_error()) {
+    symbols.in_loop = in_loop;
+    symbols.in_parallel_body = in_parallel_body;
+    symbols.remove_scope_vars();
+    if (for_body.empty() && !zulctx.logger.has_error()) {
         lexer.log_token("ㄱㄱ문의 몸체가 정의되지 않았습니다");
         return {nullptr, stop_level};
     }
     return {make_unique<LoopAST>(std::move(init_for), std::move(test_for), std::move(update_for),
-                                 std::move(for_body)), stop_level};
+                                 std::move(for_body), hints), stop_level};
+}
+
+std::pair<ASTPtr, int> Parser::parse_parallel_for(int target_level, ASTPtr init_for, ASTPtr test_for,
+                                                  ASTPtr update_for, LoopHints hints) {
+    //몸체를 함수로 만들어 스레드들에 반복 범위를 나눠 주려면 들어가기 전에 반복 횟수를 알 수 있어야 함
+    auto decl = dynamic_cast<VariableDeclAST *>(init_for.get());
+    auto index_var = decl && decl->body ? decl->var : nullptr;
+    auto test = dynamic_cast<BinOpAST *>(test_for.get());
+    auto update = dynamic_cast<VariableAssnAST *>(update_for.get());
+    auto is_index = [index_var](ExprAST *ast) {
+        auto var = dynamic_cast<VariableAST *>(ast);
+        return var && var->local == index_var;
+    };
+    bool valid = index_var && index_var->type == id_int && test && is_index(test->left.get()) &&
+                 (test->op.value == tok_lt || test->op.value == tok_lteq) && update &&
+                 update->op.value == tok_add_assn && is_index(update->target.get());
+    if (!valid) {
+        zulctx.logger.log_error(hints.loc, hints.word_size,
+                                "병렬 ㄱㄱ문은 \"ㄱㄱ i = 시작; i < 끝; i += 증가량:\" 꼴이어야 하고, i는 수 타입이어야 합니다");
+    }
+//---------------------------------병렬 for문 몸체 파싱---------------------------------
+    //누적 변수는 스레드마다 따로 있으므로 몸체에서 값을 바꿀 수 있음
+    ParallelScope scope{{}, index_var, {}};
+    for (auto &[name, var]: symbols.local_var_map) {
+        scope.outer_vars.insert(var);
+    }
+    scope.outer_vars.erase(index_var);
+    for (auto &reduction: hints.reductions) {
+        scope.outer_vars.erase(reduction.var);
+        if (reduction.var == index_var)
+            zulctx.logger.log_error(reduction.loc, reduction.word_size, "반복 변수는 누적할 수 없습니다");
+    }
+    symbols.parallel_scopes.push_back(std::move(scope));
+    bool in_loop = symbols.in_loop;
+    bool in_parallel_body = symbols.in_parallel_body;
+    symbols.in_loop = true;
+    symbols.in_parallel_body = true;
+    auto [for_body, stop_level] = parse_block_body(target_level);
+    symbols.in_loop = in_loop;
+    symbols.in_parallel_body = in_parallel_body;
+    auto captures = std::move(symbols.parallel_scopes.back().captures);
+    symbols.parallel_scopes.pop_back();
+    symbols.remove_scope_vars();
+    if (for_body.empty() && !zulctx.logger.has_error()) {
+        lexer.log_token("ㄱㄱ문의 몸체가 정의되지 않았습니다");
+        return {nullptr, stop_level};
+    }
+    if (!valid)
+        return {nullptr, stop_level};
+    Capture<ASTPtr> start(std::move(decl->body), decl->name.loc, decl->name.word_size);
+    Capture<ASTPtr> bound(std::move(test->right), test->op.loc, test->op.word_size);
+    Capture<ASTPtr> step(std::move(update->body), update->op.loc, update->op.word_size);
+    return {make_unique<ParallelLoopAST>(index_var, std::move(start), std::move(bound), test->op.value == tok_lteq,
+                                         std::move(step), std::move(for_body), std::move(captures), hints),
+            stop_level};
+}
+
+LoopHints Parser::parse_loop_hints() {
+    LoopHints hints;
+    hints.loc = lexer.get_token_loc(); //적용되지 않은 힌트는 첫 번째 힌트의 위치로 알림
+    hints.word_size = lexer.get_word().size();
+    while (true) {
+        if (cur_tok != tok_identifier) {
+            lexer.log_unexpected("반복문 힌트가 와야 합니다");
+            break;
+        }
+        auto name = make_capture(lexer.get_word(), lexer);
+        advance();
+        if (name.value == "누적") {
+            if (!parse_reduction_hint(hints) || cur_tok != tok_comma)
+                break;
+            advance();
+            continue;
+        }
+        int value = 0; //값을 적지 않은 힌트
+        if (cur_tok == tok_lpar) {
+            advance();
+            if (cur_tok != tok_int) {
+                lexer.log_unexpected("반복문 힌트의 값은 정수여야 합니다");
+                break;
+            }
+            auto parsed = strtoll(lexer.get_word().c_str(), nullptr, 10);
+            value = static_cast<int>(std::min<long long>(parsed, LOOP_HINT_MAX + 1));
+            auto value_cap = make_capture(lexer.get_word(), lexer);
+            advance();
+            if (cur_tok != tok_rpar) {
+                lexer.log_unexpected("괄호가 닫히지 않았습니다. ')'가 필요합니다");
+                break;
+            }
+            advance();
+            if (value < 1 || value > LOOP_HINT_MAX) {
+                zulctx.logger.log_error(value_cap.loc, value_cap.word_size,
+                                        {"반복문 힌트의 값은 1부터 ", to_string(LOOP_HINT_MAX), "까지만 쓸 수 있습니다"});
+                value = 1;
+            }
+        }
+        if (name.value == "펼치기") {
+            hints.unroll = value;
+        } else if (name.value == "벡터") {
+            if (value > 1 && (value & (value - 1))) {
+                zulctx.logger.log_error(name.loc, name.word_size, "벡터 너비는 2의 거듭제곱이어야 합니다");
+            } else if (zulctx.session.opt_interp || zulctx.session.opt_auto) {
+                zulctx.logger.log_warning(name.loc, name.word_size, "인터프리터로 실행할 때는 반복문을 벡터화하지 않습니다");
+            } else {
+                hints.vector_width = value;
+            }
+        } else if (name.value == "교차") {
+            if (value == 0)
+                zulctx.logger.log_error(name.loc, name.word_size, "교차 힌트에는 한 번에 실행할 반복 횟수를 적어야 합니다");
+            else if (zulctx.session.opt_interp || zulctx.session.opt_auto)
+                zulctx.logger.log_warning(name.loc, name.word_size, "인터프리터로 실행할 때는 반복문을 교차 실행하지 않습니다");
+            else
+                hints.interleave = value;
+        } else if (name.value == "분배") {
+            hints.distribute = true;
+        } else if (name.value == "병렬") {
+            if (value != 0)
+                zulctx.logger.log_error(name.loc, name.word_size, "병렬 힌트에는 값을 적을 수 없습니다");
+            hints.parallel = true;
+        } else {
+            zulctx.logger.log_error(name.loc, name.word_size,
+                                    {"\"", name.value, "\" 는 알 수 없는 반복문 힌트입니다. 펼치기, 벡터, 교차, 분배, 병렬, 누적 중 하나여야 합니다"});
+        }
+        if (cur_tok != tok_comma)
+            break;
+        advance();
+    }
+    if (cur_tok != tok_newline && cur_tok != tok_eof) {
+        lexer.log_unexpected();
+        while (cur_tok != tok_newline && cur_tok != tok_eof)
+            advance();
+    }
+    return hints;
+}
+
+//누적(연산자: 변수, ...)
+bool Parser::parse_reduction_hint(LoopHints &hints) {
+    if (cur_tok != tok_lpar) {
+        lexer.log_unexpected("누적 힌트에는 \"(연산자: 변수)\"를 적어야 합니다");
+        return false;
+    }
+    advance();
+    auto op = make_capture(cur_tok, lexer);
+    if (cur_tok == tok_identifier && lexer.get_word() == "최소") {
+        op.value = tok_lt;
+    } else if (cur_tok == tok_identifier && lexer.get_word() == "최대") {
+        op.value = tok_gt;
+    } else if (cur_tok != tok_add && cur_tok != tok_mul && cur_tok != tok_bitand && cur_tok != tok_bitor &&
+               cur_tok != tok_bitxor) {
+        lexer.log_unexpected("누적 연산자는 +, *, &, |, ^, 최소, 최대 중 하나여야 합니다");
+        return false;
+    }
+    advance();
+    if (cur_tok != tok_colon) {
+        lexer.log_unexpected("콜론이 와야 합니다");
+        return false;
+    }
+    advance();
+    while (true) {
+        if (cur_tok != tok_identifier) {
+            lexer.log_unexpected("누적할 변수가 와야 합니다");
+            return false;
+        }
+        auto name = make_capture(lexer.get_word(), lexer);
+        advance();
+        auto iter = symbols.local_var_map.find(name.value);
+        if (iter == symbols.local_var_map.end()) {
+            zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 는 ㄱㄱ문 바깥의 지역 변수가 아닙니다"});
+        } else if (auto var = iter->second; var->type < 0 || var->type >= TYPE_COUNTS) {
+            zulctx.logger.log_error(name.loc, name.word_size, "배열은 누적할 수 없습니다");
+        } else if (var->type == id_region) {
+            zulctx.logger.log_error(name.loc, name.word_size, "영역은 누적할 수 없습니다");
+        } else if (is_vector_type(var->type)) {
+            zulctx.logger.log_error(name.loc, name.word_size, "벡터는 누적할 수 없습니다. 원소를 하나씩 누적하세요");
+        } else if (symbols.is_parallel_readonly(var)) {
+            zulctx.logger.log_error(name.loc, name.word_size, "바깥 병렬 ㄱㄱ문의 변수는 누적할 수 없습니다");
+        } else if (std::any_of(hints.reductions.begin(), hints.reductions.end(),
+                               [var](const Reduction &reduction) { return reduction.var == var; })) {
+            zulctx.logger.log_error(name.loc, name.word_size, {"\"", name.value, "\" 변수를 두 번 누적할 수 없습니다"});
+        } else {
+            hints.reductions.push_back({op.value, var, op.loc, op.word_size});
+        }
+        if (cur_tok != tok_comma)
+            break;
+        advance();
+    }
+    if (cur_tok != tok_rpar) {
+        lexer.log_unexpected("괄호가 닫히지 않았습니다. ')'가 필요합니다");
+        return false;
+    }
+    advance();
+    return true;
 }
 
 ASTPtr Parser::parse_identifier() {
@@ -701,15 +1067,35 @@ ASTPtr Parser::parse_identifier() {
 }
 
 ASTPtr Parser::parse_func_call(string &name, pair<int, int> name_loc) {
-    if (!func_proto_map.contains(name)) {
-        System::logger.log_error(name_loc, name.size(), {"\"", name, "\" 는 존재하지 않는 함수입니다"});
+    //수4(...)처럼 벡터 타입 이름으로 부르면 벡터를 만듦
+    auto type_iter = type_map.find(name);
+    int vector_type = type_iter != type_map.end() && is_vector_type(type_iter->second) ? type_iter->second : -1;
+    auto proto_iter = func_proto_map.find(name);
+    if (proto_iter == func_proto_map.end() && vector_type == -1) {
+        zulctx.logger.log_error(name_loc, name.size(), {"\"", name, "\" 는 존재하지 않는 함수입니다"});
         return nullptr;
     }
     advance(); //(
     vector<Capture<ASTPtr>> args;
     while (true) {
         if (cur_tok == tok_rpar) {
-            auto &proto = func_proto_map[name];
+            if (vector_type != -1 || VectorOpAST::is_vector_op(name)) {
+                advance(); // )
+                return make_unique<VectorOpAST>(Capture(name, name_loc, static_cast<unsigned>(name.size())), vector_type,
+                                                std::move(args));
+            }
+            if (auto builtin = BuiltinCallAST::builtin_map.find(name); builtin != BuiltinCallAST::builtin_map.end()) {
+                if (builtin->second.arg_count != args.size()) {
+                    lexer.log_token({"인자 개수가 맞지 않습니다. ", "\"", name, "\" 함수의 인자 개수는 ",
+                                     to_string(builtin->second.arg_count), "개 입니다."});
+                    advance();
+                    return nullptr;
+                }
+                advance(); // )
+                return make_unique<BuiltinCallAST>(Capture(name, name_loc, static_cast<unsigned>(name.size())),
+                                                   std::move(args));
+            }
+            auto &proto = proto_iter->second;
             auto param_cnt = proto.params.size();
             if (!proto.is_var_arg && param_cnt != args.size()) {
                 lexer.log_token({"인자 개수가 맞지 않습니다. ", "\"", name, "\" 함수의 인자 개수는 ", to_string(param_cnt), "개 입니다."});
@@ -724,6 +1110,12 @@ ASTPtr Parser::parse_func_call(string &name, pair<int, int> name_loc) {
         if (!arg)
             return nullptr;
         args.emplace_back(std::move(arg), arg_start_loc, lexer.get_token_loc().second - arg_start_loc.second);
+        //입 함수는 인자에 값을 씀
+        auto var = dynamic_cast<VariableAST *>(args.back().value.get());
+        if (name == STDIN_NAME && var && var->local && symbols.is_parallel_readonly(var->local)) {
+            zulctx.logger.log_error(args.back().loc, args.back().word_size,
+                                    "병렬 ㄱㄱ문 안에서는 반복 변수와 바깥의 지역 변수에 입력받을 수 없습니다");
+        }
         if (cur_tok == tok_comma) {
             advance();
         } else if (cur_tok == tok_eof) {
@@ -735,8 +1127,8 @@ ASTPtr Parser::parse_func_call(string &name, pair<int, int> name_loc) {
 }
 
 unique_ptr<LvalueAST> Parser::parse_lvalue(string &name, pair<int, int> name_loc, bool check_exist) {
-    if (check_exist && !zulctx.var_exist(name)) {
-        System::logger.log_error(name_loc, name.size(), {"\"", name, "\" 는 존재하지 않는 변수입니다"});
+    if (check_exist && !symbols.var_exist(name)) {
+        zulctx.logger.log_error(name_loc, name.size(), {"\"", name, "\" 는 존재하지 않는 변수입니다"});
         if (cur_tok == tok_lsqbrk)
             parse_subscript();
         return nullptr;
@@ -747,10 +1139,15 @@ unique_ptr<LvalueAST> Parser::parse_lvalue(string &name, pair<int, int> name_loc
         auto index = parse_subscript();
         if (!index)
             return nullptr;
-        return make_unique<SubscriptAST>(make_unique<VariableAST>(name),
-                                         Capture<ASTPtr>(std::move(index), loc, size));
+        auto target = make_unique<VariableAST>(name, symbols);
+        if (target->local)
+            symbols.use_local(target->local);
+        return make_unique<SubscriptAST>(std::move(target), Capture<ASTPtr>(std::move(index), loc, size));
     }
-    return make_unique<VariableAST>(name);
+    auto var = make_unique<VariableAST>(name, symbols);
+    if (var->local)
+        symbols.use_local(var->local);
+    return var;
 }
 
 ASTPtr Parser::parse_subscript() {
@@ -767,34 +1164,44 @@ ASTPtr Parser::parse_subscript() {
     return ret;
 }
 
-pair<int, ASTPtr> Parser::parse_type(bool no_arr) {
+pair<int, ASTPtr> Parser::parse_type(bool is_param) {
     pair<int, ASTPtr> null{-1, nullptr};
     if (cur_tok != tok_identifier) {
         lexer.log_unexpected("타입 이름이 와야 합니다");
         advance();
         return null;
     }
-    auto type_name = lexer.get_word();
-    if (!type_map.contains(type_name)) {
+    auto type_iter = type_map.find(lexer.get_word());
+    if (type_iter == type_map.end()) {
         lexer.log_unexpected("존재하지 않는 타입입니다");
         advance();
         return null;
     }
-    int type_id = type_map[type_name];
+    int type_id = type_iter->second;
     advance();
     if (cur_tok != tok_lsqbrk) {
         return {type_id, nullptr};
     }
-    if (no_arr) {
-        lexer.log_token("배열 타입은 전역 변수만 가능합니다");
-        while (cur_tok == tok_lsqbrk)
-            parse_subscript(); //[]먹기
-        return {type_id, nullptr};
+    if (is_param) { //매개변수는 배열의 포인터를 받으므로 크기를 적지 않음
+        advance();
+        if (cur_tok != tok_rsqbrk) {
+            lexer.log_unexpected("매개변수의 배열 타입은 크기 없이 []로 적어야 합니다");
+            while (cur_tok != tok_rsqbrk && cur_tok != tok_rpar && cur_tok != tok_newline && cur_tok != tok_eof)
+                advance();
+        }
+        if (cur_tok == tok_rsqbrk)
+            advance();
+        if (cur_tok == tok_lsqbrk) {
+            lexer.log_token("다차원 배열은 지원되지 않습니다");
+            while (cur_tok == tok_lsqbrk)
+                parse_subscript(); //[]먹기
+        }
+        return {type_id + TYPE_COUNTS, nullptr};
     }
     auto brk_loc = lexer.get_token_loc();
     auto brk_body = parse_subscript();
     if (!brk_body) {
-        System::logger.log_error(brk_loc, 1, "배열 크기를 명시해야 합니다");
+        zulctx.logger.log_error(brk_loc, 1, "배열 크기를 명시해야 합니다");
         return {type_id, nullptr};
     }
     if (cur_tok == tok_lsqbrk) {
@@ -832,6 +1239,7 @@ ASTPtr Parser::parse_num() {
     char *end_ptr;
     Guard g{[this]() { this->advance(); }};
 
+    errno = 0;
     if (cur_tok == tok_int) {
         auto result = strtoll(num_word.c_str(), &end_ptr, 10);
         if (errno != 0) {
@@ -861,7 +1269,7 @@ ASTPtr Parser::parse_str() {
     int ed = lexer.get_line_index();
     auto str = lexer.get_line_substr(st, ed);
     stringstream ss;
-    for (int i = 0; i < str.size(); ++i) {
+    for (size_t i = 0; i < str.size(); ++i) {
         if (str[i] == '\\' && i + 1 < str.size() && str[i + 1] == 'n') {
             ss << '\n';
             i++;
@@ -897,69 +1305,19 @@ ASTPtr Parser::parse_char() {
     return make_unique<ImmCharAST>(str[0]);
 }
 
-void Parser::create_func(FuncProtoAST &proto, const vector<ASTPtr> &body, std::pair<int, int> name_loc, bool exist) {
-    llvm::Function *llvm_func;
-    if (exist) {
-        llvm_func = zulctx.module->getFunction(proto.name);
-    } else {
-        llvm_func = proto.code_gen(zulctx);
-    }
-    auto entry_block = BasicBlock::Create(*zulctx.context, "entry", llvm_func);
-    zulctx.builder.SetInsertPoint(entry_block);
-    llvm::IRBuilder<> entry_builder(entry_block, entry_block->begin());
-
-    if (zulctx.ret_count > 1) {
-        if (proto.return_type != -1)
-            zulctx.return_var = entry_builder.CreateAlloca(get_llvm_type(*zulctx.context, proto.return_type), nullptr,
-                                                           "ret");
-        zulctx.return_block = BasicBlock::Create(*zulctx.context, "func_ret");
-    }
-
-    int i = 0;
-    for (auto &arg: llvm_func->args()) {
-        auto alloca_val = entry_builder.CreateAlloca(arg.getType(), nullptr, proto.params[i].first);
-        zulctx.builder.CreateStore(&arg, alloca_val);
-        zulctx.local_var_map[proto.params[i].first] = make_pair(alloca_val, proto.params[i].second);
-        i++;
-    }
-
-    for (auto &ast: body) {
-        auto code = ast->code_gen(zulctx).second;
-        if (code == id_interrupt)
-            break;
-    }
-
-    auto cur_block = zulctx.builder.GetInsertBlock();
-    if (zulctx.ret_count == 0 || cur_block->empty() ||
-        (!isa<BranchInst>(cur_block->back()) && !isa<ReturnInst>(cur_block->back()))) {
-        if (proto.name == ENTRY_FN_NAME) {
-            if (zulctx.ret_count > 1)
-                zulctx.builder.CreateBr(zulctx.return_block);
-            else
-                zulctx.builder.CreateRet(ConstantInt::get(Type::getInt64Ty(*zulctx.context), 0, true));
-        } else if (proto.return_type == -1) {
-            zulctx.builder.CreateRetVoid();
-        } else if (!remove_all_pred(cur_block)) {
-            System::logger.log_error(name_loc, proto.name.size(),
-                                     {"\"", proto.name, "\" 함수의 리턴 타입은 \"", get_type_name(proto.return_type),
-                                      "\" 입니다. ㅈㅈ구문이 필요합니다"});
-        }
-    }
-    if (zulctx.ret_count > 1) {
-        llvm_func->insert(llvm_func->end(), zulctx.return_block);
-        zulctx.builder.SetInsertPoint(zulctx.return_block);
-        if (proto.return_type == -1) {
-            zulctx.builder.CreateRetVoid();
-        } else {
-            auto ret = zulctx.builder.CreateLoad(zulctx.return_var->getAllocatedType(), zulctx.return_var);
-            zulctx.builder.CreateRet(ret);
-        }
-    }
-    zulctx.local_var_map.clear();
-    zulctx.ret_count = 0;
-}
+const std::map<std::string, int> Parser::type_map = {
+        {"논리", 0},
+        {"글자", 1},
+        {"수",  2},
+        {"실수", 3},
+        {"수4", id_int4},
+        {"수8", id_int8},
+        {"실수4", id_float4},
+        {"실수8", id_float8},
+        {"영역", id_region},
+};
 
-std::unordered_map<Token, int> Parser::op_prec_map = {
+const std::unordered_map<Token, int> Parser::op_prec_map = {
         {tok_bitnot,      120}, // ~
         {tok_not,         120}, // !
 
@@ -13,6 +13,7 @@
 #include <memory>
 #include <vector>
 #include <tuple>
+#include <deque>
 
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/LLVMContext.h"
@@ -20,19 +21,35 @@
 #include "llvm/TargetParser/Host.h"
 
 #include "ZulContext.h"
-#include "System.h"
 #include "Utility.h"
 #include "Lexer.h"
 #include "AST.h"
+#include "ConstEval.h"
+#include "CodeGen.h"
 
+//최상위 단위(함수 정의 하나 또는 전역 변수 하나) 하나를 파싱하는 파서
+//함수 프로토타입은 먼저 모두 파싱해 두고, 함수 몸체는 나중에 다른 스레드에서 파싱할 수 있음
 class Parser {
 public:
-    Parser(const std::string &source_name, const std::string &target_triple);
+    Parser(std::string_view source, int first_line, ZulContext &zulctx,
+           std::map<std::string, FuncProtoAST> &func_proto_map);
 
-    std::pair<std::unique_ptr<llvm::LLVMContext>, std::unique_ptr<llvm::Module>> parse();
+    bool parse_func_header();
+
+    void check_param_names();
+
+    std::unique_ptr<FuncDef> parse_func_body();
+
+    void parse_top_level();
 
 private:
-    ZulContext zulctx;
+    ZulContext &zulctx;
+
+    std::map<std::string, FuncProtoAST> &func_proto_map;
+
+    SymbolTable symbols;
+
+    std::string_view source; //이 파서가 맡은 최상위 단위의 소스
 
     Lexer lexer;
 
@@ -40,11 +57,22 @@ private:
 
     int cur_ret_type = -1;
 
-    void parse_top_level();
+    std::string func_name;
+
+    std::pair<int, int> name_loc;
 
-    void parse_global_var();
+    FuncProtoAST *cur_proto = nullptr; //헤더에 에러가 있으면 nullptr
 
-    void parse_func_def(std::string &func_name, std::pair<int, int> name_loc, int target_level);
+    std::vector<Capture<std::string>> param_names;
+
+    void parse_global_var(bool is_const = false);
+
+    std::pair<std::vector<Capture<ASTPtr>>, bool> parse_array_literal();
+
+    ZulValue eval_global_init(Capture<ASTPtr> &init, int type_id);
+
+    void create_global_array(const std::string &var_name, std::pair<int, int> var_loc, int type_id, long long arr_size,
+                             std::vector<Capture<ASTPtr>> &elements, bool is_const);
 
     std::tuple<std::vector<std::pair<std::string, int>>, bool, bool> parse_parameter();
 
@@ -62,12 +90,22 @@ private:
 
     ASTPtr parse_primary();
 
+    //조건식의 타입이 "논리"로 바꿀 수 있는 타입인지 확인함
+    void check_cond_type(const ExprAST &cond, std::pair<int, int> cond_loc);
+
     std::pair<ASTPtr, bool> parse_if_header();
 
     std::pair<ASTPtr, int> parse_if(int target_level);
 
     std::pair<ASTPtr, int> parse_for(int target_level);
 
+    std::pair<ASTPtr, int> parse_parallel_for(int target_level, ASTPtr init_for, ASTPtr test_for, ASTPtr update_for,
+                                              LoopHints hints);
+
+    LoopHints parse_loop_hints();
+
+    bool parse_reduction_hint(LoopHints &hints);
+
     ASTPtr parse_identifier();
 
     ASTPtr parse_func_call(std::string &name, std::pair<int, int> name_loc);
@@ -76,7 +114,7 @@ private:
 
     ASTPtr parse_subscript();
 
-    std::pair<int, ASTPtr> parse_type(bool no_arr = false);
+    std::pair<int, ASTPtr> parse_type(bool is_param = false);
 
     ASTPtr parse_unary_op();
 
@@ -88,27 +126,14 @@ private:
 
     ASTPtr parse_char();
 
-    void create_func(FuncProtoAST &proto, const std::vector<ASTPtr> &body, std::pair<int, int> name_loc, bool exist);
 
     void advance();
 
     int get_op_prec();
 
-    std::map<std::string, FuncProtoAST> func_proto_map = {
-            {STDIN_NAME, FuncProtoAST(STDIN_NAME, -1, {}, false, true)},
-            {STDOUT_NAME, FuncProtoAST(STDOUT_NAME, -1, {}, false, true)},
-            {"scanf", FuncProtoAST("scanf", id_int, {{"", id_char + TYPE_COUNTS}}, false, true)},
-            {"printf", FuncProtoAST("printf", id_int, {{"", id_char + TYPE_COUNTS}}, false, true)},
-    };
-
-    std::map<std::string, int> type_map = {
-            {"논리", 0},
-            {"글자", 1},
-            {"수",  2},
-            {"실수", 3},
-    };
-
-    static std::unordered_map<Token, int> op_prec_map; //연산자 우선순위 맵
+    static const std::map<std::string, int> type_map;
+
+    static const std::unordered_map<Token, int> op_prec_map; //연산자 우선순위 맵
 };
 
 
@@ -0,0 +1,823 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Runtime.h"
+
+#define ARENA_CHUNK_SIZE (1 << 20) //아레나가 한 번에 할당받는 최소 크기
+#define PARALLEL_SPLITS_PER_THREAD 8 //병렬 ㄱㄱ문을 스레드 하나당 이 정도 개수의 조각까지 나눔
+#define PREFIX_SUM_SERIAL_LIMIT (1 << 16) //이보다 짧은 배열의 누적합은 한 스레드에서 계산함
+#define INPUT_BLOCK_SIZE (1 << 16) //입 함수가 표준 입력을 한 번에 읽는 크기
+#define MAX_MANTISSA_DIGITS 19 //uint64_t에 넘치지 않고 모을 수 있는 십진수 자릿수
+#define MAX_FIXED_FLOAT_CHARS 330 //지수 표기 없이 쓴 double의 최대 길이. 가장 작은 비정규 수가 소수점 아래 324자리
+
+namespace {
+    //컴파일러의 크래시 핸들러가 잡지 않도록 abort 대신 바로 종료함. 프로그램이 출력한 내용은 먼저 내보냄
+    [[noreturn]] void runtime_error(const char *msg) {
+        std::fflush(nullptr);
+        std::fprintf(stderr, "줄랭 런타임 에러: %s\n", msg);
+        std::_Exit(1);
+    }
+
+    struct ArenaChunk {
+        char *begin;
+        size_t size;
+    };
+
+    //청크 목록과 현재 청크 안의 위치만 가지는 bump 할당기. 해제하면 위치만 되돌리고 청크는 그대로 재사용함
+    struct Arena {
+        std::vector<ArenaChunk> chunks;
+        size_t current = 0;
+        char *top = nullptr;
+
+        ~Arena() {
+            for (auto &chunk: chunks) {
+                ::operator delete(chunk.begin, std::align_val_t{ARENA_ALIGN});
+            }
+        }
+
+        void *alloc(size_t bytes) {
+            bytes = (bytes + ARENA_ALIGN - 1) & ~static_cast<size_t>(ARENA_ALIGN - 1);
+            if (!chunks.empty()) {
+                auto &chunk = chunks[current];
+                if (bytes <= static_cast<size_t>(chunk.begin + chunk.size - top)) {
+                    auto ret = top;
+                    top += bytes;
+                    return ret;
+                }
+                if (current + 1 < chunks.size() && chunks[current + 1].size >= bytes) {
+                    ++current;
+                    top = chunks[current].begin + bytes;
+                    return chunks[current].begin;
+                }
+                //다음 청크들이 너무 작으면 버리고 큰 청크를 새로 받음
+                for (auto i = current + 1; i < chunks.size(); ++i) {
+                    ::operator delete(chunks[i].begin, std::align_val_t{ARENA_ALIGN});
+                }
+                chunks.resize(current + 1);
+            }
+            auto size = std::max<size_t>(bytes, ARENA_CHUNK_SIZE);
+            auto memory = static_cast<char *>(::operator new(size, std::align_val_t{ARENA_ALIGN}, std::nothrow));
+            if (!memory)
+                runtime_error("배열을 할당할 메모리가 부족합니다");
+            chunks.push_back({memory, size});
+            current = chunks.size() - 1;
+            top = memory + bytes;
+            return memory;
+        }
+
+        void release(char *mark) {
+            if (!mark) {
+                current = 0;
+                top = chunks.empty() ? nullptr : chunks.front().begin;
+                return;
+            }
+            while (current > 0 && !(chunks[current].begin <= mark && mark <= chunks[current].begin + chunks[current].size))
+                --current;
+            top = mark;
+        }
+    };
+
+    thread_local Arena arena;
+
+    struct Region {
+        std::mutex mutex;
+        Arena arena;
+    };
+
+    using ParallelBody = void (*)(void *ctx, int64_t begin, int64_t end, void *partial);
+    using CombineFunc = void (*)(void *dst, const void *src);
+
+    struct IterRange {
+        int64_t begin;
+        int64_t end;
+    };
+
+    //스레드마다 하나씩 있는 작업 덱. 주인은 뒤에서 꺼내 쓰고, 일이 없는 스레드는 앞에서 훔쳐 감
+    //앞쪽에는 먼저 나눈 큰 범위가 있으므로 한 번 훔쳐 가면 한동안 다시 훔칠 필요가 없음
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<IterRange> ranges;
+
+        void push_back(IterRange range) {
+            std::lock_guard lock(mutex);
+            ranges.push_back(range);
+        }
+
+        bool pop_back(IterRange &range) {
+            std::lock_guard lock(mutex);
+            if (ranges.empty())
+                return false;
+            range = ranges.back();
+            ranges.pop_back();
+            return true;
+        }
+
+        bool steal_front(IterRange &range) {
+            std::lock_guard lock(mutex);
+            if (ranges.empty())
+                return false;
+            range = ranges.front();
+            ranges.pop_front();
+            return true;
+        }
+    };
+
+    thread_local bool in_parallel = false; //스레드 풀의 작업을 실행 중인지. 안쪽의 병렬 ㄱㄱ문은 그 스레드에서 그대로 실행함
+
+    //병렬 ㄱㄱ문을 실행하는 work-stealing 스레드 풀. 호출한 스레드도 0번 작업자로 참여함
+    //처음에는 반복 범위를 작업자 수만큼 나눠 각자의 덱에 넣고, 각 작업자는 자기 범위를 반씩 쪼개 뒤쪽 절반을 덱에 남겨 두면서
+    //조각이 grain 이하가 될 때까지 내려간 뒤 실행함. 자기 덱이 비면 다른 작업자의 덱에서 가장 큰 조각을 훔쳐 옴
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned thread_count) {
+            for (unsigned i = 0; i < thread_count; ++i)
+                queues.push_back(std::make_unique<WorkQueue>());
+            for (unsigned i = 1; i < thread_count; ++i)
+                workers.emplace_back(&ThreadPool::worker_main, this, i);
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto &worker: workers)
+                worker.join();
+        }
+
+        [[nodiscard]] unsigned size() const {
+            return static_cast<unsigned>(queues.size());
+        }
+
+        //partials가 있으면 i번 작업자는 partials + i * partial_stride의 누적값으로 몸체를 실행함
+        void run(ParallelBody func, void *func_ctx, int64_t count, char *partials = nullptr, size_t stride = 0) {
+            std::lock_guard run_lock(run_mutex); //여러 스레드에서 호출하면 하나씩 실행함
+            body = func;
+            ctx = func_ctx;
+            partial_base = partials;
+            partial_stride = stride;
+            grain = std::max<int64_t>(1, count / (size() * PARALLEL_SPLITS_PER_THREAD));
+            remaining.store(count, std::memory_order_relaxed);
+            for (unsigned i = 0; i < size(); ++i) {
+                IterRange range{count * i / size(), count * (i + 1) / size()};
+                if (range.begin < range.end)
+                    queues[i]->push_back(range);
+            }
+            {
+                std::lock_guard lock(mutex);
+                busy_workers = static_cast<unsigned>(workers.size());
+                ++generation;
+            }
+            wake.notify_all();
+
+            in_parallel = true;
+            work(0);
+            in_parallel = false;
+            //모든 작업자가 이번 작업에서 손을 뗀 뒤에 돌아가야 다음 작업의 body, ctx를 바꿀 수 있음
+            std::unique_lock lock(mutex);
+            done.wait(lock, [this] { return busy_workers == 0; });
+        }
+
+    private:
+        std::vector<std::unique_ptr<WorkQueue>> queues; //작업자마다 하나. 0번은 run을 호출한 스레드
+        std::vector<std::thread> workers;
+        std::mutex run_mutex;
+        std::mutex mutex; //generation, busy_workers, stopping
+        std::condition_variable wake;
+        std::condition_variable done;
+        uint64_t generation = 0;
+        unsigned busy_workers = 0;
+        bool stopping = false;
+        ParallelBody body = nullptr;
+        void *ctx = nullptr;
+        char *partial_base = nullptr;
+        size_t partial_stride = 0;
+        int64_t grain = 1;
+        std::atomic<int64_t> remaining{0}; //아직 끝나지 않은 반복 수
+
+        void worker_main(unsigned self) {
+            in_parallel = true;
+            uint64_t seen = 0;
+            while (true) {
+                {
+                    std::unique_lock lock(mutex);
+                    wake.wait(lock, [&] { return stopping || generation != seen; });
+                    if (stopping)
+                        return;
+                    seen = generation;
+                }
+                work(self);
+                std::lock_guard lock(mutex);
+                if (--busy_workers == 0)
+                    done.notify_one();
+            }
+        }
+
+        bool steal(unsigned self, IterRange &range) {
+            for (unsigned i = 1; i < size(); ++i) {
+                if (queues[(self + i) % size()]->steal_front(range))
+                    return true;
+            }
+            return false;
+        }
+
+        void work(unsigned self) {
+            auto &queue = *queues[self];
+            auto partial = partial_base ? partial_base + self * partial_stride : nullptr;
+            while (remaining.load(std::memory_order_acquire) > 0) {
+                IterRange range{};
+                if (!queue.pop_back(range) && !steal(self, range)) {
+                    std::this_thread::yield(); //남은 조각은 다른 작업자가 실행 중임
+                    continue;
+                }
+                while (range.end - range.begin > grain) {
+                    auto mid = range.begin + (range.end - range.begin) / 2;
+                    queue.push_back({mid, range.end});
+                    range.end = mid;
+                }
+                body(ctx, range.begin, range.end, partial);
+                remaining.fetch_sub(range.end - range.begin, std::memory_order_acq_rel);
+            }
+        }
+    };
+
+    std::mutex pool_mutex;
+    std::unique_ptr<ThreadPool> pool;
+    int64_t requested_threads = 0;
+
+    unsigned get_thread_count() {
+        if (requested_threads > 0)
+            return static_cast<unsigned>(requested_threads);
+        if (auto env = std::getenv("ZUL_THREADS"); env && std::atoi(env) > 0)
+            return static_cast<unsigned>(std::atoi(env));
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    ThreadPool &get_pool() {
+        std::lock_guard lock(pool_mutex);
+        if (!pool)
+            pool = std::make_unique<ThreadPool>(get_thread_count());
+        return *pool;
+    }
+
+    //배열을 블록으로 나눠 1) 블록마다 합을 구하고 2) 블록 합의 누적합을 한 스레드에서 구한 뒤 3) 각 블록을 그 값부터 누적함
+    template<typename T>
+    struct PrefixSum {
+        T *data;
+        int64_t count;
+        int64_t block_size;
+        std::vector<T> block_sums;
+
+        //줄랭의 정수 덧셈처럼 넘치면 감쌈
+        static T add(T lhs, T rhs) {
+            if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(static_cast<uint64_t>(lhs) + static_cast<uint64_t>(rhs));
+            else
+                return lhs + rhs;
+        }
+
+        static void sum_blocks(void *raw, int64_t begin, int64_t end, void *) {
+            auto &self = *static_cast<PrefixSum *>(raw);
+            for (auto block = begin; block < end; ++block) {
+                T sum = 0;
+                for (auto i = block * self.block_size; i < std::min(self.count, (block + 1) * self.block_size); ++i)
+                    sum = add(sum, self.data[i]);
+                self.block_sums[block] = sum;
+            }
+        }
+
+        static void scan_blocks(void *raw, int64_t begin, int64_t end, void *) {
+            auto &self = *static_cast<PrefixSum *>(raw);
+            for (auto block = begin; block < end; ++block) {
+                T sum = self.block_sums[block];
+                for (auto i = block * self.block_size; i < std::min(self.count, (block + 1) * self.block_size); ++i) {
+                    sum = add(sum, self.data[i]);
+                    self.data[i] = sum;
+                }
+            }
+        }
+
+        static void serial(T *data, int64_t count) {
+            T sum = 0;
+            for (int64_t i = 0; i < count; ++i) {
+                sum = add(sum, data[i]);
+                data[i] = sum;
+            }
+        }
+
+        static void run(T *data, int64_t count) {
+            if (count <= 0)
+                return;
+            if (in_parallel || count < PREFIX_SUM_SERIAL_LIMIT) {
+                serial(data, count);
+                return;
+            }
+            auto &thread_pool = get_pool();
+            if (thread_pool.size() == 1) {
+                serial(data, count);
+                return;
+            }
+            auto blocks = static_cast<int64_t>(thread_pool.size()) * PARALLEL_SPLITS_PER_THREAD;
+            auto block_size = (count + blocks - 1) / blocks;
+            blocks = (count + block_size - 1) / block_size;
+            PrefixSum scan{data, count, block_size, std::vector<T>(blocks)};
+            thread_pool.run(sum_blocks, &scan, blocks);
+            T offset = 0; //각 블록 앞까지의 합
+            for (auto &sum: scan.block_sums) {
+                auto block_sum = sum;
+                sum = offset;
+                offset = add(offset, block_sum);
+            }
+            thread_pool.run(scan_blocks, &scan, blocks);
+        }
+    };
+
+    //출 함수가 한 줄을 모으는 버퍼. 스레드마다 따로 모았다가 줄이 끝나면 stdout에 한 번에 써서 여러 스레드의 줄이 섞이지 않게 함
+    //stdout을 그대로 쓰므로 printf를 직접 호출한 출력과 순서가 바뀌지 않고, 프로그램이 끝날 때 C 런타임이 남은 출력을 내보냄
+    //stdout의 버퍼링은 바꾸지 않음. 런타임이 링크된 프로그램이나 라이브러리를 쓰는 프로세스가 이미 stdout을 썼을 수 있기 때문
+    thread_local std::string output_line;
+
+    std::atomic<bool> line_buffered{false};
+    std::once_flag output_init;
+
+    void init_output() {
+        if (auto env = std::getenv("ZUL_LINE_BUFFERED"); env && std::atoi(env) != 0)
+            line_buffered = true;
+    }
+
+    template<typename T>
+    void append_number(T value) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        output_line.append(buffer, result.ptr);
+    }
+
+    //표준 입력을 최대 size 바이트 읽음. 입력이 끝났거나 읽지 못하면 0 이하
+    int64_t read_stdin(char *buffer, size_t size) {
+#ifdef _WIN32
+        return _read(0, buffer, static_cast<unsigned>(size));
+#else
+        ssize_t count;
+        do {
+            count = read(STDIN_FILENO, buffer, size);
+        } while (count < 0 && errno == EINTR);
+        return count;
+#endif
+    }
+
+    //입 함수가 쓰는 표준 입력 버퍼. stdio를 거치지 않고 큰 블록으로 읽어 두고 직접 파싱함
+    //토큰이 블록 경계에 걸쳐도 되도록 한 글자씩 보고, 버퍼가 비었을 때만 다시 읽음
+    class InputBuffer {
+    public:
+        int peek() {
+            if (pos == len && !refill())
+                return EOF;
+            return static_cast<unsigned char>(data[pos]);
+        }
+
+        void advance() {
+            ++pos;
+        }
+
+        //공백을 건너뛰고 다음 글자를 돌려줌
+        int skip_space() {
+            int c;
+            while ((c = peek()) != EOF && is_space(c))
+                ++pos;
+            return c;
+        }
+
+        //이미 읽어 둔 나머지 바이트
+        const char *current() const {
+            return data.get() + pos;
+        }
+
+        size_t available() const {
+            return len - pos;
+        }
+
+        void skip(size_t count) {
+            pos += count;
+        }
+
+        static bool is_space(int c) {
+            return c == ' ' || ('\t' <= c && c <= '\r');
+        }
+
+    private:
+        std::unique_ptr<char[]> data;
+        size_t pos = 0;
+        size_t len = 0;
+        bool eof = false;
+
+        bool refill() {
+            if (eof)
+                return false;
+            if (!data)
+                data.reset(new char[INPUT_BLOCK_SIZE]);
+            //입력을 기다리기 전에 지금까지의 출력을 내보내서 안내 문구가 먼저 보이게 함
+            std::fflush(stdout);
+            auto count = read_stdin(data.get(), INPUT_BLOCK_SIZE);
+            if (count <= 0) {
+                eof = true;
+                return false;
+            }
+            pos = 0;
+            len = static_cast<size_t>(count);
+            return true;
+        }
+    };
+
+    std::mutex input_mutex;
+    InputBuffer input;
+
+    bool is_digit(int c) {
+        return '0' <= c && c <= '9';
+    }
+
+    //8바이트가 모두 숫자인지 한 번에 확인함
+    bool is_eight_digits(uint64_t chunk) {
+        return !(((chunk + 0x4646464646464646) | (chunk - 0x3030303030303030)) & 0x8080808080808080);
+    }
+
+    //리틀 엔디언으로 읽은 숫자 8글자를 곱셈 세 번으로 변환함
+    uint64_t parse_eight_digits(uint64_t chunk) {
+        chunk -= 0x3030303030303030;
+        chunk = chunk * 10 + (chunk >> 8);
+        chunk = ((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32)) +
+                 ((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >> 32;
+        return chunk;
+    }
+
+    //연속된 숫자를 읽어 앞에서부터 MAX_MANTISSA_DIGITS자리까지 value에 모으고, 지금까지 읽은 자릿수를 돌려줌
+    //token이 있으면 읽은 글자를 덧붙임
+    int read_digits(uint64_t &value, int digits, std::string *token) {
+        while (true) {
+            if constexpr (std::endian::native == std::endian::little) {
+                if (digits + 8 <= MAX_MANTISSA_DIGITS && input.available() >= 8) {
+                    uint64_t chunk;
+                    std::memcpy(&chunk, input.current(), 8);
+                    if (is_eight_digits(chunk)) {
+                        value = value * 100000000 + parse_eight_digits(chunk);
+                        if (token)
+                            token->append(input.current(), 8);
+                        input.skip(8);
+                        digits += 8;
+                        continue;
+                    }
+                }
+            }
+            auto c = input.peek();
+            if (!is_digit(c))
+                return digits;
+            if (digits < MAX_MANTISSA_DIGITS)
+                value = value * 10 + (c - '0');
+            if (token)
+                token->push_back(static_cast<char>(c));
+            ++digits;
+            input.advance();
+        }
+    }
+
+    //앞에 붙은 0을 건너뜀. 0이 있었는지 돌려줌
+    bool skip_zeros(std::string *token) {
+        bool skipped = false;
+        while (input.peek() == '0') {
+            if (token)
+                token->push_back('0');
+            input.advance();
+            skipped = true;
+        }
+        return skipped;
+    }
+
+    //부호를 읽음. 음수면 true
+    bool read_sign(std::string *token) {
+        auto c = input.peek();
+        if (c != '-' && c != '+')
+            return false;
+        if (token)
+            token->push_back(static_cast<char>(c));
+        input.advance();
+        return c == '-';
+    }
+
+    //scanf의 %lld처럼 공백을 건너뛰고 정수를 읽음. 범위를 넘으면 최댓값이나 최솟값이 됨
+    bool read_int(int64_t &result) {
+        input.skip_space();
+        auto negative = read_sign(nullptr);
+        auto has_zero = skip_zeros(nullptr);
+        uint64_t value = 0;
+        auto digits = read_digits(value, 0, nullptr);
+        if (digits == 0 && !has_zero)
+            return false;
+        auto limit = negative ? static_cast<uint64_t>(INT64_MAX) + 1 : static_cast<uint64_t>(INT64_MAX);
+        if (digits > MAX_MANTISSA_DIGITS || value > limit)
+            value = limit;
+        result = static_cast<int64_t>(negative ? 0 - value : value);
+        return true;
+    }
+
+    //inf, nan, 16진수처럼 드문 형식은 글자만 모아서 strtod에 맡김
+    bool read_special_float(std::string &token, double &result) {
+        while (true) {
+            auto c = input.peek();
+            if (c == EOF || !(std::isalnum(c) || c == '.' ||
+                              ((c == '-' || c == '+') && (token.back() == 'p' || token.back() == 'P'))))
+                break;
+            token.push_back(static_cast<char>(c));
+            input.advance();
+        }
+        char *end;
+        auto value = std::strtod(token.c_str(), &end);
+        if (end == token.c_str())
+            return false;
+        result = value;
+        return true;
+    }
+
+    //scanf의 %lf처럼 공백을 건너뛰고 실수를 읽음
+    //가수가 2^53 이하이고 10의 지수가 22 이하이면 두 수 모두 double로 정확히 표현되므로 곱셈이나 나눗셈 한 번으로 정확히 반올림된 값을 구함
+    //그 밖의 경우는 읽은 글자를 strtod로 다시 변환함
+    bool read_float(double &result) {
+        static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        static std::string token; //input_mutex 안에서만 사용함
+        token.clear();
+        input.skip_space();
+        auto negative = read_sign(&token);
+        auto has_zero = skip_zeros(&token);
+        auto c = input.peek();
+        if (has_zero ? c == 'x' || c == 'X' : std::isalpha(c))
+            return read_special_float(token, result);
+
+        uint64_t mantissa = 0;
+        auto digits = read_digits(mantissa, 0, &token);
+        auto has_digit = has_zero || digits > 0;
+        int fraction_digits = 0;
+        if (input.peek() == '.') {
+            token.push_back('.');
+            input.advance();
+            //정수 부분이 0이면 소수점 뒤의 0도 유효 숫자가 아님
+            if (digits == 0) {
+                while (input.peek() == '0') {
+                    token.push_back('0');
+                    input.advance();
+                    ++fraction_digits;
+                    has_digit = true;
+                }
+            }
+            auto total = read_digits(mantissa, digits, &token);
+            fraction_digits += total - digits;
+            has_digit |= total > digits;
+            digits = total;
+        }
+        if (!has_digit)
+            return false;
+
+        int64_t exponent = 0;
+        if (c = input.peek(); c == 'e' || c == 'E') {
+            token.push_back(static_cast<char>(c));
+            input.advance();
+            auto exp_negative = read_sign(&token);
+            uint64_t exp_value = 0;
+            auto exp_digits = read_digits(exp_value, 0, &token);
+            if (exp_digits > 0)
+                exponent = exp_digits > 9 ? 1000000000 : static_cast<int64_t>(exp_value);
+            if (exp_negative)
+                exponent = -exponent;
+        }
+        exponent -= fraction_digits;
+
+        if (digits <= MAX_MANTISSA_DIGITS && mantissa <= (1ULL << 53) && -22 <= exponent && exponent <= 22) {
+            auto value = static_cast<double>(mantissa);
+            value = exponent < 0 ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+            result = negative ? -value : value;
+            return true;
+        }
+        result = std::strtod(token.c_str(), nullptr);
+        return true;
+    }
+}
+
+extern "C" {
+void *zul_arena_alloc(int64_t bytes) {
+    if (bytes < 0)
+        runtime_error("배열 크기가 음수입니다");
+    return arena.alloc(static_cast<size_t>(bytes));
+}
+
+void *zul_arena_mark() {
+    return arena.top;
+}
+
+void zul_arena_release(void *mark) {
+    arena.release(static_cast<char *>(mark));
+}
+
+void *zul_region_new() {
+    auto region = new(std::nothrow) Region;
+    if (!region)
+        runtime_error("영역을 만들 메모리가 부족합니다");
+    return region;
+}
+
+void *zul_region_alloc(void *region, int64_t bytes) {
+    if (!region)
+        runtime_error("만들지 않았거나 해제한 영역에 배열을 할당했습니다");
+    if (bytes < 0)
+        runtime_error("배열 크기가 음수입니다");
+    auto &target = *static_cast<Region *>(region);
+    void *memory;
+    {
+        std::lock_guard lock(target.mutex);
+        memory = target.arena.alloc(static_cast<size_t>(bytes));
+    }
+    std::memset(memory, 0, static_cast<size_t>(bytes));
+    return memory;
+}
+
+void zul_region_reset(void *region) {
+    if (!region)
+        return;
+    auto &target = *static_cast<Region *>(region);
+    std::lock_guard lock(target.mutex);
+    target.arena.release(nullptr);
+}
+
+void zul_region_free(void *region) {
+    delete static_cast<Region *>(region);
+}
+
+void zul_set_threads(int64_t count) {
+    std::lock_guard lock(pool_mutex);
+    requested_threads = count;
+    pool.reset(); //다음 병렬 ㄱㄱ문에서 새 크기로 만듦
+}
+
+void zul_parallel_for(ParallelBody body, void *ctx, int64_t count) {
+    if (count <= 0)
+        return;
+    if (in_parallel || count == 1) {
+        body(ctx, 0, count, nullptr);
+        return;
+    }
+    auto &thread_pool = get_pool();
+    if (thread_pool.size() == 1) {
+        body(ctx, 0, count, nullptr);
+        return;
+    }
+    thread_pool.run(body, ctx, count);
+}
+
+void zul_parallel_reduce(ParallelBody body, void *ctx, int64_t count, CombineFunc combine, void *result,
+                         const void *identity, int64_t size) {
+    if (count <= 0)
+        return;
+    //한 스레드에서 실행하면 result에 바로 누적함
+    if (in_parallel || count == 1) {
+        body(ctx, 0, count, result);
+        return;
+    }
+    auto &thread_pool = get_pool();
+    if (thread_pool.size() == 1) {
+        body(ctx, 0, count, result);
+        return;
+    }
+    //작업자들의 누적값이 같은 캐시 라인을 나눠 쓰지 않도록 캐시 라인 단위로 떨어뜨림
+    auto stride = (static_cast<size_t>(size) + ARENA_ALIGN - 1) & ~static_cast<size_t>(ARENA_ALIGN - 1);
+    auto partials = static_cast<char *>(::operator new(stride * thread_pool.size(), std::align_val_t{ARENA_ALIGN}));
+    for (unsigned i = 0; i < thread_pool.size(); ++i)
+        std::memcpy(partials + i * stride, identity, static_cast<size_t>(size));
+    thread_pool.run(body, ctx, count, partials, stride);
+    for (unsigned i = 0; i < thread_pool.size(); ++i)
+        combine(result, partials + i * stride);
+    ::operator delete(partials, std::align_val_t{ARENA_ALIGN});
+}
+
+void zul_prefix_sum_i64(int64_t *data, int64_t count) {
+    PrefixSum<int64_t>::run(data, count);
+}
+
+void zul_prefix_sum_f64(double *data, int64_t count) {
+    PrefixSum<double>::run(data, count);
+}
+
+void zul_read_int(int64_t *dst) {
+    std::lock_guard lock(input_mutex);
+    read_int(*dst);
+}
+
+void zul_read_float(double *dst) {
+    std::lock_guard lock(input_mutex);
+    read_float(*dst);
+}
+
+void zul_read_bool(bool *dst) {
+    std::lock_guard lock(input_mutex);
+    int64_t value;
+    if (read_int(value))
+        *dst = value != 0;
+}
+
+void zul_read_char(char *dst, int64_t skip_space) {
+    std::lock_guard lock(input_mutex);
+    auto c = skip_space ? input.skip_space() : input.peek();
+    if (c == EOF)
+        return;
+    *dst = static_cast<char>(c);
+    input.advance();
+}
+
+void zul_read_str(char *dst) {
+    std::lock_guard lock(input_mutex);
+    auto c = input.skip_space();
+    if (c == EOF)
+        return;
+    while (c != EOF && !InputBuffer::is_space(c)) {
+        *dst++ = static_cast<char>(c);
+        input.advance();
+        c = input.peek();
+    }
+    *dst = '\0';
+}
+
+void zul_write_int(int64_t value) {
+    append_number(value);
+}
+
+void zul_write_float(double value) {
+    //값의 크기와 상관 없이 지수 표기를 쓰지 않고, 그 안에서 다시 읽었을 때 같은 값이 되는 가장 짧은 자릿수로 씀
+    char buffer[MAX_FIXED_FLOAT_CHARS];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+    output_line.append(buffer, result.ptr);
+    //정수처럼 보이면 수와 구별되도록 .0을 붙임
+    if (std::isfinite(value) && std::find(buffer, result.ptr, '.') == result.ptr)
+        output_line.append(".0");
+}
+
+void zul_write_bool(bool value) {
+    output_line.push_back(value ? '1' : '0');
+}
+
+void zul_write_char(char value) {
+    output_line.push_back(value);
+}
+
+void zul_write_str(const char *value) {
+    output_line.append(value);
+}
+
+void zul_write_ptr(const void *value) {
+    char buffer[32];
+    auto length = std::snprintf(buffer, sizeof(buffer), "%p", value);
+    output_line.append(buffer, static_cast<size_t>(length));
+}
+
+void zul_write_line() {
+    std::call_once(output_init, init_output);
+    output_line.push_back('\n');
+    std::fwrite(output_line.data(), 1, output_line.size(), stdout);
+    if (line_buffered)
+        std::fflush(stdout);
+    output_line.clear();
+}
+
+void zul_set_line_buffered(int64_t enabled) {
+    line_buffered = enabled != 0;
+}
+
+void zul_bounds_fail(int64_t index, int64_t size, int64_t line) {
+    char msg[256];
+    std::snprintf(msg, sizeof(msg), "%lld번째 줄에서 배열의 범위를 벗어났습니다. (인덱스: %lld, 크기: %lld)",
+                  static_cast<long long>(line), static_cast<long long>(index), static_cast<long long>(size));
+    runtime_error(msg);
+}
+}
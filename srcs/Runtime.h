@@ -0,0 +1,93 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_RUNTIME_H
+#define ZULLANG_RUNTIME_H
+
+#include <cstdint>
+
+#define ARENA_ALIGN 64 //아레나가 돌려주는 메모리의 정렬. 캐시 라인 크기
+
+//줄랭 코드가 호출하는 런타임 함수들. LLVM 없이 zulrt 라이브러리로 따로 빌드되고, 컴파일러에도 링크되어 JIT과 인터프리터가 바로 호출함
+//-c, -S로 만든 비트코드를 직접 링크할 때는 zulrt 라이브러리를 함께 링크해야 함 (--emit-shared는 자동으로 링크함)
+extern "C" {
+//스레드마다 따로 있는 아레나에서 64바이트 단위로 정렬된 메모리를 할당함. 해제는 zul_arena_release로 한 번에 함
+void *zul_arena_alloc(int64_t bytes);
+
+//현재 아레나의 위치
+void *zul_arena_mark();
+
+//mark 이후에 할당된 메모리를 모두 해제함. 해제된 청크는 다음 할당에 다시 사용됨
+void zul_arena_release(void *mark);
+
+//영역 함수들. 영역은 아레나처럼 bump 포인터로 할당하지만, 스코프와 상관 없이 zul_region_reset이나 zul_region_free를 부를 때까지 유지됨
+//병렬 ㄱㄱ문에서 같은 영역에 할당할 수 있도록 할당할 때 영역을 잠금
+void *zul_region_new();
+
+//0으로 채워진 bytes 바이트를 64바이트 단위로 정렬해서 할당함
+void *zul_region_alloc(void *region, int64_t bytes);
+
+//영역에 할당한 메모리를 한 번에 해제함. 청크는 남겨 두고 다음 할당에 재사용함
+void zul_region_reset(void *region);
+
+//영역과 영역의 메모리를 모두 해제함. nullptr이면 아무것도 하지 않음
+void zul_region_free(void *region);
+
+//병렬 ㄱㄱ문의 몸체 body(ctx, begin, end, nullptr)로 [0, count) 번째 반복을 스레드 풀에서 나눠 실행하고, 모두 끝나면 돌아옴
+//병렬 ㄱㄱ문 안에서 다시 호출하면 그 스레드에서 바로 실행함
+void zul_parallel_for(void (*body)(void *ctx, int64_t begin, int64_t end, void *partial), void *ctx, int64_t count);
+
+//누적 변수가 있는 병렬 ㄱㄱ문. 스레드마다 identity를 복사한 size 바이트의 누적값을 만들어 body의 partial로 넘기고,
+//모두 끝나면 combine(result, 누적값)으로 result에 합침. 한 스레드에서 실행할 때는 result를 바로 넘김
+void zul_parallel_reduce(void (*body)(void *ctx, int64_t begin, int64_t end, void *partial), void *ctx, int64_t count,
+                         void (*combine)(void *dst, const void *src), void *result, const void *identity,
+                         int64_t size);
+
+//누적합 함수. data의 앞 count개를 제자리에서 그 위치까지의 합으로 바꿈. 배열이 크면 스레드 풀에서 나눠 계산함
+void zul_prefix_sum_i64(int64_t *data, int64_t count);
+
+void zul_prefix_sum_f64(double *data, int64_t count);
+
+//병렬 ㄱㄱ문이 사용할 스레드 수. 0이면 ZUL_THREADS 환경 변수, 그것도 없으면 코어 수만큼 사용함
+void zul_set_threads(int64_t count);
+
+//입 함수가 쓰는 입력 함수들. 표준 입력을 큰 블록으로 읽어 두고 scanf의 %lld, %lf, %c, %s처럼 파싱함
+//읽지 못하면 dst를 바꾸지 않음. 버퍼를 따로 가지므로 scanf 같은 C 입력 함수와 섞어 쓰면 안 됨
+void zul_read_int(int64_t *dst);
+
+void zul_read_float(double *dst);
+
+//정수를 읽어 0이 아니면 참으로 저장함
+void zul_read_bool(bool *dst);
+
+//skip_space가 0이 아니면 공백을 건너뛰고 글자 하나를 읽음
+void zul_read_char(char *dst, int64_t skip_space);
+
+//공백을 건너뛰고 다음 공백 전까지를 읽어 널 문자로 끝냄
+void zul_read_str(char *dst);
+
+//출 함수가 쓰는 출력 함수들. 값을 printf 없이 바로 문자열로 바꿔 스레드마다 있는 줄 버퍼에 모으고,
+//zul_write_line에서 줄바꿈을 붙여 stdout에 한 번에 씀. 실수는 지수 표기 없이, 다시 읽었을 때 같은 값이 되는 가장 짧은 자릿수로 씀
+void zul_write_int(int64_t value);
+
+void zul_write_float(double value);
+
+void zul_write_bool(bool value);
+
+void zul_write_char(char value);
+
+void zul_write_str(const char *value);
+
+void zul_write_ptr(const void *value);
+
+void zul_write_line();
+
+//0이 아니면 출 함수가 줄마다 stdout을 비움. 설정하지 않으면 ZUL_LINE_BUFFERED 환경 변수를 따르고,
+//둘 다 없으면 stdout의 버퍼링을 그대로 따름
+void zul_set_line_buffered(int64_t enabled);
+
+//--bounds-check에서 인덱스가 배열의 범위를 벗어났을 때 호출됨. 에러를 출력하고 프로그램을 끝냄
+[[noreturn]] void zul_bounds_fail(int64_t index, int64_t size, int64_t line);
+}
+
+#endif //ZULLANG_RUNTIME_H
@@ -0,0 +1,64 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+
+#include "Runtime.h"
+#include "RuntimeSymbols.h"
+
+using llvm::orc::SymbolMap;
+using llvm::orc::ExecutorAddr;
+using llvm::JITSymbolFlags;
+
+namespace {
+    struct RuntimeSymbol {
+        std::string_view name;
+        void *address;
+    };
+
+    const RuntimeSymbol runtime_symbols[] = {
+            {"zul_arena_alloc",   reinterpret_cast<void *>(zul_arena_alloc)},
+            {"zul_arena_mark",    reinterpret_cast<void *>(zul_arena_mark)},
+            {"zul_arena_release", reinterpret_cast<void *>(zul_arena_release)},
+            {"zul_bounds_fail",   reinterpret_cast<void *>(zul_bounds_fail)},
+            {"zul_region_new",    reinterpret_cast<void *>(zul_region_new)},
+            {"zul_region_alloc",  reinterpret_cast<void *>(zul_region_alloc)},
+            {"zul_region_reset",  reinterpret_cast<void *>(zul_region_reset)},
+            {"zul_region_free",   reinterpret_cast<void *>(zul_region_free)},
+            {"zul_parallel_for",  reinterpret_cast<void *>(zul_parallel_for)},
+            {"zul_parallel_reduce", reinterpret_cast<void *>(zul_parallel_reduce)},
+            {"zul_set_threads",   reinterpret_cast<void *>(zul_set_threads)},
+            {"zul_prefix_sum_i64", reinterpret_cast<void *>(zul_prefix_sum_i64)},
+            {"zul_prefix_sum_f64", reinterpret_cast<void *>(zul_prefix_sum_f64)},
+            {"zul_read_int",      reinterpret_cast<void *>(zul_read_int)},
+            {"zul_read_float",    reinterpret_cast<void *>(zul_read_float)},
+            {"zul_read_bool",     reinterpret_cast<void *>(zul_read_bool)},
+            {"zul_read_char",     reinterpret_cast<void *>(zul_read_char)},
+            {"zul_read_str",      reinterpret_cast<void *>(zul_read_str)},
+            {"zul_write_int",     reinterpret_cast<void *>(zul_write_int)},
+            {"zul_write_float",   reinterpret_cast<void *>(zul_write_float)},
+            {"zul_write_bool",    reinterpret_cast<void *>(zul_write_bool)},
+            {"zul_write_char",    reinterpret_cast<void *>(zul_write_char)},
+            {"zul_write_str",     reinterpret_cast<void *>(zul_write_str)},
+            {"zul_write_ptr",     reinterpret_cast<void *>(zul_write_ptr)},
+            {"zul_write_line",    reinterpret_cast<void *>(zul_write_line)},
+            {"zul_set_line_buffered", reinterpret_cast<void *>(zul_set_line_buffered)},
+    };
+}
+
+void *find_runtime_symbol(std::string_view name) {
+    for (auto &symbol: runtime_symbols) {
+        if (symbol.name == name)
+            return symbol.address;
+    }
+    return nullptr;
+}
+
+llvm::Error add_runtime_symbols(llvm::orc::LLJIT &jit) {
+    SymbolMap symbols;
+    for (auto &symbol: runtime_symbols) {
+        symbols[jit.mangleAndIntern(symbol.name)] = {ExecutorAddr::fromPtr(symbol.address),
+                                                     JITSymbolFlags::Exported | JITSymbolFlags::Callable};
+    }
+    return jit.getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(symbols)));
+}
@@ -0,0 +1,23 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_RUNTIMESYMBOLS_H
+#define ZULLANG_RUNTIMESYMBOLS_H
+
+#include <string_view>
+
+#include "llvm/Support/Error.h"
+
+namespace llvm::orc {
+    class LLJIT;
+}
+
+//컴파일러에 링크된 런타임 함수(Runtime.h)를 JIT과 인터프리터에 연결함. 런타임은 LLVM을 몰라야 하므로 이 파일에 따로 둠
+
+//런타임 함수의 주소. 런타임 함수가 아니면 nullptr
+void *find_runtime_symbol(std::string_view name);
+
+//JIT된 코드가 런타임 함수를 찾을 수 있도록 등록함
+llvm::Error add_runtime_symbols(llvm::orc::LLJIT &jit);
+
+#endif //ZULLANG_RUNTIMESYMBOLS_H
@@ -0,0 +1,106 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "SSABuilder.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+
+#include "Utility.h"
+
+using llvm::BasicBlock;
+using llvm::PHINode;
+using llvm::Value;
+using llvm::WeakTrackingVH;
+
+//phi는 항상 블록의 맨 앞에 둠
+PHINode *create_phi(LocalVar *var, BasicBlock *block) {
+    auto type = get_llvm_type(block->getContext(), var->type);
+    if (block->empty())
+        return PHINode::Create(type, 2, var->name, block);
+    return PHINode::Create(type, 2, var->name, &block->front());
+}
+
+void SSABuilder::reset() {
+    current_def.clear();
+    incomplete_phis.clear();
+    sealed_blocks.clear();
+}
+
+void SSABuilder::write_var(LocalVar *var, BasicBlock *block, Value *value) {
+    current_def[block][var] = value;
+}
+
+Value *SSABuilder::read_var(LocalVar *var, BasicBlock *block) {
+    if (auto block_iter = current_def.find(block); block_iter != current_def.end()) {
+        if (auto iter = block_iter->second.find(var); iter != block_iter->second.end())
+            return iter->second;
+    }
+    return read_var_recursive(var, block);
+}
+
+void SSABuilder::seal_block(BasicBlock *block) {
+    if (auto iter = incomplete_phis.find(block); iter != incomplete_phis.end()) {
+        auto phis = std::move(iter->second);
+        incomplete_phis.erase(iter);
+        for (auto &[var, phi]: phis) {
+            add_phi_operands(var, phi);
+        }
+    }
+    sealed_blocks.insert(block);
+}
+
+Value *SSABuilder::read_var_recursive(LocalVar *var, BasicBlock *block) {
+    Value *value;
+    if (!sealed_blocks.contains(block)) {
+        auto phi = create_phi(var, block);
+        incomplete_phis[block].emplace_back(var, phi);
+        value = phi;
+    } else if (auto pred = block->getSinglePredecessor()) {
+        value = read_var(var, pred);
+    } else if (llvm::pred_empty(block)) { //초기화하지 않은 변수나 도달할 수 없는 블록은 0으로 읽음
+        value = llvm::Constant::getNullValue(get_llvm_type(block->getContext(), var->type));
+    } else {
+        auto phi = create_phi(var, block);
+        write_var(var, block, phi); //선행 블록을 따라가다 순환해서 돌아오면 이 phi를 사용하도록 먼저 기록함
+        value = add_phi_operands(var, phi);
+    }
+    write_var(var, block, value);
+    return value;
+}
+
+Value *SSABuilder::add_phi_operands(LocalVar *var, PHINode *phi) {
+    llvm::SmallVector<BasicBlock *, 4> preds(llvm::predecessors(phi->getParent()));
+    for (auto pred: preds) {
+        phi->addIncoming(read_var(var, pred), pred);
+    }
+    return try_remove_trivial_phi(phi);
+}
+
+Value *SSABuilder::try_remove_trivial_phi(PHINode *phi) {
+    Value *same = nullptr;
+    for (auto &operand: phi->incoming_values()) {
+        if (operand == same || operand == phi)
+            continue;
+        if (same)
+            return phi;
+        same = operand;
+    }
+    if (!same)
+        same = llvm::Constant::getNullValue(phi->getType());
+
+    llvm::SmallVector<WeakTrackingVH, 8> users;
+    for (auto user: phi->users()) {
+        if (user != phi && llvm::isa<PHINode>(user))
+            users.emplace_back(user);
+    }
+    WeakTrackingVH result = same; //아래에서 same도 지워질 수 있으므로 추적함
+    phi->replaceAllUsesWith(same);
+    phi->eraseFromParent();
+    for (auto &user: users) {
+        if (auto user_phi = llvm::dyn_cast_or_null<PHINode>(static_cast<Value *>(user)))
+            try_remove_trivial_phi(user_phi);
+    }
+    return result;
+}
@@ -0,0 +1,49 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_SSABUILDER_H
+#define ZULLANG_SSABUILDER_H
+
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/ValueHandle.h"
+
+struct LocalVar;
+
+//지역 변수를 alloca 없이 바로 SSA 값으로 만드는 빌더 (Braun et al. 2013, Simple and Efficient Construction of SSA Form)
+//블록마다 변수에 마지막으로 대입된 값을 기록해 두고, 값을 읽을 때 선행 블록을 거슬러 올라가면서 필요한 곳에만 phi를 만듦
+//선행 블록이 아직 다 정해지지 않은 블록(반복문의 조건 블록 등)은 봉인되기 전까지 phi를 비워 두었다가 봉인할 때 채움
+class SSABuilder {
+public:
+    //함수를 새로 생성하기 전에 호출함
+    void reset();
+
+    void write_var(LocalVar *var, llvm::BasicBlock *block, llvm::Value *value);
+
+    llvm::Value *read_var(LocalVar *var, llvm::BasicBlock *block);
+
+    //블록으로 들어오는 분기가 모두 만들어졌을 때 호출함
+    void seal_block(llvm::BasicBlock *block);
+
+private:
+    //phi로 대체되거나 지워진 값도 따라가도록 WeakTrackingVH로 저장함
+    llvm::DenseMap<llvm::BasicBlock *, llvm::DenseMap<LocalVar *, llvm::WeakTrackingVH>> current_def;
+
+    llvm::DenseMap<llvm::BasicBlock *, std::vector<std::pair<LocalVar *, llvm::PHINode *>>> incomplete_phis;
+
+    llvm::DenseSet<llvm::BasicBlock *> sealed_blocks;
+
+    llvm::Value *read_var_recursive(LocalVar *var, llvm::BasicBlock *block);
+
+    llvm::Value *add_phi_operands(LocalVar *var, llvm::PHINode *phi);
+
+    //모든 인자가 같은 값이거나 자기 자신인 phi를 지움
+    llvm::Value *try_remove_trivial_phi(llvm::PHINode *phi);
+};
+
+#endif //ZULLANG_SSABUILDER_H
@@ -0,0 +1,23 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "llvm/TargetParser/Host.h"
+
+#include "Session.h"
+
+using std::string;
+
+Session::Session(const string &source_name) : source_name(source_name),
+                                              target_triple(llvm::sys::getProcessTriple()) {
+    auto s_pos = source_name.rfind('\\');
+    if (s_pos == string::npos)
+        s_pos = source_name.rfind('/');
+
+    if (s_pos == string::npos) {
+        source_base_name = source_name;
+    } else {
+        source_base_name = source_name.substr(s_pos + 1);
+    }
+
+    logger.set_source_name(source_base_name);
+}
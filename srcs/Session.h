@@ -0,0 +1,37 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_SESSION_H
+#define ZULLANG_SESSION_H
+
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+//컴파일 한 번의 옵션과 상태. 컴파일러는 전역 상태 없이 세션만 사용하므로,
+//세션을 여러 개 만들면 한 프로세스의 여러 스레드에서 동시에 컴파일할 수 있음
+struct Session {
+    Logger logger;
+    std::string source_name;
+    std::string source_base_name; //경로를 뺀 소스 파일 이름. 모듈 이름과 에러 메세지에 사용
+    std::string target_triple;
+    std::string output_name;
+    bool opt_compile = false;
+    bool opt_assembly = false;
+    bool opt_shared = false;
+    unsigned opt_level = 0;
+    unsigned jobs = 1;
+    bool whole_program = false; //모듈 전체를 하나로 보고, 진입점과 내보낼 함수 외에는 내부 함수로 만들어 최적화함
+    std::vector<std::string> exports; //전체 프로그램 모드에서 외부에 보이게 남길 함수 이름들
+    bool opt_interp = false; //LLVM IR을 바이트코드로 바꿔서 인터프리터로 실행
+    bool opt_auto = false; //프로그램 크기를 보고 인터프리터와 JIT 중 하나로 실행
+    bool bounds_check = false; //크기를 아는 배열의 인덱스를 런타임에 검사함
+    bool report_tail_calls = false; //꼬리 호출로 만든 ㅈㅈ문을 참고 메세지로 알림
+    bool watch = false; //핫 리로드 모드. 함수 몸체가 바뀔 수 있으므로 다른 함수의 호출을 컴파일 타임에 계산하지 않음
+    bool need_entry = true; //진입점 함수가 반드시 있어야 하는지. 임베딩할 때는 진입점 없이 함수만 컴파일할 수 있음
+
+    explicit Session(const std::string &source_name);
+};
+
+#endif //ZULLANG_SESSION_H
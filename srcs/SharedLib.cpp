@@ -0,0 +1,226 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <fstream>
+#include <set>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+
+#include "SharedLib.h"
+
+using std::string;
+using std::map;
+using std::cerr;
+
+using llvm::Module;
+using llvm::StringRef;
+using llvm::SmallString;
+
+//줄랭 타입에 대응되는 C 타입
+string get_c_type(int type_id) {
+    if (type_id < 0)
+        return "void";
+    static const char *c_types[] = {"bool", "char", "long long", "double"};
+    int elm_type = type_id % TYPE_COUNTS;
+    string ret = elm_type == id_region ? "void *" : c_types[elm_type]; //영역은 런타임 영역의 주소
+    if (type_id >= TYPE_COUNTS) //배열은 원소의 포인터로 넘김
+        ret.append(" *");
+    return ret;
+}
+
+string get_export_name(const string &name) {
+    bool is_ascii = !name.empty() && !isdigit(static_cast<unsigned char>(name[0])) &&
+                    llvm::all_of(name, [](char c) { return llvm::isAlnum(c) || c == '_'; });
+    if (is_ascii)
+        return name;
+    string ret = "zul_";
+    for (size_t i = 0; i < name.size();) {
+        auto c = static_cast<unsigned char>(name[i]);
+        if (c < 0x80) {
+            if (llvm::isAlnum(c))
+                ret.push_back(static_cast<char>(c));
+            else if (c == '_')
+                ret.append("__");
+            else
+                ret.append("_u" + llvm::utohexstr(c, false, 4));
+            ++i;
+            continue;
+        }
+        //UTF-8 한 글자를 코드 포인트로 바꿈
+        int cnt = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 4;
+        unsigned code = c & (0x7F >> cnt);
+        for (int j = 1; j < cnt && i + j < name.size(); ++j) {
+            code = (code << 6) | (static_cast<unsigned char>(name[i + j]) & 0x3F);
+        }
+        if (code <= 0xFFFF)
+            ret.append("_u" + llvm::utohexstr(code, false, 4));
+        else
+            ret.append("_U" + llvm::utohexstr(code, false, 8));
+        i += cnt;
+    }
+    return ret;
+}
+
+bool emit_object(Module &module, StringRef object_name) {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    string err;
+    auto triple = module.getTargetTriple();
+    auto target = llvm::TargetRegistry::lookupTarget(triple, err);
+    if (!target) {
+        cerr << "에러: \"" << triple << "\" 타겟을 찾을 수 없습니다. " << err << '\n';
+        return false;
+    }
+    std::unique_ptr<llvm::TargetMachine> machine{
+            target->createTargetMachine(triple, "generic", "", llvm::TargetOptions{}, llvm::Reloc::PIC_)};
+    module.setDataLayout(machine->createDataLayout());
+    module.setPICLevel(llvm::PICLevel::BigPIC);
+
+    std::error_code ec;
+    llvm::raw_fd_ostream object_file{object_name, ec, llvm::sys::fs::OF_None};
+    if (ec) {
+        cerr << "에러: \"" << object_name.str() << "\" 파일을 만들 수 없습니다. " << ec.message() << '\n';
+        return false;
+    }
+#if LLVM_VERSION_MAJOR >= 18
+    auto file_type = llvm::CodeGenFileType::ObjectFile;
+#else
+    auto file_type = llvm::CGFT_ObjectFile;
+#endif
+    llvm::legacy::PassManager pass_manager;
+    if (machine->addPassesToEmitFile(pass_manager, object_file, nullptr, file_type)) {
+        cerr << "에러: 이 타겟은 오브젝트 파일을 만들 수 없습니다\n";
+        return false;
+    }
+    pass_manager.run(module);
+    object_file.flush();
+    return true;
+}
+
+//zulrt 런타임 라이브러리의 경로. zul 실행 파일과 같은 폴더를 먼저 찾고, 없으면 빌드한 위치를 찾음
+string find_runtime_library() {
+#ifdef _WIN32
+    const char *library_name = "zulrt.lib";
+#else
+    const char *library_name = "libzulrt.a";
+#endif
+    auto exe_path = llvm::sys::fs::getMainExecutable("zul", reinterpret_cast<void *>(&find_runtime_library));
+    SmallString<128> library_path{llvm::sys::path::parent_path(exe_path)};
+    llvm::sys::path::append(library_path, library_name);
+    if (llvm::sys::fs::exists(library_path))
+        return library_path.str().str();
+#ifdef ZUL_RUNTIME_PATH
+    if (llvm::sys::fs::exists(ZUL_RUNTIME_PATH))
+        return ZUL_RUNTIME_PATH;
+#endif
+    return "";
+}
+
+bool link_shared(const string &object_name, const string &output_name) {
+    auto runtime = find_runtime_library();
+    if (runtime.empty()) {
+        cerr << "에러: 런타임 라이브러리(zulrt)를 찾을 수 없습니다. zul 실행 파일과 같은 폴더에 있어야 합니다\n";
+        return false;
+    }
+    //런타임은 C++ 표준 라이브러리와 스레드를 쓰므로 C++ 컴파일러 드라이버로 링크함
+    for (auto linker_name: {"c++", "clang++", "g++"}) {
+        auto linker = llvm::sys::findProgramByName(linker_name);
+        if (!linker)
+            continue;
+        StringRef args[] = {*linker, "-shared", "-o", output_name, object_name, runtime, "-pthread"};
+        string err;
+        if (llvm::sys::ExecuteAndWait(*linker, args, std::nullopt, {}, 0, 0, &err) != 0) {
+            cerr << "에러: 공유 라이브러리 링크에 실패했습니다. " << err << '\n';
+            return false;
+        }
+        return true;
+    }
+    cerr << "에러: 링커(c++, clang++, g++)를 찾을 수 없습니다\n";
+    return false;
+}
+
+void write_header(Session &session, const string &header_name, const map<string, FuncProtoAST> &protos,
+                  const std::set<string> &exported) {
+    auto stem = llvm::sys::path::stem(header_name).str();
+    auto guard = "ZUL_" + llvm::StringRef(get_export_name(stem)).upper() + "_H";
+    std::ofstream header(header_name, std::ios::binary);
+    header << "//" << session.source_base_name << " 에서 생성된 헤더입니다. 직접 수정하지 마세요\n\n";
+    header << "#ifndef " << guard << "\n#define " << guard << "\n\n#include <stdbool.h>\n\n";
+    header << "#ifdef __cplusplus\nextern \"C\" {\n#endif\n";
+    for (auto &[name, proto]: protos) {
+        if (!exported.contains(name))
+            continue;
+        //원래 줄랭 프로토타입을 주석으로 남김
+        header << "\n//" << name << '(';
+        for (size_t i = 0; i < proto.params.size(); ++i) {
+            if (i > 0)
+                header << ", ";
+            if (!proto.params[i].first.empty())
+                header << proto.params[i].first << ": ";
+            header << get_type_name(proto.params[i].second);
+        }
+        header << ')';
+        if (proto.return_type != -1)
+            header << ' ' << get_type_name(proto.return_type);
+        header << '\n' << get_c_type(proto.return_type) << ' ' << get_export_name(name) << '(';
+        for (size_t i = 0; i < proto.params.size(); ++i) {
+            if (i > 0)
+                header << ", ";
+            header << get_c_type(proto.params[i].second);
+        }
+        if (proto.params.empty())
+            header << "void";
+        header << ");\n";
+    }
+    header << "\n#ifdef __cplusplus\n}\n#endif\n\n#endif //" << guard << '\n';
+}
+
+bool write_shared(Session &session, Module &module, const map<string, FuncProtoAST> &protos) {
+    //전체 프로그램 모드에서 내부 함수가 된 함수와, C 컴파일러마다 넘기는 방법이 다른 벡터 타입을 쓰는 함수는 내보내지 않음
+    auto uses_vector = [](const FuncProtoAST &proto) {
+        return is_vector_type(proto.return_type % TYPE_COUNTS) ||
+               llvm::any_of(proto.params, [](auto &param) { return is_vector_type(param.second % TYPE_COUNTS); });
+    };
+    std::set<string> exported;
+    for (auto &[name, proto]: protos) {
+        auto func = module.getFunction(name);
+        if (proto.has_body && func && !func->isDeclaration() && !func->hasLocalLinkage() && !uses_vector(proto)) {
+            func->setName(get_export_name(name));
+            exported.insert(name);
+        }
+    }
+    for (auto &global: module.globals()) {
+        if (global.hasExternalLinkage() && !global.isDeclaration())
+            global.setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+
+    if (session.output_name.empty()) {
+        auto dot_pos = session.source_name.rfind('.');
+        session.output_name = session.source_name.substr(0, dot_pos) + ".so";
+    }
+    SmallString<128> object_name;
+    if (auto ec = llvm::sys::fs::createTemporaryFile("zul", "o", object_name)) {
+        cerr << "에러: 임시 오브젝트 파일을 만들 수 없습니다. " << ec.message() << '\n';
+        return false;
+    }
+    bool linked = emit_object(module, object_name) && link_shared(object_name.str().str(), session.output_name);
+    llvm::sys::fs::remove(object_name);
+    if (!linked)
+        return false;
+
+    SmallString<128> header_name{session.output_name};
+    llvm::sys::path::replace_extension(header_name, "h");
+    write_header(session, header_name.str().str(), protos, exported);
+    return true;
+}
@@ -0,0 +1,24 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_SHAREDLIB_H
+#define ZULLANG_SHAREDLIB_H
+
+#include <map>
+#include <string>
+
+#include "llvm/IR/Module.h"
+
+#include "AST.h"
+#include "Session.h"
+
+//공유 라이브러리에서 함수를 내보낼 이름. ASCII 이름은 그대로 쓰고, 한글이 들어간 이름은
+//"zul_" 뒤에 영숫자는 그대로, '_'는 "__", 나머지 문자는 "_uXXXX"(코드 포인트)로 바꿔 붙임
+//예) 더하기 -> zul__uB354_uD558_uAE30
+std::string get_export_name(const std::string &name);
+
+//모듈을 위치 독립 코드로 컴파일하고 공유 라이브러리(.so)로 링크한 뒤, 내보낸 함수들의 C 헤더(.h)를 만듦
+//정의된 함수만 내보내고, 전역 변수는 라이브러리 안에서만 보이게 함
+bool write_shared(Session &session, llvm::Module &module, const std::map<std::string, FuncProtoAST> &protos);
+
+#endif //ZULLANG_SHAREDLIB_H
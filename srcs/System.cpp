@@ -3,6 +3,7 @@
 //SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include "llvm/TargetParser/Host.h"
+#include <thread>
 #include "System.h"
 
 using std::string;
@@ -16,12 +17,12 @@ using llvm::cl::ParseCommandLineOptions;
 using llvm::cl::HideUnrelatedOptions;
 using llvm::cl::SetVersionPrinter;
 using llvm::cl::opt;
+using llvm::cl::init;
+using llvm::cl::Prefix;
+using llvm::cl::list;
+using llvm::cl::CommaSeparated;
 using llvm::sys::getProcessTriple;
 
-string System::source_base_name = string();
-
-string System::target_triple = getProcessTriple();
-
 OptionCategory System::zul_opt_category = OptionCategory("zul options");
 
 opt<string> System::source_name = opt<string>(Positional, desc("<줄랭 소스파일>"), cat(zul_opt_category));
@@ -32,14 +33,52 @@ opt<bool> System::opt_compile = opt<bool>("c", desc("bitcode 파일로 컴파일
 
 opt<bool> System::opt_assembly = opt<bool>("S", desc("ll 파일로 컴파일"), cat(zul_opt_category));
 
-Logger System::logger = Logger();
+opt<bool> System::opt_shared = opt<bool>("emit-shared", desc("공유 라이브러리(.so)와 C 헤더로 컴파일"),
+                                          cat(zul_opt_category));
+
+opt<unsigned> System::opt_level = opt<unsigned>("O", desc("최적화 레벨 (0~3)"), value_desc("레벨"), Prefix, init(0),
+                                                cat(zul_opt_category));
+
+opt<unsigned> System::jobs = opt<unsigned>("j", desc("함수 코드 생성과 최적화에 사용할 스레드 수 (0이면 코어 수만큼)"),
+                                           value_desc("스레드 수"), Prefix, init(1), cat(zul_opt_category));
+
+opt<bool> System::opt_watch = opt<bool>("watch", desc("소스 파일이 바뀌면 바뀐 함수만 다시 컴파일해서 실행 중인 JIT에 반영"),
+                                         cat(zul_opt_category));
+
+opt<bool> System::opt_whole_program = opt<bool>("whole-program",
+                                                 desc("진입점과 --export로 지정한 함수 외에는 모두 내부 함수로 만들어 프로그램 전체를 최적화"),
+                                                 cat(zul_opt_category));
+
+list<string> System::exports = list<string>("export", desc("전체 프로그램 모드에서 외부에 보이게 남길 함수 (쉼표로 구분)"),
+                                            value_desc("함수 이름"), CommaSeparated, cat(zul_opt_category));
+
+opt<bool> System::opt_interp = opt<bool>("interp", desc("JIT 대신 바이트코드 인터프리터로 실행. 작은 프로그램의 시작 시간이 짧음"),
+                                          cat(zul_opt_category));
+
+opt<bool> System::opt_auto = opt<bool>("auto", desc("프로그램이 작으면 인터프리터로, 크면 JIT으로 실행"),
+                                        cat(zul_opt_category));
+
+opt<bool> System::opt_bounds_check = opt<bool>("bounds-check",
+                                                desc("크기를 아는 배열의 인덱스가 범위를 벗어나면 런타임 에러를 냄"),
+                                                cat(zul_opt_category));
+
+opt<bool> System::opt_report_tail_calls = opt<bool>("report-tail-calls",
+                                                     desc("반복문이나 꼬리 호출로 바꾼 ㅈㅈ문의 호출을 알림"),
+                                                     cat(zul_opt_category));
+
+opt<bool> System::opt_line_buffered = opt<bool>("line-buffered",
+                                                 desc("출 함수가 줄마다 출력을 바로 내보냄 (출력을 파이프로 넘겨 대화형으로 쓸 때)"),
+                                                 cat(zul_opt_category));
+
+opt<unsigned> System::threads = opt<unsigned>("threads", desc("병렬 ㄱㄱ문을 실행할 스레드 수 (0이면 코어 수만큼)"),
+                                              value_desc("스레드 수"), init(0), cat(zul_opt_category));
 
 void System::parse_arg(int argc, char **argv) {
     HideUnrelatedOptions(zul_opt_category);
 
     SetVersionPrinter([](llvm::raw_ostream &out) {
         out << "zul-lang compiler version " << ZULLANG_VERSION << '\n';
-        out << "Target: " << target_triple << '\n';
+        out << "Target: " << getProcessTriple() << '\n';
         out << "made by Lee ByungYun 2023\n";
     });
 
@@ -55,15 +94,58 @@ void System::parse_arg(int argc, char **argv) {
         exit(1);
     }
 
-    auto s_pos = source_name.rfind('\\');
-    if (s_pos == string::npos)
-        s_pos = source_name.rfind('/');
+    if (opt_level > 3) {
+        cerr << "에러: 최적화 레벨은 0~3 사이여야 합니다.\n";
+        exit(1);
+    }
 
-    if (s_pos == string::npos) {
-        source_base_name = source_name;
-    } else {
-        source_base_name = source_name.substr(s_pos + 1);
+    if (opt_shared && (opt_compile || opt_assembly)) {
+        cerr << "에러: --emit-shared 옵션은 -c, -S 옵션과 함께 사용할 수 없습니다.\n";
+        exit(1);
     }
 
-    logger.set_source_name(source_base_name);
+    if (opt_watch && (opt_compile || opt_assembly || opt_shared)) {
+        cerr << "에러: --watch 옵션은 JIT로 실행할 때만 사용할 수 있습니다.\n";
+        exit(1);
+    }
+
+    if (opt_whole_program && opt_watch) {
+        cerr << "에러: --whole-program 옵션은 --watch 옵션과 함께 사용할 수 없습니다.\n";
+        exit(1);
+    }
+
+    if (!exports.empty() && !opt_whole_program) {
+        cerr << "에러: --export 옵션은 --whole-program 옵션과 함께 사용해야 합니다.\n";
+        exit(1);
+    }
+
+    if ((opt_interp || opt_auto) && (opt_compile || opt_assembly || opt_shared || opt_watch)) {
+        cerr << "에러: --interp, --auto 옵션은 -c, -S, --emit-shared, --watch 옵션과 함께 사용할 수 없습니다.\n";
+        exit(1);
+    }
+
+    if (opt_interp && opt_auto) {
+        cerr << "에러: --interp 옵션과 --auto 옵션은 함께 사용할 수 없습니다.\n";
+        exit(1);
+    }
+
+    if (jobs == 0)
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void System::apply_args(Session &session) {
+    session.output_name = output_name;
+    session.opt_compile = opt_compile;
+    session.opt_assembly = opt_assembly;
+    session.opt_shared = opt_shared;
+    session.need_entry = !opt_shared; //라이브러리는 진입점 없이 함수만 내보낼 수 있음
+    session.opt_level = opt_level;
+    session.jobs = jobs;
+    session.whole_program = opt_whole_program;
+    session.exports.assign(exports.begin(), exports.end());
+    session.watch = opt_watch;
+    session.opt_interp = opt_interp;
+    session.opt_auto = opt_auto;
+    session.bounds_check = opt_bounds_check;
+    session.report_tail_calls = opt_report_tail_calls;
 }
@@ -10,16 +10,10 @@
 #include <string>
 #include <iostream>
 #include "llvm/Support/CommandLine.h"
-#include "Logger.h"
+#include "Session.h"
 
 class System {
 public:
-    static Logger logger;
-
-    static std::string source_base_name;
-
-    static std::string target_triple;
-
     static llvm::cl::opt<std::string> source_name;
 
     static llvm::cl::opt<std::string> output_name;
@@ -28,8 +22,34 @@ public:
 
     static llvm::cl::opt<bool> opt_assembly;
 
+    static llvm::cl::opt<bool> opt_shared;
+
+    static llvm::cl::opt<unsigned> opt_level;
+
+    static llvm::cl::opt<unsigned> jobs;
+
+    static llvm::cl::opt<bool> opt_watch;
+
+    static llvm::cl::opt<bool> opt_whole_program;
+
+    static llvm::cl::list<std::string> exports;
+
+    static llvm::cl::opt<bool> opt_interp;
+
+    static llvm::cl::opt<bool> opt_auto;
+
+    static llvm::cl::opt<bool> opt_bounds_check;
+
+    static llvm::cl::opt<bool> opt_report_tail_calls;
+
+    static llvm::cl::opt<bool> opt_line_buffered;
+
+    static llvm::cl::opt<unsigned> threads;
+
     static void parse_arg(int argc, char **argv);
 
+    static void apply_args(Session &session);
+
 private:
     static llvm::cl::OptionCategory zul_opt_category;
 };
@@ -2,10 +2,19 @@
 //SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
 //SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <atomic>
+#include <thread>
+
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/MDBuilder.h"
+
 #include "Utility.h"
+#include "Runtime.h"
 
 using std::map;
 using std::string;
+using std::vector;
 
 using llvm::LLVMContext;
 using llvm::ConstantInt;
@@ -16,13 +25,18 @@ using llvm::PointerType;
 using llvm::Value;
 using llvm::Constant;
 
-ZulValue nullzul{nullptr, -1};
+const ZulValue nullzul{nullptr, -1};
 
-map<int, string> type_name_map = {
+const map<int, string> type_name_map = {
         {id_bool,  "논리"},
         {id_char,  "글자"},
         {id_int,   "수"},
         {id_float, "실수"},
+        {id_int4, "수4"},
+        {id_int8, "수8"},
+        {id_float4, "실수4"},
+        {id_float8, "실수8"},
+        {id_region, "영역"},
 };
 
 string get_type_name(int type_id) {
@@ -31,8 +45,8 @@ string get_type_name(int type_id) {
     int ptr_cnt = type_id / TYPE_COUNTS;
     int type = type_id % TYPE_COUNTS;
     string ret;
-    ret.reserve(type_name_map[type].size() + ptr_cnt * 2);
-    ret.append(type_name_map[type]);
+    ret.reserve(type_name_map.at(type).size() + ptr_cnt * 2);
+    ret.append(type_name_map.at(type));
     if (ptr_cnt == 1) {
         ret.append("[]");
     } else if (ptr_cnt > 1){
@@ -41,6 +55,22 @@ string get_type_name(int type_id) {
     return ret;
 }
 
+int get_region_array_type(std::string_view func_name) {
+    if (!func_name.ends_with(REGION_ARRAY_SUFFIX))
+        return -1;
+    func_name.remove_suffix(std::string_view(REGION_ARRAY_SUFFIX).size());
+    for (auto &[type_id, name]: type_name_map) {
+        if (name == func_name && type_id != id_region)
+            return type_id;
+    }
+    return -1;
+}
+
+bool is_region_func_name(std::string_view func_name) {
+    return func_name == REGION_NEW_NAME || func_name == REGION_RESET_NAME || func_name == REGION_FREE_NAME ||
+           get_region_array_type(func_name) != -1;
+}
+
 Constant *get_const_zero(LLVMContext &context, int type_id) {
     return get_const_zero(get_llvm_type(context, type_id), type_id);
 }
@@ -53,15 +83,22 @@ Constant *get_const_zero(Type *llvm_type, int type_id) {
             return ConstantInt::get(llvm_type, 0, true);
         case id_float:
             return ConstantFP::get(llvm_type, 0);
-        case 4:
+        case id_int4:
+        case id_int8:
+        case id_float4:
+        case id_float8:
+            return Constant::getNullValue(llvm_type);
+        case id_region:
             return ConstantPointerNull::get(static_cast<PointerType *>(llvm_type));
         default:
+            if (type_id >= TYPE_COUNTS)
+                return ConstantPointerNull::get(static_cast<PointerType *>(llvm_type));
             return nullptr;
     }
 }
 
 Type *get_llvm_type(LLVMContext &context, int type_id) {
-    if (type_id > TYPE_COUNTS) {
+    if (type_id >= TYPE_COUNTS) {
         return PointerType::getUnqual(context);
     }
     switch (type_id) {
@@ -73,15 +110,69 @@ Type *get_llvm_type(LLVMContext &context, int type_id) {
             return Type::getInt64Ty(context);
         case id_float:
             return Type::getDoubleTy(context);
+        case id_int4:
+        case id_int8:
+        case id_float4:
+        case id_float8:
+            return llvm::FixedVectorType::get(get_llvm_type(context, get_lane_type(type_id)), get_lane_count(type_id));
+        case id_region:
+            return PointerType::getUnqual(context);
         default:
             return Type::getVoidTy(context);
     }
 }
 
+bool is_arithmetic_type(int type_id) {
+    return id_bool <= type_id && type_id < TYPE_COUNTS && type_id != id_region;
+}
+
+bool is_vector_type(int type_id) {
+    return id_int4 <= type_id && type_id <= id_float8;
+}
+
+int get_lane_type(int type_id) {
+    if (!is_vector_type(type_id))
+        return type_id;
+    return type_id < id_float4 ? id_int : id_float;
+}
+
+unsigned get_lane_count(int type_id) {
+    if (!is_vector_type(type_id))
+        return 1;
+    return (type_id - id_int4) % 2 == 0 ? 4 : 8;
+}
+
+int get_vector_type(int lane_type, unsigned lanes) {
+    if ((lane_type != id_int && lane_type != id_float) || (lanes != 4 && lanes != 8))
+        return -1;
+    return (lane_type == id_int ? id_int4 : id_float4) + (lanes == 8);
+}
+
 bool create_cast(ZulContext &zulctx, ZulValue &target, int dest_type_id) {
     bool cast = true;
     if (target.second < 0)
         return false;
+    if (target.second == id_region || dest_type_id == id_region) //영역은 영역()이 돌려준 값만 쓸 수 있음
+        return target.second == dest_type_id;
+    if (is_vector_type(target.second) || is_vector_type(dest_type_id)) {
+        //스칼라는 원소 타입으로 바꿔서 모든 원소에 복사하고, 벡터끼리는 원소 개수가 같을 때만 원소마다 캐스팅함
+        if (!is_vector_type(dest_type_id) || target.second >= TYPE_COUNTS)
+            return false;
+        auto lanes = get_lane_count(dest_type_id);
+        auto lane_type = get_lane_type(dest_type_id);
+        if (!is_vector_type(target.second)) {
+            if (target.second != lane_type && !create_cast(zulctx, target, lane_type))
+                return false;
+            target.first = zulctx.builder.CreateVectorSplat(lanes, target.first);
+        } else if (get_lane_count(target.second) != lanes) {
+            return false;
+        } else if (lane_type == id_float) {
+            target.first = zulctx.builder.CreateSIToFP(target.first, get_llvm_type(*zulctx.context, dest_type_id));
+        } else {
+            target.first = zulctx.builder.CreateFPToSI(target.first, get_llvm_type(*zulctx.context, dest_type_id));
+        }
+        return true;
+    }
     if (dest_type_id == id_float) {
         target.first = zulctx.builder.CreateSIToFP(target.first, Type::getDoubleTy(*zulctx.context));
     } else if (dest_type_id == id_bool) {
@@ -138,7 +229,7 @@ Value *create_int_operation(ZulContext &zulctx, Value *lhs, Value *rhs, Capture<
         case tok_lteq:
             return zulctx.builder.CreateICmpSLE(lhs, rhs);
         default:
-            System::logger.log_error(op.loc, op.word_size, {"해당 연산자를 \"", type_name_map[id_int] ,"\" 타입에 적용할 수 없습니다"});
+            zulctx.logger.log_error(op.loc, op.word_size, {"해당 연산자를 \"", type_name_map.at(id_int) ,"\" 타입에 적용할 수 없습니다"});
             return nullptr;
     }
 }
@@ -168,7 +259,7 @@ Value *create_float_operation(ZulContext &zulctx, Value *lhs, Value *rhs, Captur
         case tok_lteq:
             return zulctx.builder.CreateFCmpOLE(lhs, rhs);
         default:
-            System::logger.log_error(op.loc, op.word_size, {"해당 연산자를 \"", type_name_map[id_float] ,"\" 타입에 적용할 수 없습니다"});
+            zulctx.logger.log_error(op.loc, op.word_size, {"해당 연산자를 \"", type_name_map.at(id_float) ,"\" 타입에 적용할 수 없습니다"});
             return nullptr;
     }
 }
@@ -188,6 +279,8 @@ bool is_cmp(Token op) {
 }
 
 bool to_boolean_expr(ZulContext &zulctx, ZulValue &expr) {
+    if (expr.second > id_float) //배열과 벡터는 조건으로 쓸 수 없음
+        return false;
     if (expr.second == id_float) {
         expr.first = zulctx.builder.CreateFCmpONE(expr.first, ConstantFP::get(expr.first->getType(), 0));
     } else if (expr.second != id_bool) {
@@ -199,6 +292,234 @@ bool to_boolean_expr(ZulContext &zulctx, ZulValue &expr) {
     return true;
 }
 
+Value *create_arena_alloc(llvm::IRBuilderBase &builder, Value *bytes) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto ptr_type = PointerType::getUnqual(builder.getContext());
+    auto callee = module->getOrInsertFunction("zul_arena_alloc", ptr_type, builder.getInt64Ty());
+    auto call = builder.CreateCall(callee, {bytes});
+    //다른 포인터와 겹치지 않고 정렬되어 있음을 알려서 원소 접근을 최적화할 수 있게 함
+    call->addRetAttr(llvm::Attribute::NoAlias);
+    call->addRetAttr(llvm::Attribute::getWithAlignment(builder.getContext(), llvm::Align(ARENA_ALIGN)));
+    return call;
+}
+
+Value *create_arena_mark(llvm::IRBuilderBase &builder) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto callee = module->getOrInsertFunction("zul_arena_mark", PointerType::getUnqual(builder.getContext()));
+    return builder.CreateCall(callee, {}, "arena_mark");
+}
+
+void create_arena_release(llvm::IRBuilderBase &builder, Value *mark) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto ptr_type = PointerType::getUnqual(builder.getContext());
+    auto callee = module->getOrInsertFunction("zul_arena_release", builder.getVoidTy(), ptr_type);
+    builder.CreateCall(callee, {mark});
+}
+
+bool points_to_arena(llvm::ArrayRef<Value *> values) {
+    auto is_arena_alloc = [](const Value *object) {
+        auto call = llvm::dyn_cast<llvm::CallInst>(object);
+        return call && call->getCalledFunction() && call->getCalledFunction()->getName() == "zul_arena_alloc";
+    };
+    for (auto value: values) {
+        if (!value->getType()->isPointerTy())
+            continue;
+        llvm::SmallVector<const Value *, 4> objects;
+        llvm::getUnderlyingObjects(value, objects, nullptr, 0); //중간에 멈추면 아레나 배열을 놓칠 수 있으므로 끝까지 따라감
+        if (llvm::any_of(objects, is_arena_alloc))
+            return true;
+    }
+    return false;
+}
+
+Value *create_region_new(llvm::IRBuilderBase &builder) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto callee = module->getOrInsertFunction("zul_region_new", PointerType::getUnqual(builder.getContext()));
+    return builder.CreateCall(callee, {}, "region");
+}
+
+Value *create_region_alloc(llvm::IRBuilderBase &builder, Value *region, Value *bytes) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto ptr_type = PointerType::getUnqual(builder.getContext());
+    auto callee = module->getOrInsertFunction("zul_region_alloc", ptr_type, ptr_type, builder.getInt64Ty());
+    auto call = builder.CreateCall(callee, {region, bytes});
+    call->addRetAttr(llvm::Attribute::NoAlias);
+    call->addRetAttr(llvm::Attribute::getWithAlignment(builder.getContext(), llvm::Align(ARENA_ALIGN)));
+    return call;
+}
+
+llvm::CallInst *create_region_release(llvm::IRBuilderBase &builder, Value *region, bool free) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto callee = module->getOrInsertFunction(free ? "zul_region_free" : "zul_region_reset", builder.getVoidTy(),
+                                              PointerType::getUnqual(builder.getContext()));
+    return builder.CreateCall(callee, {region});
+}
+
+llvm::CallInst *create_prefix_sum(llvm::IRBuilderBase &builder, Value *data, Value *count, bool is_float) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto callee = module->getOrInsertFunction(is_float ? "zul_prefix_sum_f64" : "zul_prefix_sum_i64",
+                                              builder.getVoidTy(), PointerType::getUnqual(builder.getContext()),
+                                              builder.getInt64Ty());
+    return builder.CreateCall(callee, {data, count});
+}
+
+llvm::CallInst *create_read(llvm::IRBuilderBase &builder, int type_id, Value *dst, bool skip_space) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto void_type = builder.getVoidTy();
+    auto ptr_type = PointerType::getUnqual(builder.getContext());
+    if (type_id >= TYPE_COUNTS * 2) //지역 배열
+        type_id -= TYPE_COUNTS;
+    switch (type_id) {
+        case id_int:
+            return builder.CreateCall(module->getOrInsertFunction("zul_read_int", void_type, ptr_type), {dst});
+        case id_float:
+            return builder.CreateCall(module->getOrInsertFunction("zul_read_float", void_type, ptr_type), {dst});
+        case id_bool:
+            return builder.CreateCall(module->getOrInsertFunction("zul_read_bool", void_type, ptr_type), {dst});
+        case id_char:
+            return builder.CreateCall(module->getOrInsertFunction("zul_read_char", void_type, ptr_type, builder.getInt64Ty()),
+                                      {dst, builder.getInt64(skip_space)});
+        case id_char + TYPE_COUNTS:
+            return builder.CreateCall(module->getOrInsertFunction("zul_read_str", void_type, ptr_type), {dst});
+        default:
+            return nullptr;
+    }
+}
+
+llvm::CallInst *create_write(llvm::IRBuilderBase &builder, int type_id, Value *value) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto void_type = builder.getVoidTy();
+    if (type_id >= TYPE_COUNTS * 2) //지역 배열
+        type_id -= TYPE_COUNTS;
+    switch (type_id) {
+        case id_int:
+            return builder.CreateCall(module->getOrInsertFunction("zul_write_int", void_type, builder.getInt64Ty()), {value});
+        case id_float:
+            return builder.CreateCall(module->getOrInsertFunction("zul_write_float", void_type, builder.getDoubleTy()), {value});
+        case id_bool: { //C의 bool, char 인자는 호출하는 쪽에서 확장해서 넘겨야 함
+            auto call = builder.CreateCall(module->getOrInsertFunction("zul_write_bool", void_type, builder.getInt1Ty()), {value});
+            call->addParamAttr(0, llvm::Attribute::ZExt);
+            return call;
+        }
+        case id_char: {
+            auto call = builder.CreateCall(module->getOrInsertFunction("zul_write_char", void_type, builder.getInt8Ty()), {value});
+            call->addParamAttr(0, llvm::Attribute::SExt);
+            return call;
+        }
+        case id_char + TYPE_COUNTS:
+            return builder.CreateCall(module->getOrInsertFunction("zul_write_str", void_type, value->getType()), {value});
+        default: //다른 배열은 주소를 출력함
+            return builder.CreateCall(module->getOrInsertFunction("zul_write_ptr", void_type, value->getType()), {value});
+    }
+}
+
+Value *create_vector_reduce(llvm::IRBuilderBase &builder, Value *vector, Token op, bool is_float) {
+    if (is_float) {
+        llvm::CallInst *call;
+        switch (op) {
+            case tok_add:
+                call = builder.CreateFAddReduce(get_reduction_identity(builder.getDoubleTy(), op), vector);
+                break;
+            case tok_mul:
+                call = builder.CreateFMulReduce(get_reduction_identity(builder.getDoubleTy(), op), vector);
+                break;
+            case tok_lt:
+                return builder.CreateFPMinReduce(vector);
+            default:
+                return builder.CreateFPMaxReduce(vector);
+        }
+        //원소를 순서대로 더하지 않아도 되게 해서 트리 모양으로 더하는 명령어를 쓸 수 있게 함
+        call->setHasAllowReassoc(true);
+        return call;
+    }
+    switch (op) {
+        case tok_add:
+            return builder.CreateAddReduce(vector);
+        case tok_mul:
+            return builder.CreateMulReduce(vector);
+        case tok_lt:
+            return builder.CreateIntMinReduce(vector, true);
+        default:
+            return builder.CreateIntMaxReduce(vector, true);
+    }
+}
+
+Constant *get_reduction_identity(Type *type, Token op) {
+    if (type->isDoubleTy()) {
+        auto &semantics = type->getFltSemantics();
+        switch (op) {
+            case tok_add:
+                return ConstantFP::get(type, llvm::APFloat::getZero(semantics, true)); //-0.0 + x == x
+            case tok_mul:
+                return ConstantFP::get(type, 1.0);
+            case tok_lt:
+                return ConstantFP::get(type, llvm::APFloat::getInf(semantics));
+            default:
+                return ConstantFP::get(type, llvm::APFloat::getInf(semantics, true));
+        }
+    }
+    auto bits = type->getIntegerBitWidth();
+    switch (op) {
+        case tok_mul:
+            return ConstantInt::get(type, 1);
+        case tok_bitand:
+            return ConstantInt::get(type, llvm::APInt::getAllOnes(bits));
+        case tok_lt:
+            return ConstantInt::get(type, llvm::APInt::getSignedMaxValue(bits));
+        case tok_gt:
+            return ConstantInt::get(type, llvm::APInt::getSignedMinValue(bits));
+        default:
+            return ConstantInt::get(type, 0);
+    }
+}
+
+void create_parallel_for(llvm::IRBuilderBase &builder, llvm::Function *body, Value *ctx, Value *count) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto ptr_type = PointerType::getUnqual(builder.getContext());
+    auto callee = module->getOrInsertFunction("zul_parallel_for", builder.getVoidTy(), ptr_type, ptr_type,
+                                              builder.getInt64Ty());
+    builder.CreateCall(callee, {body, ctx, count});
+}
+
+void create_parallel_reduce(llvm::IRBuilderBase &builder, llvm::Function *body, Value *ctx, Value *count,
+                            llvm::Function *combine, Value *result, Value *identity, Value *size) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto ptr_type = PointerType::getUnqual(builder.getContext());
+    auto int_type = builder.getInt64Ty();
+    auto callee = module->getOrInsertFunction("zul_parallel_reduce", builder.getVoidTy(), ptr_type, ptr_type, int_type,
+                                              ptr_type, ptr_type, ptr_type, int_type);
+    builder.CreateCall(callee, {body, ctx, count, combine, result, identity, size});
+}
+
+llvm::Align get_array_align(const llvm::DataLayout &layout, Type *arr_type) {
+    auto align = layout.getPrefTypeAlign(arr_type);
+    if (layout.getTypeAllocSize(arr_type).getFixedValue() >= ARRAY_ALIGN)
+        align = std::max(align, llvm::Align(ARRAY_ALIGN));
+    return align;
+}
+
+void set_tbaa(llvm::Instruction *inst, int type_id) {
+    //같은 내용의 메타데이터는 컨텍스트 안에서 하나로 합쳐지므로 매번 새로 만들어도 됨
+    llvm::MDBuilder md_builder(inst->getContext());
+    auto root = md_builder.createTBAARoot("줄랭 TBAA");
+    auto type_node = md_builder.createTBAAScalarTypeNode(get_type_name(type_id), root);
+    inst->setMetadata(llvm::LLVMContext::MD_tbaa, md_builder.createTBAAStructTagNode(type_node, type_node, 0));
+}
+
+void create_bounds_fail(llvm::IRBuilderBase &builder, Value *index, Value *size, int line) {
+    auto module = builder.GetInsertBlock()->getModule();
+    auto int_type = builder.getInt64Ty();
+    auto callee = module->getOrInsertFunction("zul_bounds_fail", builder.getVoidTy(), int_type, int_type, int_type);
+    if (auto func = llvm::dyn_cast<llvm::Function>(callee.getCallee())) {
+        func->setDoesNotReturn();
+        func->setDoesNotThrow();
+        func->addFnAttr(llvm::Attribute::Cold);
+    }
+    auto call = builder.CreateCall(callee, {index, size, builder.getInt64(line)});
+    call->setDoesNotReturn();
+    builder.CreateUnreachable();
+}
+
 bool iskor(int c) {
     return (0x1100 <= c && c <= 0x11FF) || (0x3130 <= c && c <= 0x318F) || (0xA960 <= c && c <= 0xA97F) ||
            (0xAC00 <= c && c <= 0xD7AF) || (0xD7B0 <= c && c <= 0xD7FF);
@@ -211,3 +532,20 @@ bool isnum(int c) {
 bool iskornum(int c) {
     return iskor(c) || isnum(c);
 }
+
+void parallel_for(size_t count, unsigned jobs, const std::function<void(size_t)> &func) {
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+        for (auto idx = next++; idx < count; idx = next++) {
+            func(idx);
+        }
+    };
+    vector<std::thread> threads;
+    for (size_t i = 1; i < std::min<size_t>(jobs, count); ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
@@ -8,6 +8,7 @@
 #include <utility>
 #include <map>
 #include <string>
+#include <string_view>
 #include <functional>
 
 #include <llvm/IR/Instructions.h>
@@ -17,23 +18,39 @@
 #include "llvm/IR/Type.h"
 
 #include "ZulContext.h"
-#include "System.h"
 #include "Lexer.h"
 
-#define TYPE_COUNTS 4 //기본 타입의 개수
+#define TYPE_COUNTS 9 //기본 타입의 개수. 벡터 타입과 영역도 기본 타입에 포함됨
 #define ENTRY_FN_NAME "시작" //진입점 함수 이름
 #define STDIN_NAME "입"
 #define STDOUT_NAME "출"
+#define PREFIX_SUM_NAME "누적합"
+#define REGION_NEW_NAME "영역"
+#define REGION_RESET_NAME "영역비우기"
+#define REGION_FREE_NAME "영역해제"
+#define REGION_ARRAY_SUFFIX "배열" //"수배열(영역, 개수)"처럼 타입 이름 뒤에 붙이면 영역에 배열을 할당하는 함수가 됨
+#define VECTOR_STORE_NAME "벡터쓰기"
+#define VECTOR_SHUFFLE_NAME "벡터섞기"
+#define VECTOR_SUM_NAME "벡터합"
+#define VECTOR_PRODUCT_NAME "벡터곱"
+#define VECTOR_MIN_NAME "벡터최소"
+#define VECTOR_MAX_NAME "벡터최대"
+#define ARRAY_ALIGN 64 //캐시 라인 하나 이상인 배열의 정렬. 벡터화된 반복문이 정렬된 주소부터 읽을 수 있게 함
 
 enum TypeID {
     id_bool,
     id_char,
     id_int,
     id_float,
+    id_int4, //수 4개를 한 번에 계산하는 벡터
+    id_int8,
+    id_float4,
+    id_float8,
+    id_region, //런타임 영역의 주소. 영역()만 만들 수 있고 연산하거나 다른 타입과 캐스팅 할 수 없음
     id_interrupt = -10
 };
 
-extern ZulValue nullzul;
+extern const ZulValue nullzul;
 
 template<typename T>
 struct Capture {
@@ -68,12 +85,33 @@ struct Guard {
 
 std::string get_type_name(int type_id);
 
+//영역에 배열을 할당하는 함수 이름이면 원소 타입, 아니면 -1
+int get_region_array_type(std::string_view func_name);
+
+//영역(), 영역비우기(), 영역해제(), 수배열() 같은 영역 함수의 이름인지
+bool is_region_func_name(std::string_view func_name);
+
 llvm::Constant *get_const_zero(llvm::Type *llvm_type, int type_id);
 
 llvm::Constant *get_const_zero(llvm::LLVMContext &context, int type_id);
 
 llvm::Type *get_llvm_type(llvm::LLVMContext &context, int type_id);
 
+//연산자와 수학 함수를 쓸 수 있는 타입인지. 배열과 영역은 계산할 수 없음
+bool is_arithmetic_type(int type_id);
+
+//수4, 수8, 실수4, 실수8 벡터 타입인지. 벡터는 LLVM 벡터 타입이 되고 원소마다 같은 연산을 함
+bool is_vector_type(int type_id);
+
+//벡터 원소의 타입. 벡터가 아니면 type_id를 그대로 돌려줌
+int get_lane_type(int type_id);
+
+//벡터 원소의 개수
+unsigned get_lane_count(int type_id);
+
+//원소 타입과 개수에 맞는 벡터 타입. 없으면 -1
+int get_vector_type(int lane_type, unsigned lanes);
+
 bool create_cast(ZulContext &zulctx, ZulValue &target, int dest_type_id);
 
 llvm::Value *create_int_operation(ZulContext &zulctx, llvm::Value *lhs, llvm::Value *rhs, Capture<Token> &op);
@@ -84,6 +122,55 @@ bool is_cmp(Token op);
 
 bool to_boolean_expr(ZulContext &zulctx, ZulValue &expr);
 
+//arr_type 배열의 정렬. 캐시 라인보다 작은 배열은 원래 정렬을 그대로 사용함
+llvm::Align get_array_align(const llvm::DataLayout &layout, llvm::Type *arr_type);
+
+//메모리를 읽고 쓰는 명령에 타입 정보(TBAA)를 붙임. 줄랭에는 포인터 캐스팅이 없으므로 타입이 다른 메모리는 서로 겹치지 않음
+void set_tbaa(llvm::Instruction *inst, int type_id);
+
+//Runtime.h의 아레나 함수를 호출함. 함수 선언은 없으면 모듈에 추가함
+llvm::Value *create_arena_alloc(llvm::IRBuilderBase &builder, llvm::Value *bytes);
+
+llvm::Value *create_arena_mark(llvm::IRBuilderBase &builder);
+
+void create_arena_release(llvm::IRBuilderBase &builder, llvm::Value *mark);
+
+//값 중에 아레나에 할당한 배열을 가리킬 수 있는 것이 있는지. phi를 끝까지 따라가므로 함수가 다 만들어진 뒤에 써야 정확함
+bool points_to_arena(llvm::ArrayRef<llvm::Value *> values);
+
+//Runtime.h의 영역 함수를 호출함. 영역에서 할당한 메모리는 0으로 채워져 있음
+llvm::Value *create_region_new(llvm::IRBuilderBase &builder);
+
+llvm::Value *create_region_alloc(llvm::IRBuilderBase &builder, llvm::Value *region, llvm::Value *bytes);
+
+//free가 참이면 영역까지 해제하고, 아니면 할당한 배열만 한 번에 해제하고 메모리는 다음 할당에 재사용함
+llvm::CallInst *create_region_release(llvm::IRBuilderBase &builder, llvm::Value *region, bool free);
+
+//zul_prefix_sum_i64나 zul_prefix_sum_f64를 호출해서 data의 앞 count개를 제자리에서 누적합으로 바꿈
+llvm::CallInst *create_prefix_sum(llvm::IRBuilderBase &builder, llvm::Value *data, llvm::Value *count, bool is_float);
+
+//Runtime.h의 입력 함수로 type_id 변수 하나를 dst에 읽음. 입력받을 수 없는 타입이면 nullptr
+llvm::CallInst *create_read(llvm::IRBuilderBase &builder, int type_id, llvm::Value *dst, bool skip_space);
+
+//Runtime.h의 출력 함수로 type_id 값 하나를 출 함수의 줄 버퍼에 씀. 글자 배열이 아닌 배열은 주소를 씀
+llvm::CallInst *create_write(llvm::IRBuilderBase &builder, int type_id, llvm::Value *value);
+
+//병렬 ㄱㄱ문의 누적 변수의 초깃값. 어떤 값과 합쳐도 그 값이 그대로 나옴. 최소는 tok_lt, 최대는 tok_gt
+llvm::Constant *get_reduction_identity(llvm::Type *type, Token op);
+
+//llvm.vector.reduce.*로 벡터의 원소를 모두 합침. 최소는 tok_lt, 최대는 tok_gt. 실수의 합과 곱은 순서 없이 계산함
+llvm::Value *create_vector_reduce(llvm::IRBuilderBase &builder, llvm::Value *vector, Token op, bool is_float);
+
+//zul_parallel_for를 호출해서 body의 [0, count) 번째 반복을 스레드 풀에서 나눠 실행함
+void create_parallel_for(llvm::IRBuilderBase &builder, llvm::Function *body, llvm::Value *ctx, llvm::Value *count);
+
+//zul_parallel_reduce를 호출함. 스레드마다 identity를 복사한 누적값으로 body를 실행하고, 끝나면 combine으로 result에 합침
+void create_parallel_reduce(llvm::IRBuilderBase &builder, llvm::Function *body, llvm::Value *ctx, llvm::Value *count,
+                            llvm::Function *combine, llvm::Value *result, llvm::Value *identity, llvm::Value *size);
+
+//zul_bounds_fail을 호출하고 블록을 unreachable로 끝냄
+void create_bounds_fail(llvm::IRBuilderBase &builder, llvm::Value *index, llvm::Value *size, int line);
+
 bool iskor(int c);
 
 bool isnum(int c);
@@ -92,4 +179,7 @@ bool iskornum(int c);
 
 std::string token_to_string(Token token); //토큰을 문자열로 출력
 
+//0부터 count - 1까지의 작업을 최대 jobs개의 스레드가 순서대로 하나씩 가져가서 처리함. 호출한 스레드도 작업에 참여함
+void parallel_for(size_t count, unsigned jobs, const std::function<void(size_t)> &func);
+
 #endif //ZULLANG_UTILITY_H
@@ -2,13 +2,43 @@
 //SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
 //SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <algorithm>
+
 #include "ZulContext.h"
+#include "Utility.h"
+
+ZulContext::ZulContext(Session &session) : session(session), logger(session.logger) {}
+
+static llvm::GlobalVariable *create_pooled_constant(llvm::Module &module, llvm::Constant *init, const char *name) {
+    auto global_var = new llvm::GlobalVariable(module, init->getType(), true, llvm::GlobalValue::PrivateLinkage,
+                                               init, name);
+    global_var->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    return global_var;
+}
+
+llvm::GlobalVariable *ConstantPool::get_string(llvm::Module &module, llvm::StringRef str) {
+    auto &global_var = strings[str];
+    if (!global_var) {
+        global_var = create_pooled_constant(module, llvm::ConstantDataArray::getString(module.getContext(), str), ".str");
+        global_var->setAlignment(llvm::Align(1));
+    }
+    return global_var;
+}
+
+llvm::GlobalVariable *ConstantPool::get_array(llvm::Module &module, llvm::Constant *init) {
+    auto &global_var = arrays[init];
+    if (!global_var) {
+        global_var = create_pooled_constant(module, init, ".arr");
+        global_var->setAlignment(get_array_align(module.getDataLayout(), init->getType()));
+    }
+    return global_var;
+}
 
-ZulContext::ZulContext() {
+SymbolTable::SymbolTable(const GlobalVarMap &global_var_map) : global_var_map(global_var_map) {
     local_var_map.reserve(50);
 }
 
-void ZulContext::remove_scope_vars() {
+void SymbolTable::remove_scope_vars() {
     //스코프 벗어날 때 생성한 변수들 맵에서 삭제 (IR코드에는 남아있음. 맵에서 지워서 접근만 막는 것)
     auto &cur_scope_vars = scope_stack.top();
     for (auto &name: cur_scope_vars) {
@@ -17,6 +47,29 @@ void ZulContext::remove_scope_vars() {
     scope_stack.pop();
 }
 
-bool ZulContext::var_exist(const std::string &name) {
+bool SymbolTable::var_exist(const std::string &name) {
     return global_var_map.contains(name) || local_var_map.contains(name);
 }
+
+LocalVar *SymbolTable::declare_local(const std::string &name, int type) {
+    auto &var = local_vars.emplace_back(LocalVar{name, type});
+    local_var_map[name] = &var;
+    if (!scope_stack.empty()) { //만약 스코프 안에 있다면
+        scope_stack.top().push_back(name); //가장 가까운 스코프에 변수 등록
+    }
+    return &var;
+}
+
+void SymbolTable::use_local(LocalVar *var) {
+    for (auto &scope: parallel_scopes) {
+        if (scope.outer_vars.contains(var) && std::find(scope.captures.begin(), scope.captures.end(), var) ==
+                                              scope.captures.end())
+            scope.captures.push_back(var);
+    }
+}
+
+bool SymbolTable::is_parallel_readonly(LocalVar *var) const {
+    return std::any_of(parallel_scopes.begin(), parallel_scopes.end(), [var](const ParallelScope &scope) {
+        return scope.index_var == var || scope.outer_vars.contains(var);
+    });
+}
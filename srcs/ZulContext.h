@@ -5,44 +5,158 @@
 #ifndef ZULC_ZULCONTEXT_H
 #define ZULC_ZULCONTEXT_H
 
+#include <deque>
 #include <memory>
 #include <utility>
 #include <map>
 #include <stack>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 
-#include "System.h"
+#include "Session.h"
+#include "SSABuilder.h"
 
 struct ExprAST;
 
 using ZulValue = std::pair<llvm::Value *, int>;
 using ASTPtr = std::unique_ptr<ExprAST>;
 using CondBodyPair = std::pair<ASTPtr, std::vector<ASTPtr>>;
+using GlobalVarMap = std::map<std::string, std::pair<llvm::GlobalVariable *, int>>;
 
-//현재 진행 상태에서 파싱과 코드 생성의 모든 정보를 담는 콘텍스트 객체
+//지역 변수 심볼. 파싱할 때 한 번 만들어지고, 변수를 사용하는 AST들이 직접 가리킴
+struct LocalVar {
+    std::string name;
+    int type; //배열은 포인터 타입으로 저장됨
+    bool address_taken = false; //입 함수처럼 주소가 필요한 변수만 alloca로 만들고, 나머지는 SSA 값으로 만듦
+    llvm::WeakTrackingVH array_size{}; //지역 배열의 원소 개수. 코드 생성 때 채워짐
+    llvm::AllocaInst *alloca = nullptr; //코드 생성 때 채워짐
+};
+
+//--bounds-check로 만든 인덱스 검사. 반복문을 다 만든 뒤에 범위를 증명할 수 있으면 지우거나 반복문 밖으로 올림
+struct BoundsCheck {
+    llvm::BranchInst *branch; //참이면 범위 안. 지우거나 바꾼 검사는 nullptr
+    llvm::WeakTrackingVH index;
+    llvm::WeakTrackingVH size;
+};
+
+//몸체에 인덱스 검사가 있는 반복문. 바깥 반복문의 phi까지 모두 정해진 뒤에 분석해야 하므로 함수를 다 만들고 처리함
+struct CheckedLoop {
+    llvm::BranchInst *enter_br; //반복문에 들어가는 분기
+    llvm::BranchInst *test_br;
+    llvm::BranchInst *latch_br; //갱신 블록에서 조건 블록으로 돌아가는 분기
+    size_t first_check; //몸체에서 만든 검사의 범위
+    size_t last_check;
+};
+
+//ㅈㅈ문에서 결과를 바로 반환해서 꼬리 호출로 표시한 호출. 함수를 다 만든 뒤에 musttail을 유지할 수 있는지 확인함
+struct TailCall {
+    llvm::CallInst *call;
+    std::pair<int, int> loc; //ㅈㅈ의 위치
+    unsigned word_size;
+};
+
+//반복문으로 바꾼 꼬리 재귀. 다음 반복으로 넘기는 인자가 아레나 배열이 아니면 점프하기 전에 아레나를 해제함
+struct TailJump {
+    llvm::BranchInst *branch;
+    std::vector<llvm::WeakTrackingVH> args;
+};
+
+//배열을 반환하는 ㅈㅈ문. 반환하는 배열이 아레나에 있으면 함수가 끝날 때 해제되므로 에러를 냄
+struct ArrayReturn {
+    llvm::WeakTrackingVH value;
+    std::pair<int, int> loc; //ㅈㅈ의 위치
+    unsigned word_size;
+};
+
+//병렬 ㄱㄱ문의 몸체를 파싱하는 동안의 정보. 몸체는 따로 함수로 만들어지므로 바깥 지역 변수는 값을 복사해서 넘김
+struct ParallelScope {
+    std::unordered_set<LocalVar *> outer_vars; //ㄱㄱ문 앞에서 보이던 지역 변수. 몸체에서는 읽기만 할 수 있음
+    LocalVar *index_var;
+    std::vector<LocalVar *> captures; //몸체에서 사용한 바깥 지역 변수. 사용한 순서대로 들어감
+};
+
+//파싱 중에 보이는 변수들. 함수 몸체마다 따로 만들어지므로 여러 몸체를 동시에 파싱할 수 있음
+struct SymbolTable {
+    const GlobalVarMap &global_var_map; //몸체를 파싱하는 동안에는 읽기만 함
+    std::deque<LocalVar> local_vars; //지역 변수 심볼 저장소. 주소가 바뀌지 않도록 deque 사용
+    std::unordered_map<std::string, LocalVar *> local_var_map; //현재 스코프에서 보이는 지역 변수
+    std::stack<std::vector<std::string>> scope_stack;
+    int ret_count = 0;
+    int self_tail_calls = 0; //ㅈㅈ문에서 자기 자신을 호출한 결과를 바로 반환하는 횟수
+    bool in_loop = false;
+    bool in_parallel_body = false; //가장 안쪽 반복문이 병렬 ㄱㄱ문인지. ㅅㄱ문으로 빠져나갈 수 없음
+    std::vector<ParallelScope> parallel_scopes; //바깥쪽 병렬 ㄱㄱ문부터 들어감
+
+    explicit SymbolTable(const GlobalVarMap &global_var_map);
+
+    bool var_exist(const std::string &name);
+
+    LocalVar *declare_local(const std::string &name, int type);
+
+    void remove_scope_vars();
+
+    //몸체에서 var를 사용함. 병렬 ㄱㄱ문 바깥의 변수면 그 ㄱㄱ문이 값을 넘겨야 함
+    void use_local(LocalVar *var);
+
+    //병렬 ㄱㄱ문 안에서 바꿀 수 없는 변수인지 (바깥 지역 변수, 반복 변수)
+    bool is_parallel_readonly(LocalVar *var) const;
+};
+
+//모듈 안에서 같은 값의 읽기 전용 전역 상수를 하나만 만들기 위한 표. 문자열 리터럴과 지역 배열의 상수 초깃값이 들어감
+//모두 private unnamed_addr 상수라 주소를 비교할 수 없으므로 같은 값끼리 나눠 써도 됨
+struct ConstantPool {
+    llvm::StringMap<llvm::GlobalVariable *> strings;
+    llvm::DenseMap<llvm::Constant *, llvm::GlobalVariable *> arrays; //상수는 콘텍스트마다 값이 같으면 같은 객체임
+
+    //널 문자로 끝나는 문자열 상수
+    llvm::GlobalVariable *get_string(llvm::Module &module, llvm::StringRef str);
+
+    llvm::GlobalVariable *get_array(llvm::Module &module, llvm::Constant *init);
+};
+
+//컴파일 타임에 미리 계산한 함수 호출의 결과. 계산하지 못했으면 value가 비어 있고 fail_reason에 이유가 들어감
+struct FoldResult {
+    ZulValue value;
+    std::string fail_reason;
+};
+
+using FoldKey = std::pair<std::string, std::vector<llvm::Constant *>>; //함수 이름과 파라미터 타입으로 캐스팅한 인자
+
+//현재 진행 상태에서 코드 생성의 모든 정보를 담는 콘텍스트 객체
 struct ZulContext {
+    Session &session;
+    Logger &logger; //session.logger
     std::unique_ptr<llvm::LLVMContext> context{new llvm::LLVMContext{}};
-    std::unique_ptr<llvm::Module> module{new llvm::Module{System::source_base_name, *context}};
+    std::unique_ptr<llvm::Module> module{new llvm::Module{session.source_base_name, *context}};
     llvm::IRBuilder<> builder{*context};
-    std::map<std::string, std::pair<llvm::GlobalVariable *, int>> global_var_map;
-    std::unordered_map<std::string, std::pair<llvm::AllocaInst *, int>> local_var_map;
-    std::stack<std::vector<std::string>> scope_stack;
+    GlobalVarMap global_var_map;
+    ConstantPool const_pool;
+    std::map<FoldKey, FoldResult> fold_cache; //같은 함수를 같은 상수 인자로 다시 부르면 계산하지 않고 결과를 그대로 씀
+    std::unordered_set<std::string> unfoldable_funcs; //계산 횟수 제한을 넘긴 적이 있어 더는 미리 계산하지 않는 함수
     std::stack<llvm::BasicBlock *> loop_update_stack;
     std::stack<llvm::BasicBlock *> loop_end_stack;
     llvm::BasicBlock *return_block{};
     llvm::AllocaInst *return_var{};
+    SSABuilder ssa; //alloca가 없는 지역 변수의 값
+    std::vector<std::pair<llvm::AllocaInst *, uint64_t>> scope_arrays; //현재 스코프까지 스택에 만든 배열과 바이트 크기
+    int arena_allocs = 0; //현재 함수에서 아레나에 할당하는 배열 선언의 수
+    std::vector<BoundsCheck> bounds_checks; //현재 함수의 인덱스 검사
+    std::vector<CheckedLoop> checked_loops; //안쪽 반복문부터 끝나는 순서대로 들어감
+    std::vector<llvm::Function *> outlined_funcs; //현재 함수의 병렬 ㄱㄱ문 몸체로 만든 함수
+    llvm::BasicBlock *tail_entry{}; //꼬리 재귀가 돌아가는 블록. 꼬리 재귀를 반복문으로 바꾸지 않는 함수면 nullptr
+    std::vector<TailCall> tail_calls; //현재 함수에서 꼬리 호출로 표시한 호출
+    std::vector<TailJump> tail_jumps; //현재 함수에서 tail_entry로 돌아가는 점프
+    std::vector<ArrayReturn> array_returns; //현재 함수에서 배열을 반환하는 ㅈㅈ문
     int ret_count = 0;
-    bool in_loop = false;
-
-    ZulContext();
 
-    bool var_exist(const std::string &name);
-
-    void remove_scope_vars();
+    explicit ZulContext(Session &session);
 };
 
 
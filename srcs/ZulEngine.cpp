@@ -0,0 +1,155 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <fstream>
+#include <sstream>
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include "ZulEngine.h"
+#include "Compiler.h"
+#include "RuntimeSymbols.h"
+
+using std::string;
+using std::vector;
+
+using llvm::orc::LLJITBuilder;
+using llvm::orc::ThreadSafeModule;
+
+ZulEngine::ZulEngine(unsigned opt_level, unsigned jobs) : opt_level(opt_level), jobs(jobs) {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+}
+
+ZulEngine::~ZulEngine() = default;
+
+bool ZulEngine::compile(const string &source, const string &source_name) {
+    if (jit) {
+        error = "에러: 이미 소스를 컴파일한 엔진입니다. 다른 소스는 새 엔진에서 컴파일하세요\n";
+        return false;
+    }
+    std::ostringstream log;
+    Session session{source_name};
+    session.logger.set_output(log);
+    session.opt_level = opt_level;
+    session.jobs = jobs;
+    session.need_entry = false;
+
+    vector<ThreadSafeModule> modules;
+    {
+        Compiler compiler{session};
+        modules = compiler.compile(source);
+        for (auto &[name, proto]: compiler.get_func_protos()) {
+            if (!proto.has_body)
+                continue;
+            auto &signature = signatures[name];
+            signature.return_type = proto.return_type;
+            for (auto &param: proto.params) {
+                signature.param_types.push_back(param.second);
+            }
+        }
+    }
+    session.logger.flush();
+    error = log.str();
+    if (session.logger.has_error()) {
+        signatures.clear();
+        return false;
+    }
+
+    auto created = LLJITBuilder().create();
+    if (!created) {
+        error = "에러: JIT을 만들지 못했습니다. " + llvm::toString(created.takeError()) + '\n';
+        signatures.clear();
+        return false;
+    }
+    jit = std::move(*created);
+    if (auto err = add_runtime_symbols(*jit)) {
+        error = "에러: 런타임 함수를 JIT에 등록하지 못했습니다. " + llvm::toString(std::move(err)) + '\n';
+        return false;
+    }
+    for (auto &tsm: modules) {
+        if (auto err = jit->addIRModule(std::move(tsm))) {
+            error = "에러: 모듈을 JIT에 올리지 못했습니다. " + llvm::toString(std::move(err)) + '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ZulEngine::compile_file(const string &source_name) {
+    std::ifstream file(source_name, std::ios::binary);
+    if (!file.is_open()) {
+        error = "에러: \"" + source_name + "\" 파일이 존재하지 않습니다.\n";
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return compile(ss.str(), source_name);
+}
+
+const string &ZulEngine::get_error() const {
+    return error;
+}
+
+void *ZulEngine::get_function(const string &name, const string &signature) {
+    auto iter = signatures.find(name);
+    if (iter == signatures.end()) {
+        error = "에러: \"" + name + "\" 함수가 정의되지 않았습니다\n";
+        return nullptr;
+    }
+    //공백은 무시하고 비교함
+    auto strip = [](const string &str) {
+        string ret;
+        for (auto c: str) {
+            if (!isspace(static_cast<unsigned char>(c)))
+                ret.push_back(c);
+        }
+        return ret;
+    };
+    auto actual = to_string(iter->second);
+    if (strip(actual) != strip(signature)) {
+        error = "에러: \"" + name + "\" 함수의 타입은 \"" + actual + "\" 이지만 \"" + signature + "\" 로 찾으려 했습니다\n";
+        return nullptr;
+    }
+    return lookup(name);
+}
+
+void *ZulEngine::get_function(const string &name, int return_type, const vector<int> &param_types) {
+    auto iter = signatures.find(name);
+    if (iter == signatures.end()) {
+        error = "에러: \"" + name + "\" 함수가 정의되지 않았습니다\n";
+        return nullptr;
+    }
+    auto &signature = iter->second;
+    if (signature.return_type != return_type || signature.param_types != param_types) {
+        error = "에러: \"" + name + "\" 함수의 타입은 \"" + to_string(signature) + "\" 이지만 \"" +
+                to_string({return_type, param_types}) + "\" 로 찾으려 했습니다\n";
+        return nullptr;
+    }
+    return lookup(name);
+}
+
+void *ZulEngine::lookup(const string &name) {
+    auto symbol = jit->lookup(name);
+    if (!symbol) {
+        error = "에러: \"" + name + "\" 함수를 찾지 못했습니다. " + llvm::toString(symbol.takeError()) + '\n';
+        return nullptr;
+    }
+    return symbol->toPtr<void *>();
+}
+
+string ZulEngine::to_string(const Signature &signature) {
+    string ret = "(";
+    for (size_t i = 0; i < signature.param_types.size(); ++i) {
+        if (i > 0)
+            ret.append(", ");
+        ret.append(get_type_name(signature.param_types[i]));
+    }
+    ret.push_back(')');
+    if (signature.return_type != -1) {
+        ret.push_back(' ');
+        ret.append(get_type_name(signature.return_type));
+    }
+    return ret;
+}
@@ -0,0 +1,101 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_ZULENGINE_H
+#define ZULLANG_ZULENGINE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Utility.h"
+
+namespace llvm::orc {
+    class LLJIT;
+}
+
+//줄랭 코드를 프로세스 안에서 컴파일하고, 컴파일된 함수를 C++에서 직접 호출하기 위한 임베딩 API
+//컴파일된 코드는 엔진이 살아있는 동안 JIT에 남아있으므로, 한 번 찾은 함수 포인터는 일반 함수처럼 계속 호출할 수 있음
+//
+//ZulEngine engine;
+//engine.compile("ㅎㅇ 더하기(ㄱ: 수, ㄴ: 수) 수:\n    ㅈㅈ ㄱ + ㄴ\n");
+//auto add = engine.get_function<long long(long long, long long)>("더하기");
+//add(1, 2);
+class ZulEngine {
+public:
+    explicit ZulEngine(unsigned opt_level = 2, unsigned jobs = 1);
+
+    ~ZulEngine();
+
+    ZulEngine(const ZulEngine &) = delete;
+
+    ZulEngine &operator=(const ZulEngine &) = delete;
+
+    //소스를 컴파일해서 JIT에 올림. 엔진 하나에는 소스 하나만 컴파일할 수 있고, 진입점 함수는 없어도 됨
+    bool compile(const std::string &source, const std::string &source_name = "<embedded>");
+
+    bool compile_file(const std::string &source_name);
+
+    //마지막으로 실패한 작업의 에러 메세지
+    [[nodiscard]] const std::string &get_error() const;
+
+    //함수를 C++ 함수 타입으로 찾음. 줄랭 함수의 타입과 맞지 않으면 nullptr을 반환함
+    //논리 = bool, 글자 = char, 수 = long long(8바이트 정수), 실수 = double, 반환 타입 없음 = void, 배열 = 원소의 포인터
+    template<typename Func>
+    Func *get_function(const std::string &name) {
+        return reinterpret_cast<Func *>(find_typed(name, static_cast<Func *>(nullptr)));
+    }
+
+    //함수를 "(수, 실수) 수" 형태의 시그니처 문자열로 찾음. 반환 타입이 없으면 "(수, 실수)" 처럼 씀
+    void *get_function(const std::string &name, const std::string &signature);
+
+    void *get_function(const std::string &name, int return_type, const std::vector<int> &param_types);
+
+private:
+    struct Signature {
+        int return_type;
+        std::vector<int> param_types;
+    };
+
+    unsigned opt_level;
+
+    unsigned jobs;
+
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+
+    std::map<std::string, Signature> signatures; //정의된 함수들의 타입
+
+    std::string error;
+
+    void *lookup(const std::string &name);
+
+    static std::string to_string(const Signature &signature);
+
+    template<typename Ret, typename... Args>
+    void *find_typed(const std::string &name, Ret (*)(Args...)) {
+        return get_function(name, type_id_of<Ret>(), {type_id_of<Args>()...});
+    }
+
+    template<typename T>
+    static constexpr int type_id_of() {
+        if constexpr (std::is_void_v<T>)
+            return -1;
+        else if constexpr (std::is_same_v<T, bool>)
+            return id_bool;
+        else if constexpr (std::is_integral_v<T> && sizeof(T) == 1)
+            return id_char;
+        else if constexpr (std::is_integral_v<T> && sizeof(T) == 8)
+            return id_int;
+        else if constexpr (std::is_same_v<T, double>)
+            return id_float;
+        else if constexpr (std::is_pointer_v<T> && !std::is_pointer_v<std::remove_pointer_t<T>> &&
+                           !std::is_void_v<std::remove_pointer_t<T>>)
+            return type_id_of<std::remove_cv_t<std::remove_pointer_t<T>>>() + TYPE_COUNTS;
+        else
+            static_assert(sizeof(T) == 0, "줄랭 타입과 대응되지 않는 C++ 타입입니다");
+    }
+};
+
+#endif //ZULLANG_ZULENGINE_H
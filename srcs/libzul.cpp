@@ -0,0 +1,33 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "libzul.h"
+#include "ZulEngine.h"
+
+struct zul_engine {
+    ZulEngine engine;
+};
+
+zul_engine *zul_engine_create(unsigned opt_level) {
+    return new zul_engine{ZulEngine{opt_level}};
+}
+
+void zul_engine_destroy(zul_engine *engine) {
+    delete engine;
+}
+
+int zul_compile(zul_engine *engine, const char *source) {
+    return engine->engine.compile(source);
+}
+
+int zul_compile_file(zul_engine *engine, const char *source_name) {
+    return engine->engine.compile_file(source_name);
+}
+
+void *zul_get_function(zul_engine *engine, const char *name, const char *signature) {
+    return engine->engine.get_function(name, signature);
+}
+
+const char *zul_error(const zul_engine *engine) {
+    return engine->engine.get_error().c_str();
+}
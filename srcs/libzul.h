@@ -0,0 +1,41 @@
+//SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
+//SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef ZULLANG_LIBZUL_H
+#define ZULLANG_LIBZUL_H
+
+//libzul의 C API. C++에서는 ZulEngine.h를 바로 사용할 수 있음
+//
+//zul_engine *engine = zul_engine_create(2);
+//if (!zul_compile(engine, source))
+//    fputs(zul_error(engine), stderr);
+//long long (*add)(long long, long long) = zul_get_function(engine, "더하기", "(수, 수) 수");
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct zul_engine zul_engine;
+
+//opt_level은 함수 단위 최적화 레벨(0~3)
+zul_engine *zul_engine_create(unsigned opt_level);
+
+//엔진이 해제되면 엔진에서 찾은 함수 포인터도 모두 사용할 수 없게 됨
+void zul_engine_destroy(zul_engine *engine);
+
+//성공하면 1, 실패하면 0을 반환함
+int zul_compile(zul_engine *engine, const char *source);
+
+int zul_compile_file(zul_engine *engine, const char *source_name);
+
+//signature는 "(수, 실수) 수" 형태이고, 반환 타입이 없으면 "(수, 실수)" 처럼 씀. 타입이 맞지 않으면 NULL을 반환함
+void *zul_get_function(zul_engine *engine, const char *name, const char *signature);
+
+//마지막으로 실패한 작업의 에러 메세지
+const char *zul_error(const zul_engine *engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ZULLANG_LIBZUL_H
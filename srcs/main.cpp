@@ -2,6 +2,8 @@
 //SPDX-FileCopyrightText: © 2023 Lee ByungYun <dlquddbs1234@gmail.com>
 //SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "llvm/Support/TargetSelect.h"
@@ -11,9 +13,16 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Process.h"
+#include "llvm/TargetParser/Triple.h"
 
 #include "System.h"
-#include "Parser.h"
+#include "Compiler.h"
+#include "HotReload.h"
+#include "Interpreter.h"
+#include "Runtime.h"
+#include "RuntimeSymbols.h"
+#include "SharedLib.h"
 #include "Zulstdio.h"
 
 using std::string;
@@ -36,39 +45,46 @@ using llvm::ExitOnError;
 using llvm::orc::LLJITBuilder;
 using llvm::orc::ThreadSafeModule;
 
-void write_module(Module *module) {
+#define OUTPUT_BUFFER_SIZE (1 << 16) //출력이 터미널이 아닐 때 stdout이 한 번에 내보내는 크기
+
+char output_buffer[OUTPUT_BUFFER_SIZE];
+
+void write_module(Session &session, Module *module) {
     if (auto original_main = module->getFunction("main")) {
         original_main->setName("old_main");
     }
     module->getFunction(ENTRY_FN_NAME)->setName("main");
 
-    if (System::output_name.empty()) {
-        auto dot_pos = System::source_name.rfind('.');
-        System::output_name = System::source_name.substr(0, dot_pos) + (System::opt_assembly ? ".ll" : ".bc");
+    if (session.output_name.empty()) {
+        auto dot_pos = session.source_name.rfind('.');
+        session.output_name = session.source_name.substr(0, dot_pos) + (session.opt_assembly ? ".ll" : ".bc");
     }
 
     error_code EC;
-    raw_fd_ostream output_file{System::output_name, EC};
+    raw_fd_ostream output_file{session.output_name, EC};
 
-    if (System::opt_assembly) {
+    if (session.opt_assembly) {
         module->print(output_file, nullptr);
     } else {
         WriteBitcodeToFile(*module, output_file);
     }
 }
 
-void run_jit(unique_ptr<LLVMContext> context, unique_ptr<Module> module) {
+void run_jit(Session &session, vector<ThreadSafeModule> modules) {
     InitializeNativeTarget();
     InitializeNativeTargetAsmPrinter();
 
     ExitOnError ExitOnErr;
 
-    ExitOnErr.setBanner(System::source_name + ": ");
+    ExitOnErr.setBanner(session.source_name + ": ");
 
     auto lljit = ExitOnErr(LLJITBuilder().create());
-    auto tsm = ThreadSafeModule(std::move(module), std::move(context));
+    ExitOnErr(add_runtime_symbols(*lljit));
 
-    ExitOnErr(lljit->addIRModule(std::move(tsm)));
+    //병렬로 생성된 모듈들은 링크하지 않고 그대로 JIT에 넘김. 심볼은 JIT이 연결해줌
+    for (auto &tsm: modules) {
+        ExitOnErr(lljit->addIRModule(std::move(tsm)));
+    }
 
     long long (*zul_main)() = ExitOnErr(lljit->lookup(ENTRY_FN_NAME)).toPtr<long long()>();
     zul_main();
@@ -90,23 +106,81 @@ void link_stdio(LLVMContext &context, Module &module) {
     }
 }
 
+//줄 단위로 내보내지 않을 때 터미널이 아닌 stdout의 버퍼를 키워서 write 호출을 줄임
+//setvbuf는 stdout을 쓰기 전에만 부를 수 있으므로 런타임이 아니라 실행 파일의 시작에서 설정함
+void init_stdout() {
+    auto env = std::getenv("ZUL_LINE_BUFFERED");
+    bool line_buffered = System::opt_line_buffered || (env && std::atoi(env) != 0);
+    if (!line_buffered && !llvm::sys::Process::StandardOutIsDisplayed())
+        std::setvbuf(stdout, output_buffer, _IOFBF, OUTPUT_BUFFER_SIZE);
+}
+
 int main(int argc, char *argv[]) {
-    System::parse_arg(argc, argv);
+    System::parse_arg(argc, argv); //도움말과 인자 에러는 stdio를 거치지 않고 출력됨
+    init_stdout();
 #ifdef ZUL_DEBUG
     InitLLVM X(argc, argv);
 #endif
 
-    Parser parser{System::source_name, System::target_triple};
-    auto [context, module] = parser.parse();
+    Session session{System::source_name};
+    System::apply_args(session);
+    if (System::threads)
+        zul_set_threads(System::threads);
+    if (System::opt_line_buffered)
+        zul_set_line_buffered(true);
+
+    if (session.watch)
+        return HotReloader{session}.run();
 
-    if (System::logger.has_error())
+    Compiler compiler{session};
+    auto modules = compiler.compile();
+
+    if (session.logger.has_error())
         return 1;
 
-    if (System::opt_compile || System::opt_assembly) {
-        link_stdio(*context, *module);
-        write_module(module.get());
+    if (session.opt_shared) {
+        if (!link_modules(modules, session.logger))
+            return 1;
+        bool written = false;
+        modules.front().withModuleDo([&](Module &module) {
+            if (llvm::Triple(module.getTargetTriple()).isOSWindows()) //stdio 모듈은 윈도우 CRT용 printf, scanf 정의임
+                link_stdio(module.getContext(), module);
+            written = write_shared(session, module, compiler.get_func_protos());
+        });
+        return written ? 0 : 1;
+    }
+
+    if (session.opt_interp || session.opt_auto) {
+        if (!link_modules(modules, session.logger))
+            return 1;
+        bool interpreted = false;
+        modules.front().withModuleDo([&](Module &module) {
+            if (session.opt_auto && Interpreter::count_insts(module) > AUTO_INTERP_LIMIT)
+                return;
+            Interpreter interpreter;
+            if (interpreter.load(module)) {
+                interpreted = true;
+                interpreter.run();
+            } else if (session.opt_interp) {
+                cerr << session.source_name << ": " << interpreter.get_error();
+                exit(1);
+            }
+            //--auto 모드에서 인터프리터가 지원하지 않는 구문이 있으면 JIT으로 실행함
+        });
+        if (!interpreted)
+            run_jit(session, std::move(modules));
+        return 0;
+    }
+
+    if (session.opt_compile || session.opt_assembly) {
+        if (!link_modules(modules, session.logger))
+            return 1;
+        modules.front().withModuleDo([&](Module &module) {
+            link_stdio(module.getContext(), module);
+            write_module(session, &module);
+        });
     } else {
-        run_jit(std::move(context), std::move(module));
+        run_jit(session, std::move(modules));
     }
     return 0;
 }
@@ -0,0 +1,29 @@
+#cmake -DZUL=<zul 경로> -DTEST_NAME=<테스트 이름> -P run_test.cmake
+set(input_option "")
+if (EXISTS ${TEST_NAME}.in)
+    set(input_option INPUT_FILE ${TEST_NAME}.in)
+endif ()
+file(READ ${TEST_NAME}.out expected)
+
+#zul_args 옵션으로 실행한 결과가 기대한 출력과 같은지 확인함
+function(check_run zul_args)
+    separate_arguments(arg_list UNIX_COMMAND "${zul_args}")
+    #에러 메시지도 결과에 포함되도록 두 출력을 한 변수로 받음
+    execute_process(COMMAND ${ZUL} ${arg_list} ${TEST_NAME}.zul
+                    ${input_option}
+                    OUTPUT_VARIABLE output
+                    ERROR_VARIABLE output)
+    if (NOT output STREQUAL expected)
+        message(FATAL_ERROR "출력이 다릅니다 (옵션: ${zul_args})\n--- 기대한 출력\n${expected}--- 실제 출력\n${output}")
+    endif ()
+endfunction()
+
+#옵션 파일의 줄마다 한 번씩 실행하므로 JIT과 인터프리터처럼 실행 방법이 달라도 결과가 같은지 확인할 수 있음
+if (EXISTS ${TEST_NAME}.args)
+    file(STRINGS ${TEST_NAME}.args arg_lines)
+    foreach (arg_line IN LISTS arg_lines)
+        check_run("${arg_line}")
+    endforeach ()
+else ()
+    check_run("")
+endif ()